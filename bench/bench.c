@@ -0,0 +1,250 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Benchmark harness. Runs diffdasm over each image in a list (as gen
+// writes) with --stats-json, after a warm-up run, and reports the median
+// of each phase and of the whole process over the runs. Medians can be
+// saved as a baseline and later runs compared against it.
+//
+// bench [--runs n] [--baseline file] [--save file] <diffdasm> <list>
+//
+// The list has one image per line: name, file and options, tab separated.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define STRMAX 4096
+#define ARGMAX 64
+#define RUNMAX 101
+
+// Phases as --stats-json names them, then the whole process
+static const char *phases[] = { "load", "infer", "trace", "speculation", "labels", "emit", "total", NULL };
+#define PHASES 7
+#define TOTAL 6
+
+typedef struct Case {
+	char name[64];
+	char file[STRMAX];
+	char options[STRMAX];
+	double median[PHASES];
+	double baseline[PHASES];
+	int hasBaseline;
+	int failed;
+} Case;
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int byValue(const void *a, const void *b) {
+	double x = *(double *)a, y = *(double *)b;
+	return x < y ? -1 : x > y;
+}
+
+// Run diffdasm once; fill in the phase times in ms, or return 0
+static int runOnce(char *diffdasm, Case *c, double *ms) {
+	char *argv[ARGMAX], options[STRMAX], buffer[65536], *p, *json;
+	int argc = 0, fds[2], status, i;
+	size_t length = 0;
+	ssize_t n;
+	double start;
+	pid_t pid;
+
+	argv[argc++] = diffdasm;
+	strcpy(options, c->options);
+	for (p = strtok(options, " "); p && argc < ARGMAX - 3; p = strtok(NULL, " "))
+		argv[argc++] = p;
+	argv[argc++] = "--stats-json";
+	argv[argc++] = c->file;
+	argv[argc] = NULL;
+
+	if (pipe(fds)) return 0;
+	start = now();
+	if ((pid = fork()) == 0) {
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, 1);
+		dup2(fds[1], 2);
+		close(fds[0]);
+		execv(diffdasm, argv);
+		_exit(127);
+	}
+	close(fds[1]);
+	while ((n = read(fds[0], buffer + length, sizeof(buffer) - 1 - length)) > 0) {
+		length += n;
+		if (length == sizeof(buffer) - 1) {
+			// Keep the tail; the stats come last
+			memmove(buffer, buffer + length / 2, length - length / 2);
+			length -= length / 2;
+		}
+	}
+	buffer[length] = '\0';
+	close(fds[0]);
+	waitpid(pid, &status, 0);
+	ms[TOTAL] = (now() - start) * 1e3;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 0;
+	if ((json = strstr(buffer, "{\"phases\":")) == NULL) return 0;
+	for (i = 0; i < TOTAL; i++) {
+		char key[64];
+		snprintf(key, sizeof(key), "\"%s\":{\"wall_ms\":", phases[i]);
+		if ((p = strstr(json, key)) == NULL) return 0;
+		ms[i] = strtod(p + strlen(key), NULL);
+	}
+	return 1;
+}
+
+static void runCase(char *diffdasm, Case *c, int runs) {
+	double samples[PHASES][RUNMAX], ms[PHASES];
+	int r, i;
+
+	if (!runOnce(diffdasm, c, ms)) {	// Warm-up
+		c->failed = 1;
+		return;
+	}
+	for (r = 0; r < runs; r++) {
+		if (!runOnce(diffdasm, c, ms)) {
+			c->failed = 1;
+			return;
+		}
+		for (i = 0; i < PHASES; i++) samples[i][r] = ms[i];
+	}
+	for (i = 0; i < PHASES; i++) {
+		qsort(samples[i], runs, sizeof(double), byValue);
+		c->median[i] = runs % 2 ? samples[i][runs/2] : (samples[i][runs/2-1] + samples[i][runs/2]) / 2;
+	}
+}
+
+static int readList(char *listName, Case **cases) {
+	char line[2 * STRMAX], *name, *file, *options;
+	int count = 0, max = 16;
+	FILE *fp;
+
+	if ((fp = fopen(listName, "r")) == NULL) {
+		fprintf(stderr, "ERROR: bench: Can't open list '%s'\n", listName);
+		exit(1);
+	}
+	*cases = (Case *)calloc(max, sizeof(Case));
+	while (fgets(line, sizeof(line), fp)) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#') continue;
+		name = line;
+		if ((file = strchr(name, '\t')) == NULL) continue;
+		*file++ = '\0';
+		if ((options = strchr(file, '\t'))) *options++ = '\0';
+		else options = "";
+		if (count == max) {
+			max *= 2;
+			*cases = (Case *)realloc(*cases, sizeof(Case) * max);
+			memset(*cases + count, 0, sizeof(Case) * (max - count));
+		}
+		snprintf((*cases)[count].name, sizeof((*cases)[count].name), "%s", name);
+		snprintf((*cases)[count].file, sizeof((*cases)[count].file), "%s", file);
+		snprintf((*cases)[count].options, sizeof((*cases)[count].options), "%s", options);
+		++count;
+	}
+	fclose(fp);
+	return count;
+}
+
+// Baseline lines are: name phase ms
+static int readBaseline(char *fileName, Case *cases, int count) {
+	char name[64], phase[64];
+	double ms;
+	int c, i, found = 0;
+	FILE *fp;
+
+	if ((fp = fopen(fileName, "r")) == NULL) return 0;
+	while (fscanf(fp, "%63s %63s %lf", name, phase, &ms) == 3) {
+		for (c = 0; c < count && strcmp(cases[c].name, name); c++);
+		for (i = 0; i < PHASES && strcmp(phases[i], phase); i++);
+		if (c == count || i == PHASES) continue;
+		cases[c].baseline[i] = ms;
+		cases[c].hasBaseline = 1;
+		found = 1;
+	}
+	fclose(fp);
+	return found;
+}
+
+static void saveBaseline(char *fileName, Case *cases, int count) {
+	FILE *fp;
+	int c, i;
+
+	if ((fp = fopen(fileName, "w")) == NULL) {
+		fprintf(stderr, "ERROR: bench: Can't write baseline '%s'\n", fileName);
+		exit(1);
+	}
+	for (c = 0; c < count; c++) {
+		if (cases[c].failed) continue;
+		for (i = 0; i < PHASES; i++)
+			fprintf(fp, "%s %s %.3f\n", cases[c].name, phases[i], cases[c].median[i]);
+	}
+	fclose(fp);
+}
+
+int main(int argc, char **argv) {
+	char *baselineName = NULL, *saveName = NULL;
+	Case *cases;
+	int runs = 5, count, c, i, failed = 0, compare;
+
+	while (argc > 1 && !strncmp(argv[1], "--", 2)) {
+		if (!strcmp(argv[1], "--runs") && argc > 2) runs = atoi(argv[2]);
+		else if (!strcmp(argv[1], "--baseline") && argc > 2) baselineName = argv[2];
+		else if (!strcmp(argv[1], "--save") && argc > 2) saveName = argv[2];
+		else break;
+		argc -= 2;
+		argv += 2;
+	}
+	if (argc != 3 || runs < 1 || runs > RUNMAX) {
+		fprintf(stderr, "Usage:\nbench [--runs n] [--baseline file] [--save file] <diffdasm> <list>\n");
+		exit(1);
+	}
+	count = readList(argv[2], &cases);
+	compare = baselineName && readBaseline(baselineName, cases, count);
+
+	printf("Median ms of %d runs\n%-12s", runs, "Image");
+	for (i = 0; i < PHASES; i++) printf(" %11s", phases[i]);
+	printf("\n");
+	for (c = 0; c < count; c++) {
+		runCase(argv[1], &cases[c], runs);
+		printf("%-12s", cases[c].name);
+		if (cases[c].failed) {
+			printf(" failed: %s %s\n", cases[c].options, cases[c].file);
+			failed = 1;
+			continue;
+		}
+		for (i = 0; i < PHASES; i++) printf(" %11.3f", cases[c].median[i]);
+		printf("\n");
+		fflush(stdout);
+	}
+
+	if (compare) {
+		printf("\nChange from baseline %s\n%-12s", baselineName, "Image");
+		for (i = 0; i < PHASES; i++) printf(" %11s", phases[i]);
+		printf("\n");
+		for (c = 0; c < count; c++) {
+			if (cases[c].failed || !cases[c].hasBaseline) continue;
+			printf("%-12s", cases[c].name);
+			for (i = 0; i < PHASES; i++) {
+				// Phases too short to time are left out
+				if (cases[c].baseline[i] < 0.05) printf(" %11s", "-");
+				else printf(" %+10.1f%%", (cases[c].median[i] / cases[c].baseline[i] - 1) * 100);
+			}
+			printf("\n");
+		}
+	}
+	if (saveName) saveBaseline(saveName, cases, count);
+	free(cases);
+	return failed;
+}
@@ -0,0 +1,204 @@
+/*
+ * decoder.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Differential check of the decoder. Every opcode, prebyte and postbyte
+// combination (all three byte prefixes, with several operand tails) goes
+// through the reference decoder in ref6809.c and the live one in
+// stats6809.c, complete and cut short by the end of the image at each
+// length, and M6809_bytes, M6809_flags, M6809_mode, M6809_transfer and
+// M6809_pcrel must agree exactly, as must the same fields from the one
+// pass M6809_decode. SWI prefixes are also run with other SWI postbyte
+// counts. Then both decoders are timed over a random image.
+//
+// decoder [--quick]
+//
+// --quick checks every opcode and prebyte pair with a sample of third bytes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../memoryfile.h"
+#include "../os9stuff.h"
+#include "../stats6809.h"
+#include "ref6809.h"
+
+#define BEFORE 8		// Image bytes ahead of the instruction
+#define MAXLEN 6		// Longest instruction with SWI postbytes
+#define MAXREPORT 20
+#define PASSES 5
+
+// The globals stats6809.c uses, normally defined by diffdasm.c
+int source = 0;
+int f9info = 0;
+int _debug = 0;
+int is_os9 = 0;
+int swipb = 1, swi2pb = 1, swi3pb = 1;
+
+// Formatting needs these; decoding doesn't
+void appendComment(char* text) {
+}
+
+char* hints_name(int offset) {
+	return NULL;
+}
+
+// Operand bytes after the first three
+static const unsigned char tails[][MAXLEN - 3] = {
+	{ 0x00, 0x00, 0x00 },
+	{ 0xFF, 0xFF, 0xFF },
+	{ 0x80, 0x7F, 0x01 },
+};
+#define TAILS (sizeof(tails) / sizeof(tails[0]))
+
+// SWI postbyte counts tried on the SWI prefixes, after the defaults
+static const int swiCounts[][3] = { { 0, 0, 0 }, { 2, 3, 0 }, { 4, 2, 5 } };
+#define SWICOUNTS (sizeof(swiCounts) / sizeof(swiCounts[0]))
+
+static long cases = 0, mismatches = 0;
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(MemoryFile *mod, char *function, int candidate, int reference) {
+	int i;
+	if (++mismatches > MAXREPORT) return;
+	printf("MISMATCH: %s", function);
+	for (i = 0; i < MAXLEN; i++) printf(" %02X", mod->storage[BEFORE + i]);
+	printf(" length %d swi %d/%d/%d: %d, reference %d\n",
+		mod->length - BEFORE, swipb, swi2pb, swi3pb, candidate, reference);
+}
+
+// Compare the decoders on the instruction at BEFORE
+static void compare(MemoryFile *mod) {
+	Decoded d;
+	int c, r;
+	++cases;
+	if ((c = M6809_bytes(mod, BEFORE)) != (r = REF_bytes(mod, BEFORE))) report(mod, "M6809_bytes", c, r);
+	if ((c = M6809_flags(mod, BEFORE)) != (r = REF_flags(mod, BEFORE))) report(mod, "M6809_flags", c, r);
+	if ((c = M6809_mode(mod, BEFORE)) != (r = REF_mode(mod, BEFORE))) report(mod, "M6809_mode", c, r);
+	if ((c = M6809_transfer(mod, BEFORE)) != (r = REF_transfer(mod, BEFORE))) report(mod, "M6809_transfer", c, r);
+	if ((c = M6809_pcrel(mod, BEFORE)) != (r = REF_pcrel(mod, BEFORE))) report(mod, "M6809_pcrel", c, r);
+
+	M6809_decode(mod, BEFORE, &d);
+	if (d.bytes != (r = REF_bytes(mod, BEFORE))) report(mod, "M6809_decode bytes", d.bytes, r);
+	if (d.flags != (r = REF_flags(mod, BEFORE))) report(mod, "M6809_decode flags", d.flags, r);
+	if (d.mode != (r = REF_mode(mod, BEFORE))) report(mod, "M6809_decode mode", d.mode, r);
+	if (d.dest != (r = REF_transfer(mod, BEFORE))) report(mod, "M6809_decode dest", d.dest, r);
+	if (d.eff != (r = REF_pcrel(mod, BEFORE))) report(mod, "M6809_decode eff", d.eff, r);
+}
+
+// One three byte prefix: each tail complete, then cut short at each length.
+// Bytes past the end stay in memory, since today's decoder can read them.
+static void check(MemoryFile *mod) {
+	unsigned char *p = mod->storage + BEFORE;
+	int t, length;
+	for (t = TAILS - 1; t >= 0; t--) {
+		memcpy(p + 3, tails[t], MAXLEN - 3);
+		for (length = t ? MAXLEN : 1; length <= MAXLEN; length++) {
+			mod->length = BEFORE + length;
+			mod->end = mod->storage + mod->length - 1;
+			compare(mod);
+		}
+	}
+}
+
+static void checkAll(MemoryFile *mod, int step) {
+	unsigned char *p = mod->storage + BEFORE;
+	int b0, b1, b2, s;
+	for (b0 = 0; b0 < 256; b0++) {
+		p[0] = b0;
+		for (b1 = 0; b1 < 256; b1++) {
+			p[1] = b1;
+			for (b2 = 0; b2 < 256; b2 += step) {
+				p[2] = b2;
+				check(mod);
+				if (b0 == SWI_1 || ((b0 == 0x10 || b0 == 0x11) && b1 == SWI2_2)) {
+					for (s = 0; s < SWICOUNTS; s++) {
+						swipb = swiCounts[s][0];
+						swi2pb = swiCounts[s][1];
+						swi3pb = swiCounts[s][2];
+						check(mod);
+					}
+					swipb = swi2pb = swi3pb = 1;
+				}
+			}
+		}
+	}
+}
+
+// Decodes per second of one decoder: each offset of a random image through
+// all five functions, best of several passes
+typedef struct Decoder {
+	char *name;
+	short (*bytes)(MemoryFile*, int);
+	unsigned char (*flags)(MemoryFile*, int);
+	int (*mode)(MemoryFile*, int);
+	int (*transfer)(MemoryFile*, int);
+	int (*pcrel)(MemoryFile*, int);
+} Decoder;
+
+static double timeDecoder(Decoder *d, MemoryFile *mod) {
+	volatile long sink = 0;
+	double best = 0, start, rate;
+	int pass, offset;
+	long sum;
+	for (pass = 0; pass < PASSES; pass++) {
+		start = now();
+		sum = 0;
+		for (offset = BEFORE; offset < mod->length; offset++)
+			sum += d->bytes(mod, offset) + d->flags(mod, offset) + d->mode(mod, offset)
+				+ d->transfer(mod, offset) + d->pcrel(mod, offset);
+		sink += sum;
+		rate = (mod->length - BEFORE) / (now() - start);
+		if (rate > best) best = rate;
+	}
+	return best;
+}
+
+int main(int argc, char **argv) {
+	static unsigned char storage[65536 + MAXLEN];
+	Decoder reference = { "reference", REF_bytes, REF_flags, REF_mode, REF_transfer, REF_pcrel };
+	Decoder candidate = { "stats6809", M6809_bytes, M6809_flags, M6809_mode, M6809_transfer, M6809_pcrel };
+	MemoryFile mod;
+	unsigned x = 0x6809;
+	double start, r, c;
+	int quick = 0, i;
+
+	if (argc == 2 && !strcmp(argv[1], "--quick")) quick = 1;
+	else if (argc != 1) {
+		fprintf(stderr, "Usage:\ndecoder [--quick]\n");
+		exit(1);
+	}
+
+	memset(&mod, 0, sizeof(mod));
+	mod.storage = storage;
+	memset(storage, 0x12, sizeof(storage));
+	start = now();
+	checkAll(&mod, quick ? 37 : 1);
+	printf("Decoder check: %ld cases in %.1f s, %ld mismatches\n", cases, now() - start, mismatches);
+	if (mismatches > MAXREPORT) printf("(first %d shown)\n", MAXREPORT);
+
+	// xorshift, so every run times the same image
+	for (i = 0; i < sizeof(storage); i++) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		storage[i] = x;
+	}
+	mod.length = sizeof(storage) - MAXLEN;
+	mod.end = mod.storage + mod.length - 1;
+	r = timeDecoder(&reference, &mod);
+	c = timeDecoder(&candidate, &mod);
+	printf("%-10s %8.2f M decodes/s\n", reference.name, r / 1e6);
+	printf("%-10s %8.2f M decodes/s (%+.1f%%)\n", candidate.name, c / 1e6, (c / r - 1) * 100);
+	return mismatches != 0;
+}
@@ -0,0 +1,470 @@
+/*
+ * gen.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Synthetic 6809 images for benchmarking. Every image comes from a fixed
+// seed, so the same command always writes the same bytes.
+//
+// gen <dir>                      Write the standard benchmark set and its list
+// gen <kind> <seed> <size> <file>  Write one image
+//
+// Kinds:
+//   dense   Routines of straight-line code, branches and calls, all reachable
+//   mixed   Code with jump tables, strings and data tables between routines
+//   data    Mostly data, with code-like and text-like runs (for --spec)
+//   os9     Program, driver and file manager modules, concatenated
+//   os9prg  One program module
+//   os9drv  One device driver module
+//   os9fm   One file manager module
+//   rom     Code ending at $FFFF, entered through the vector page
+//   srec    Dense code at $1000 as an S-record file with an S9 exec record
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define IMAGE_MAX 65536
+#define ROUTINE_MAX 4096
+
+typedef struct Image {
+	unsigned char bytes[IMAGE_MAX];
+	int length, limit;
+	unsigned base;
+	int pic;		// Position independent: no absolute addresses
+} Image;
+
+typedef struct Fixup {
+	int at;			// Offset of the operand
+	int kind;		// FIX_*
+	int target;		// Routine, instruction or data item
+} Fixup;
+
+enum { FIX_EXT, FIX_REL8, FIX_REL16 };
+
+static unsigned long long rng;
+
+static unsigned rnd(unsigned n) {
+	// xorshift64*
+	rng ^= rng >> 12;
+	rng ^= rng << 25;
+	rng ^= rng >> 27;
+	return (unsigned)((rng * 2685821657736338717ULL) >> 33) % n;
+}
+
+static void emit(Image *im, int byte) {
+	if (im->length < im->limit) im->bytes[im->length++] = byte & 0xFF;
+}
+
+static void emit16(Image *im, int word) {
+	emit(im, word >> 8);
+	emit(im, word);
+}
+
+static void patch(Image *im, Fixup *f, int target) {
+	int rel;
+	if (f->at + (f->kind == FIX_REL8 ? 1 : 2) > im->length) return;	// Cut off
+	switch (f->kind) {
+		case FIX_EXT:
+			im->bytes[f->at] = ((target + im->base) >> 8) & 0xFF;
+			im->bytes[f->at+1] = (target + im->base) & 0xFF;
+			break;
+		case FIX_REL8:
+			im->bytes[f->at] = (target - (f->at + 1)) & 0xFF;
+			break;
+		case FIX_REL16:
+			rel = target - (f->at + 2);
+			im->bytes[f->at] = (rel >> 8) & 0xFF;
+			im->bytes[f->at+1] = rel & 0xFF;
+			break;
+	}
+}
+
+// Opcodes that neither transfer nor end a routine, by length
+static const unsigned char inherent[] = {
+	0x12, 0x4F, 0x5F, 0x4C, 0x4A, 0x5C, 0x5A, 0x4D, 0x5D, 0x48, 0x58, 0x44, 0x54,
+	0x43, 0x53, 0x40, 0x50, 0x3A, 0x3D, 0x1D, 0x19
+};
+static const unsigned char immed8[] = {
+	0x86, 0xC6, 0x8B, 0xCB, 0x81, 0xC1, 0x84, 0xC4, 0x8A, 0xCA, 0x80, 0xC0, 0x1C, 0x1A
+};
+static const unsigned char immed16[] = { 0x8E, 0xCC, 0xCE, 0x8C, 0xC3, 0x83 };
+static const unsigned char direct[] = {
+	0x96, 0x97, 0xD6, 0xD7, 0xDC, 0xDD, 0x9E, 0x9F, 0x0C, 0x0F, 0x0D, 0x9B, 0xDB
+};
+static const unsigned char extended[] = { 0xB6, 0xB7, 0xF6, 0xF7, 0xFC, 0xFD, 0xBE, 0xBF, 0x7F, 0x7C };
+static const unsigned char indexed[][2] = {
+	{ 0xA6, 0x84 }, { 0xA7, 0x80 }, { 0xE6, 0xA4 }, { 0xE7, 0xA0 }, { 0xEC, 0x84 },
+	{ 0xED, 0xA4 }, { 0x30, 0x01 }, { 0x31, 0x3F }, { 0x33, 0xC4 }, { 0xAE, 0x81 },
+	{ 0xA6, 0x05 }, { 0xE6, 0xC4 }, { 0x6F, 0x84 }, { 0x6C, 0xA4 }
+};
+static const unsigned char prebyte[][2] = {
+	{ 0x10, 0x8E }, { 0x10, 0x83 }, { 0x10, 0xCE }, { 0x11, 0x83 }, { 0x10, 0x8C }
+};
+static const unsigned char branches[] = { 0x27, 0x26, 0x24, 0x25, 0x2A, 0x2B, 0x2C, 0x2F };
+
+#define PICK(table) table[rnd(sizeof(table) / sizeof(table[0]))]
+
+// One instruction that falls through to the next
+static void plain(Image *im) {
+	int i;
+	switch (rnd(10)) {
+		case 0: case 1: emit(im, PICK(inherent)); break;
+		case 2: case 3: emit(im, PICK(immed8)); emit(im, rnd(256)); break;
+		case 4: emit(im, PICK(immed16)); emit16(im, rnd(65536)); break;
+		case 5: emit(im, PICK(direct)); emit(im, rnd(256)); break;
+		case 6: emit(im, PICK(extended)); emit16(im, 0x8000 + rnd(0x4000)); break;
+		case 7: i = rnd(sizeof(indexed) / sizeof(indexed[0]));
+			emit(im, indexed[i][0]); emit(im, indexed[i][1]); break;
+		case 8: i = rnd(sizeof(prebyte) / sizeof(prebyte[0]));
+			emit(im, prebyte[i][0]); emit(im, prebyte[i][1]); emit16(im, rnd(65536)); break;
+		case 9:
+			switch (rnd(4)) {
+				case 0: emit(im, 0x1F); emit(im, 0x89); break;	// TFR A,B
+				case 1: emit(im, 0x1E); emit(im, 0x12); break;	// EXG X,Y
+				case 2: emit(im, 0x34); emit(im, 0x16); break;	// PSHS D,X
+				default: emit(im, 0x35); emit(im, 0x16); break;	// PULS D,X
+			}
+			break;
+	}
+}
+
+// Routines: body instructions with forward branches inside the routine,
+// calls to other routines and (mixed) references to data placed after it
+static void routines(Image *im, int count, int mixed, int *starts) {
+	Fixup *fix, *local;
+	int *inst, fixCount, localCount, instCount, r, i, n, k, target;
+
+	fix = (Fixup *)malloc(sizeof(Fixup) * IMAGE_MAX);
+	local = (Fixup *)malloc(sizeof(Fixup) * ROUTINE_MAX);
+	inst = (int *)malloc(sizeof(int) * IMAGE_MAX);
+	fixCount = 0;
+	for (r = 0; r < count && im->length < im->limit - 256; r++) {
+		starts[r] = im->length;
+		n = 8 + rnd(60);
+		instCount = localCount = 0;
+		for (i = 0; i < n; i++) {
+			inst[instCount++] = im->length;
+			switch (rnd(mixed ? 14 : 12)) {
+				case 0:	// Forward conditional branch, fixed up below
+					emit(im, PICK(branches));
+					local[localCount].at = im->length;
+					local[localCount].kind = -1;
+					local[localCount].target = instCount + 1 + rnd(6);
+					emit(im, 0);
+					++localCount;
+					break;
+				case 1:	// Call the next routine or one before, or OS-9
+					target = r + 1 < count && rnd(2) ? r + 1 : (int)rnd(r + 1);
+					if ((k = rnd(3)) == 2) {
+						emit(im, 0x10); emit(im, 0x3F); emit(im, rnd(0x90));	// SWI2
+						break;
+					}
+					k = k == 0 && !im->pic;
+					emit(im, k ? 0xBD : 0x17);	// JSR or LBSR
+					fix[fixCount].at = im->length;
+					fix[fixCount].kind = k ? FIX_EXT : FIX_REL16;
+					fix[fixCount].target = target;
+					++fixCount;
+					emit16(im, 0);
+					break;
+				case 12: case 13:	// LEAX data,PCR
+					emit(im, 0x30); emit(im, 0x8D);
+					local[localCount].at = im->length;
+					local[localCount].kind = FIX_REL16;
+					local[localCount].target = -1;
+					emit16(im, 0);
+					++localCount;
+					break;
+				default:
+					plain(im);
+					break;
+			}
+		}
+		// Every routine calls the next, relative so it's traced, so all
+		// are reachable
+		if (r + 1 < count) {
+			emit(im, 0x17);
+			fix[fixCount].at = im->length;
+			fix[fixCount].kind = FIX_REL16;
+			fix[fixCount].target = r + 1;
+			++fixCount;
+			emit16(im, 0);
+		}
+		inst[instCount++] = im->length;
+		switch (rnd(4)) {
+			case 0: emit(im, 0x35); emit(im, 0x96); break;	// PULS D,X,PC
+			default: emit(im, 0x39); break;				// RTS
+		}
+		// Branches land on an instruction in range, else fall through
+		for (i = 0; i < localCount; i++) {
+			Fixup *f = &local[i];
+			if (f->kind != -1) continue;
+			target = f->target < instCount ? inst[f->target] : inst[instCount-1];
+			if (target - (f->at + 1) > 127) target = f->at + 1;
+			f->kind = FIX_REL8;
+			patch(im, f, target);
+		}
+		// Data the routine refers to follows it
+		for (i = 0; i < localCount && im->length < im->limit - 64; i++) {
+			Fixup *f = &local[i];
+			if (f->kind != FIX_REL16) continue;
+			patch(im, f, im->length);
+			switch (rnd(3)) {
+				case 0:	// String, last character with the top bit set
+					for (n = 4 + rnd(24); n > 1; n--) emit(im, 'a' + rnd(26));
+					emit(im, 0x80 | '.');
+					break;
+				case 1:	// Table of routine addresses, or offsets
+					for (n = 2 + rnd(8); n > 0 && r > 0; n--)
+						emit16(im, im->pic ? starts[rnd(r)] - f->at : starts[rnd(r)] + im->base);
+					break;
+				default:	// Bytes
+					for (n = 4 + rnd(32); n > 0; n--) emit(im, rnd(256));
+					break;
+			}
+		}
+	}
+	for (i = 0; i < fixCount; i++)
+		if (fix[i].target < r) patch(im, &fix[i], starts[fix[i].target]);
+		else patch(im, &fix[i], starts[r-1]);
+	free(fix);
+	free(local);
+	free(inst);
+}
+
+static void code(Image *im, int mixed) {
+	static int starts[ROUTINE_MAX];
+	routines(im, ROUTINE_MAX, mixed, starts);
+}
+
+static void data(Image *im) {
+	int n;
+	// A short entry routine, then data
+	emit(im, 0x86); emit(im, 0x01); emit(im, 0x39);
+	while (im->length < im->limit) {
+		switch (rnd(8)) {
+			case 0: case 1: case 2: case 3: case 4:	// Random bytes
+				for (n = 1 + rnd(64); n > 0; n--) emit(im, rnd(256));
+				break;
+			case 5: case 6:	// Code-like, with no end
+				for (n = 2 + rnd(16); n > 0; n--) plain(im);
+				break;
+			default:	// Text-like
+				for (n = 2 + rnd(30); n > 1; n--) emit(im, ' ' + rnd(95));
+				emit(im, rnd(2) ? 0x80 | 'a' : 0x0D);
+				break;
+		}
+	}
+}
+
+// OS-9 module CRC over the module less its last three bytes
+static void os9crc(unsigned char *p, int n, unsigned char *crc) {
+	unsigned char a;
+	crc[0] = crc[1] = crc[2] = 0xFF;
+	while (n--) {
+		a = *p++ ^ crc[0];
+		crc[0] = crc[1];
+		crc[1] = crc[2] ^ (a >> 7) ^ (a >> 2);
+		crc[2] = (a << 1) ^ (a << 6);
+		a ^= a << 1;
+		a ^= a << 2;
+		a ^= a << 4;
+		if (a & 0x80) {
+			crc[0] ^= 0x80;
+			crc[2] ^= 0x21;
+		}
+	}
+	crc[0] = ~crc[0];
+	crc[1] = ~crc[1];
+	crc[2] = ~crc[2];
+}
+
+static void module(Image *all, int type, char *name, int entries, int size) {
+	static int starts[ROUTINE_MAX];
+	Image *im = (Image *)calloc(1, sizeof(Image));
+	int i, parity, table, count;
+
+	im->limit = size - 3;
+	im->pic = 1;
+	// Header: sync, size, name, type/language, attributes/revision,
+	// parity, exec, storage
+	emit16(im, 0x87CD);
+	emit16(im, 0);
+	emit16(im, 0);
+	emit(im, type | 0x01);
+	emit(im, 0x81);
+	emit(im, 0);
+	emit16(im, 0);
+	emit16(im, 0x0100);
+	if (type == 0xE0) emit(im, 0x03);	// Driver mode
+	i = im->length;
+	im->bytes[4] = i >> 8;
+	im->bytes[5] = i & 0xFF;
+	for (; name[1]; name++) emit(im, *name);
+	emit(im, 0x80 | *name);
+	emit(im, 0x01);	// Edition
+	// Exec: a table of LBRAs, one per entry point
+	table = im->length;
+	im->bytes[9] = table >> 8;
+	im->bytes[10] = table & 0xFF;
+	for (i = 0; i < entries; i++) {
+		emit(im, 0x16);
+		emit16(im, 0);
+	}
+	// Fill the module; entry points spread over the first routines
+	for (i = 0; i < ROUTINE_MAX; i++) starts[i] = -1;
+	routines(im, ROUTINE_MAX, 1, starts);
+	for (count = 0; count < ROUTINE_MAX && starts[count] >= 0; count++);
+	for (i = 0; i < entries; i++) {
+		Fixup f = { table + 3*i + 1, FIX_REL16, 0 };
+		patch(im, &f, starts[i * 4 < count ? i * 4 : 0]);
+	}
+	im->length = im->limit;	// Pad to the size asked for
+	im->bytes[2] = (im->length + 3) >> 8;
+	im->bytes[3] = (im->length + 3) & 0xFF;
+	for (parity = 0, i = 0; i < 8; i++) parity ^= im->bytes[i];
+	im->bytes[8] = ~parity;
+	os9crc(im->bytes, im->length, im->bytes + im->length);
+	im->length += 3;
+	memcpy(all->bytes + all->length, im->bytes, im->length);
+	all->length += im->length;
+	free(im);
+}
+
+static void os9(Image *im) {
+	int each = im->limit / 3;
+	module(im, 0x10, "bench", 1, each);
+	module(im, 0xE0, "benchdrv", 6, each);
+	module(im, 0xD0, "benchfm", 13, each);
+}
+
+// Reset, interrupt and SWI handlers, with the vectors at $FFF0
+static void rom(Image *im) {
+	static int reset[ROUTINE_MAX], irq[ROUTINE_MAX], nmi[ROUTINE_MAX];
+	static const int vector[8] = { 0, 1, 1, 1, 1, 1, 2, 0 };	// FFF0 to FFFE
+	int *starts[3] = { reset, irq, nmi };
+	int size = im->limit, i;
+
+	im->base = IMAGE_MAX - size;
+	im->limit = size / 8;
+	routines(im, 8, 1, irq);
+	im->limit += size / 8;
+	routines(im, 8, 0, nmi);
+	im->limit = size - 16;
+	routines(im, ROUTINE_MAX, 1, reset);
+	while (im->length < im->limit) emit(im, 0xFF);
+	im->limit = size;
+	for (i = 0; i < 8; i++) emit16(im, im->base + starts[vector[i]][0]);
+}
+
+static int writeBinary(Image *im, char *fileName) {
+	FILE *fp = fopen(fileName, "wb");
+	if (fp == NULL) return 0;
+	fwrite(im->bytes, 1, im->length, fp);
+	return fclose(fp) == 0;
+}
+
+static int writeSRecords(Image *im, char *fileName) {
+	FILE *fp = fopen(fileName, "w");
+	int at, n, i, sum;
+	unsigned addr;
+
+	if (fp == NULL) return 0;
+	for (at = 0; at < im->length; at += n) {
+		n = im->length - at < 32 ? im->length - at : 32;
+		addr = im->base + at;
+		sum = n + 3 + (addr >> 8) + (addr & 0xFF);
+		fprintf(fp, "S1%02X%04X", n + 3, addr);
+		for (i = 0; i < n; i++) {
+			fprintf(fp, "%02X", im->bytes[at+i]);
+			sum += im->bytes[at+i];
+		}
+		fprintf(fp, "%02X\n", ~sum & 0xFF);
+	}
+	sum = 3 + (im->base >> 8) + (im->base & 0xFF);
+	fprintf(fp, "S903%04X%02X\n", im->base, ~sum & 0xFF);
+	return fclose(fp) == 0;
+}
+
+static int generate(char *kind, unsigned seed, int size, char *fileName) {
+	Image *im = (Image *)calloc(1, sizeof(Image));
+	int ok;
+
+	if (size < 256 || size > IMAGE_MAX) {
+		fprintf(stderr, "ERROR: gen: Size must be 256 to %d bytes\n", IMAGE_MAX);
+		exit(1);
+	}
+	rng = 0x9E3779B97F4A7C15ULL ^ seed;
+	im->limit = size;
+	if (!strcmp(kind, "dense")) code(im, 0);
+	else if (!strcmp(kind, "mixed")) code(im, 1);
+	else if (!strcmp(kind, "data")) data(im);
+	else if (!strcmp(kind, "os9")) os9(im);
+	else if (!strcmp(kind, "os9prg")) module(im, 0x10, "corpprg", 1, size);
+	else if (!strcmp(kind, "os9drv")) module(im, 0xE0, "corpdrv", 6, size);
+	else if (!strcmp(kind, "os9fm")) module(im, 0xD0, "corpfm", 13, size);
+	else if (!strcmp(kind, "rom")) rom(im);
+	else if (!strcmp(kind, "srec")) {
+		im->base = 0x1000;
+		if (size > IMAGE_MAX - 0x1000) im->limit = IMAGE_MAX - 0x1000;
+		code(im, 0);
+	} else {
+		fprintf(stderr, "ERROR: gen: Unknown kind '%s'\n", kind);
+		exit(1);
+	}
+	ok = !strcmp(kind, "srec") ? writeSRecords(im, fileName) : writeBinary(im, fileName);
+	if (!ok) {
+		fprintf(stderr, "ERROR: gen: Can't write '%s'\n", fileName);
+		exit(1);
+	}
+	free(im);
+	return 0;
+}
+
+// The standard set: name, kind, seed, size, file suffix, options
+static const struct {
+	char *name, *kind;
+	unsigned seed;
+	int size;
+	char *suffix, *options;
+} standard[] = {
+	{ "dense",       "dense", 1, 32768, ".bin", "" },
+	{ "dense-src",   "dense", 1, 32768, ".bin", "--source" },
+	{ "mixed",       "mixed", 2, 32768, ".bin", "" },
+	{ "mixed-spec",  "mixed", 2, 32768, ".bin", "--spec" },
+	{ "data-spec",   "data",  3, 16384, ".bin", "--spec" },
+	{ "os9",         "os9",   4, 24576, ".bin", "" },
+	{ "os9-info",    "os9",   4, 24576, ".bin", "--f9info" },
+	{ "srec",        "srec",  5, 49152, ".s19", "" },
+	{ NULL }
+};
+
+int main(int argc, char **argv) {
+	char fileName[4096];
+	FILE *list;
+	int i;
+
+	if (argc == 5) return generate(argv[1], strtoul(argv[2], NULL, 0), atoi(argv[3]), argv[4]);
+	if (argc != 2) {
+		fprintf(stderr, "Usage:\ngen <dir>\ngen dense|mixed|data|os9|os9prg|os9drv|os9fm|rom|srec <seed> <size> <file>\n");
+		exit(1);
+	}
+	mkdir(argv[1], 0777);
+	snprintf(fileName, sizeof(fileName), "%s/list", argv[1]);
+	if ((list = fopen(fileName, "w")) == NULL) {
+		fprintf(stderr, "ERROR: gen: Can't write '%s'\n", fileName);
+		exit(1);
+	}
+	for (i = 0; standard[i].name; i++) {
+		snprintf(fileName, sizeof(fileName), "%s/%s-%u%s", argv[1], standard[i].kind,
+			standard[i].seed, standard[i].suffix);
+		generate(standard[i].kind, standard[i].seed, standard[i].size, fileName);
+		fprintf(list, "%s\t%s\t%s\n", standard[i].name, fileName, standard[i].options);
+	}
+	fclose(list);
+	return 0;
+}
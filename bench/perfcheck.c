@@ -0,0 +1,246 @@
+/*
+ * perfcheck.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Output and time regression check over the checked-in corpus. Each golden
+// entry names an input, the options to run it with, the FNV-1a hash of the
+// output and a time budget. Every run's output must hash the same as the
+// golden, and the median time of the runs must be within budget times the
+// scale. --update rewrites the hashes and budgets from this run, for after
+// a change that is meant to alter the output.
+//
+// perfcheck [--runs n] [--scale x] [--update] <diffdasm> <golden>
+//
+// Golden lines are name, file, options, hash and budget in ms, tab
+// separated; lines starting with # are kept as they are.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define STRMAX 4096
+#define ARGMAX 64
+#define RUNMAX 101
+#define LINEMAX 1024
+
+// Budgets written by --update: a multiple of the median, with a floor for
+// inputs so small that process start-up is most of the time
+#define BUDGET_FACTOR 3.0
+#define BUDGET_FLOOR 25.0
+
+typedef struct Entry {
+	char name[64];
+	char file[STRMAX];
+	char options[STRMAX];
+	unsigned long long hash, golden;
+	double budget, median;
+	int failed;		// Exit status, or output that differed between runs
+} Entry;
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int byValue(const void *a, const void *b) {
+	double x = *(double *)a, y = *(double *)b;
+	return x < y ? -1 : x > y;
+}
+
+// Run diffdasm once, hashing its output; return the time in ms, or -1
+static double runOnce(char *diffdasm, Entry *e, unsigned long long *hash) {
+	char *argv[ARGMAX], options[STRMAX], *p;
+	unsigned char buffer[65536];
+	int argc = 0, fds[2], status;
+	unsigned long long h = 14695981039346656037ULL;
+	ssize_t n, i;
+	double start;
+	pid_t pid;
+
+	argv[argc++] = diffdasm;
+	strcpy(options, e->options);
+	for (p = strtok(options, " "); p && argc < ARGMAX - 2; p = strtok(NULL, " "))
+		argv[argc++] = p;
+	argv[argc++] = e->file;
+	argv[argc] = NULL;
+
+	if (pipe(fds)) return -1;
+	start = now();
+	if ((pid = fork()) == 0) {
+		int null = open("/dev/null", O_WRONLY);
+		dup2(fds[1], 1);
+		dup2(null, 2);
+		close(fds[0]);
+		execv(diffdasm, argv);
+		_exit(127);
+	}
+	close(fds[1]);
+	while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+		for (i = 0; i < n; i++) {
+			h ^= buffer[i];
+			h *= 1099511628211ULL;
+		}
+	}
+	close(fds[0]);
+	waitpid(pid, &status, 0);
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+	*hash = h;
+	return (now() - start) * 1e3;
+}
+
+static void runEntry(char *diffdasm, Entry *e, int runs) {
+	double samples[RUNMAX];
+	unsigned long long hash;
+	int r;
+
+	if (runOnce(diffdasm, e, &e->hash) < 0) {	// Warm-up
+		e->failed = 1;
+		return;
+	}
+	for (r = 0; r < runs; r++) {
+		if ((samples[r] = runOnce(diffdasm, e, &hash)) < 0 || hash != e->hash) {
+			e->failed = 1;
+			return;
+		}
+	}
+	qsort(samples, runs, sizeof(double), byValue);
+	e->median = runs % 2 ? samples[runs/2] : (samples[runs/2-1] + samples[runs/2]) / 2;
+}
+
+// Read the golden entries, keeping every line for --update
+static int readGolden(char *fileName, Entry **entries, char ***lines, int *lineCount) {
+	char line[2 * STRMAX], *field[5], *p;
+	int count = 0, max = 16, lineMax = 64, f;
+	FILE *fp;
+
+	if ((fp = fopen(fileName, "r")) == NULL) {
+		fprintf(stderr, "ERROR: perfcheck: Can't open golden file '%s'\n", fileName);
+		exit(1);
+	}
+	*entries = (Entry *)calloc(max, sizeof(Entry));
+	*lines = (char **)calloc(lineMax, sizeof(char *));
+	*lineCount = 0;
+	while (fgets(line, sizeof(line), fp)) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (*lineCount == lineMax) {
+			lineMax *= 2;
+			*lines = (char **)realloc(*lines, sizeof(char *) * lineMax);
+		}
+		(*lines)[(*lineCount)++] = strdup(line);
+		if (line[0] == '\0' || line[0] == '#') continue;
+		for (p = line, f = 0; f < 5 && p; f++) {
+			field[f] = p;
+			if ((p = strchr(p, '\t'))) *p++ = '\0';
+		}
+		if (f < 5) {
+			fprintf(stderr, "ERROR: perfcheck: Golden line %d needs five fields\n", *lineCount);
+			exit(1);
+		}
+		if (count == max) {
+			max *= 2;
+			*entries = (Entry *)realloc(*entries, sizeof(Entry) * max);
+			memset(*entries + count, 0, sizeof(Entry) * (max - count));
+		}
+		snprintf((*entries)[count].name, sizeof((*entries)[count].name), "%s", field[0]);
+		snprintf((*entries)[count].file, sizeof((*entries)[count].file), "%s", field[1]);
+		snprintf((*entries)[count].options, sizeof((*entries)[count].options), "%s", field[2]);
+		(*entries)[count].golden = strtoull(field[3], NULL, 16);
+		(*entries)[count].budget = strtod(field[4], NULL);
+		free((*lines)[*lineCount - 1]);
+		(*lines)[*lineCount - 1] = NULL;	// Rewritten from the entry
+		++count;
+	}
+	fclose(fp);
+	return count;
+}
+
+static void writeGolden(char *fileName, Entry *entries, char **lines, int lineCount) {
+	char tmpName[STRMAX + 8];
+	double budget;
+	int i, e = 0;
+	FILE *fp;
+
+	snprintf(tmpName, sizeof(tmpName), "%s.tmp", fileName);
+	if ((fp = fopen(tmpName, "w")) == NULL) {
+		fprintf(stderr, "ERROR: perfcheck: Can't write '%s'\n", tmpName);
+		exit(1);
+	}
+	for (i = 0; i < lineCount; i++) {
+		if (lines[i]) {
+			fprintf(fp, "%s\n", lines[i]);
+			continue;
+		}
+		budget = entries[e].median * BUDGET_FACTOR;
+		if (budget < BUDGET_FLOOR) budget = BUDGET_FLOOR;
+		fprintf(fp, "%s\t%s\t%s\t%016llx\t%.0f\n", entries[e].name, entries[e].file,
+			entries[e].options, entries[e].hash, budget);
+		++e;
+	}
+	if (fclose(fp) || rename(tmpName, fileName)) {
+		fprintf(stderr, "ERROR: perfcheck: Can't write '%s'\n", fileName);
+		exit(1);
+	}
+}
+
+int main(int argc, char **argv) {
+	Entry *entries;
+	char **lines;
+	double scale = 1.0;
+	int runs = 5, update = 0, count, lineCount, e, failed = 0;
+
+	while (argc > 1 && !strncmp(argv[1], "--", 2)) {
+		if (!strcmp(argv[1], "--update")) {
+			update = 1;
+			argc--;
+			argv++;
+			continue;
+		}
+		if (!strcmp(argv[1], "--runs") && argc > 2) runs = atoi(argv[2]);
+		else if (!strcmp(argv[1], "--scale") && argc > 2) scale = strtod(argv[2], NULL);
+		else break;
+		argc -= 2;
+		argv += 2;
+	}
+	if (argc != 3 || runs < 1 || runs > RUNMAX || scale <= 0) {
+		fprintf(stderr, "Usage:\nperfcheck [--runs n] [--scale x] [--update] <diffdasm> <golden>\n");
+		exit(1);
+	}
+	count = readGolden(argv[2], &entries, &lines, &lineCount);
+
+	printf("Median ms of %d runs\n%-14s %10s %10s  %s\n", runs, "Entry", "ms", "budget", "result");
+	for (e = 0; e < count; e++) {
+		Entry *en = &entries[e];
+		runEntry(argv[1], en, runs);
+		printf("%-14s", en->name);
+		if (en->failed) {
+			printf(" %10s %10s  FAILED (exit status, or output differs between runs): %s %s\n",
+				"-", "-", en->options, en->file);
+			failed = 1;
+			continue;
+		}
+		printf(" %10.3f %10.0f  ", en->median, en->budget * scale);
+		if (update) printf("updated\n");
+		else if (en->hash != en->golden) {
+			printf("OUTPUT CHANGED (%016llx, golden %016llx)\n", en->hash, en->golden);
+			failed = 1;
+		} else if (en->median > en->budget * scale) {
+			printf("OVER BUDGET\n");
+			failed = 1;
+		} else printf("ok\n");
+		fflush(stdout);
+	}
+	if (update && !failed) writeGolden(argv[2], entries, lines, lineCount);
+	for (e = 0; e < lineCount; e++) free(lines[e]);
+	free(lines);
+	free(entries);
+	return failed;
+}
@@ -0,0 +1,1170 @@
+/*
+ * ref6809.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Reference 6809 decoder: a frozen copy of the stats6809.c tables and of
+// REF_bytes, REF_flags, REF_mode, REF_transfer and REF_pcrel
+// as they were before any rework for speed. bench/decoder checks the live
+// decoder against it. Don't fix anything here; a change in behaviour
+// belongs in stats6809.c, and then this copy should be retaken with the
+// reason in the commit.
+
+#include <stdio.h>
+
+#include "../memoryfile.h"
+#include "../os9stuff.h"
+#include "../stats6809.h"
+#include "ref6809.h"
+
+extern int swipb, swi2pb, swi3pb;
+
+static Instruction ref_page00[] =
+{
+	// 00
+	{"NEG",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"OIM",NULL,DIRECT,3,HAS_6309},
+	{"AIM",NULL,DIRECT,3,HAS_6309},
+	{"COM",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"LSR",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"EIM",NULL,DIRECT,3,HAS_6309},
+	{"ROR",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ASR",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ASL",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ROL",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"DEC",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"TIM",NULL,DIRECT,3,HAS_6309},
+	{"INC",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"TST",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"JMP",NULL,DIRECT,2,(LEAF|HAS_6809|HAS_6309)},
+	{"CLR",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	// 10
+	{"",NULL,PREBYTE10,1,(HAS_6809|HAS_6309)},
+	{"",NULL,PREBYTE11,1,(HAS_6809|HAS_6309)},
+	{"NOP",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"SYNC",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"SEXW",NULL,INHERENT,1,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LBRA","BBRA",REL_16,3,(TRANSFER|LEAF|HAS_6809|HAS_6309)},
+	{"LBSR","BBSR",REL_16,3,(TRANSFER|HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"DAA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ORCC",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ANDCC",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"SEX",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"EXG",NULL,REGISTER,2,(HAS_6809|HAS_6309)},
+	{"TFR",NULL,REGISTER,2,(HAS_6809|HAS_6309)},
+	// 20
+	{"BRA","BBRA",REL_8,2,(TRANSFER|LEAF|HAS_6809|HAS_6309)},
+	{"BRN","BBRN",REL_8,2,(HAS_6809|HAS_6309)}, // Not TRANSFER because, SKIP1
+	{"BHI","BBHI",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BLS","BBLS",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BCC","BBCC",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BCS","BBCS",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BNE","BBNE",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BEQ","BBEQ",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BVC",",BVC",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BVS","BBVS",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BPL","BBPL",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BMI","BBMI",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BGE","BBGE",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BLT","BBLT",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BGT","BBGE",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"BLE","BBLE",REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	// 30
+	{"LEAX",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LEAY",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LEAS",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LEAU",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"PSHS",NULL,REG_PUSH_S,2,(HAS_6809|HAS_6309)},
+	{"PULS",NULL,REG_PULL_S,2,(HAS_6809|HAS_6309)},
+	{"PSHU",NULL,REG_PUSH_U,2,(HAS_6809|HAS_6309)},
+	{"PULU",NULL,REG_PULL_U,2,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"RTS",NULL,INHERENT,1,(LEAF|HAS_6809|HAS_6309)},
+	{"ABX",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"RTI",NULL,INHERENT,1,(LEAF|HAS_6809|HAS_6309)},
+	{"CWAI",NULL,INHERENT,2,(HAS_6809|HAS_6309)},
+	{"MUL",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"SWI",NULL,INHERENT,1,(TRANSFER|HAS_6809|HAS_6309)},
+	// 40
+	{"NEGA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"COMA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"LSRA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"RORA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ASRA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ASLA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ROLA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"DECA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"INCA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"TSTA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CLRA",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	// 50
+	{"NEGB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"COMB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"LSRB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"RORB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ASRB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ASLB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"ROLB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"DECB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"INCB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"TSTB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CLRB",NULL,INHERENT,1,(HAS_6809|HAS_6309)},
+	// 60
+	{"NEG",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"OIM",NULL,INDEXED,3,HAS_6309},
+	{"AIM",NULL,INDEXED,3,HAS_6309},
+	{"COM",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LSR",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"EIM",NULL,INDEXED,3,HAS_6309},
+	{"ROR",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ASR",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ASL",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ROL",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"DEC",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"TIM",NULL,INDEXED,3,HAS_6309},
+	{"INC",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"TST",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"JMP",NULL,INDEXED,2,(LEAF|HAS_6809|HAS_6309)},
+	{"CLR",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	// 70
+	{"NEG",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"OIM",NULL,EXTENDED,4,HAS_6309},
+	{"AIM",NULL,EXTENDED,4,HAS_6309},
+	{"COM",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"LSR",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"EIM",NULL,EXTENDED,4,HAS_6309},
+	{"ROR",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ASR",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ASL",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ROL",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"DEC",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"TIM",NULL,EXTENDED,4,HAS_6309},
+	{"INC",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"TST",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"JMP",NULL,EXTENDED,3,(LEAF|HAS_6809|HAS_6309)},
+	{"CLR",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	// 80
+	{"SUBA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"CMPA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"SBCA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"SUBD",NULL,IMMED_8,3,(HAS_6809|HAS_6309)},
+	{"ANDA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"BITA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"LDA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"EORA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ADCA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ORA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ADDA",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"CMPX",NULL,IMMED_16,3,(HAS_6809|HAS_6309)},
+	{"BSR",NULL,REL_8,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LDX",NULL,IMMED_16,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	// 90
+	{"SUBA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"CMPA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"SBCA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"SUBD",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ANDA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"BITA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"LDA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"STA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"EORA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ADCA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ORA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ADDA",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"CMPX",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"JSR",NULL,DIRECT,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LDX",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"STX",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+    // A0
+	{"SUBA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"CMPA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"SBCA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"SUBD",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ANDA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"BITA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LDA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"STA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"EORA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ADCA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ORA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ADDA",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"CMPX",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"JSR",NULL,INDEXED,2,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LDX",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"STX",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+    // B0
+	{"SUBA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"CMPA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"SBCA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"SUBD",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ANDA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"BITA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"LDA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"STA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"EORA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ADCA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ORA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ADDA",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"CMPX",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"JSR",NULL,EXTENDED,3,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LDX",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"STX",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+    // C0
+	{"SUBB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"CMPB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"SBCB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ADDD",NULL,IMMED_16,3,(HAS_6809|HAS_6309)},
+	{"ANDB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"BITB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"LDB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"EORB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ADCB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ORB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"ADDB",NULL,IMMED_8,2,(HAS_6809|HAS_6309)},
+	{"LDD",NULL,IMMED_16,3,(HAS_6809|HAS_6309)},
+	{"LDQ",NULL,IMMED_32,5,HAS_6309},
+	{"LDU",NULL,IMMED_16,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+    // D0
+	{"SUBB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"CMPB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"SBCB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ADDD",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ANDB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"BITB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"LDB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"STB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"EORB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ADCB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ORB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"ADDB",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"LDD",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"STD",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"LDU",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+	{"STU",NULL,DIRECT,2,(HAS_6809|HAS_6309)},
+    // E0
+	{"SUBB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"CMPB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"SBCB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ADDD",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ANDB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"BITB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LDB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"STB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"EORB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ADCB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ORB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"ADDB",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LDD",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"STD",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"LDU",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+	{"STU",NULL,INDEXED,2,(HAS_6809|HAS_6309)},
+    // F0
+	{"SUBB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"CMPB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"SBCB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ADDD",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ANDB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"BITB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"LDB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"STB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"EORB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ADCB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ORB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"ADDB",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"LDD",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"STD",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"LDU",NULL,EXTENDED,3,(HAS_6809|HAS_6309)},
+	{"STU",NULL,EXTENDED,3,(HAS_6809|HAS_6309)}
+};
+
+static Instruction ref_page10[] =
+{
+	// 00
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	// 10
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	// 20
+	{"",NULL,INVALID,1,NEITHER},
+	{"LBRN","BBRN",REL_16,4,(HAS_6809|HAS_6309)}, // Not TRANSFER because SKIP2
+	{"LBHI","BBHI",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBLS","BBLS",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBCC","BBCC",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBCS","BBCS",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBNE","BBNE",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBEQ","BBEQ",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBVC","BBVC",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBVS","BBVS",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBPL","BBPL",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBMI","BBMI",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBGE","BBGE",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBLT","BBLT",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBGT","BBGT",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	{"LBLE","BBLE",REL_16,4,(TRANSFER|HAS_6809|HAS_6309)},
+	// 30
+	{"ADDR",NULL,REGISTER,3,HAS_6309},
+	{"ADCR",NULL,REGISTER,3,HAS_6309},
+	{"SUBR",NULL,REGISTER,3,HAS_6309},
+	{"SBCR",NULL,REGISTER,3,HAS_6309},
+	{"ANDR",NULL,REGISTER,3,HAS_6309},
+	{"ORR",NULL,REGISTER,3,HAS_6309},
+	{"EORR",NULL,REGISTER,3,HAS_6309},
+	{"CMPR",NULL,REGISTER,3,HAS_6309},
+	{"PSHSW",NULL,INHERENT,2,HAS_6309},
+	{"PULSW",NULL,INHERENT,2,HAS_6309},
+	{"PSHUW",NULL,INHERENT,2,HAS_6309},
+	{"PULUW",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"SWI2",NULL,INHERENT,2,(TRANSFER|HAS_6809|HAS_6309)}, // For OS9, 3 bytes
+	{"NEGD",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"COMD",NULL,INHERENT,2,HAS_6309},
+	{"LSRD",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"RORD",NULL,INHERENT,2,HAS_6309},
+	{"ASRD",NULL,INHERENT,2,HAS_6309},
+	{"ASLD",NULL,INHERENT,2,HAS_6309},
+	{"ROLD",NULL,INHERENT,2,HAS_6309},
+	{"DECD",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"INCD",NULL,INHERENT,2,HAS_6309},
+	{"TSTD",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CLRD",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"COMW",NULL,INHERENT,2,HAS_6309},
+	{"LSRW",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"RORW",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ROLW",NULL,INHERENT,2,HAS_6309},
+	{"DECW",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"INCW",NULL,INHERENT,2,HAS_6309},
+	{"TSTW",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CLRW",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"SUBW",NULL,IMMED_16,4,HAS_6309},
+	{"CMPW",NULL,IMMED_16,4,HAS_6309},
+	{"SBCD",NULL,IMMED_16,4,HAS_6309},
+	{"CMPD",NULL,IMMED_16,4,(HAS_6809|HAS_6309)},
+	{"ANDD",NULL,IMMED_16,4,HAS_6309},
+	{"BITD",NULL,IMMED_16,4,HAS_6309},
+	{"LDW",NULL,IMMED_16,4,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"EORD",NULL,IMMED_16,4,HAS_6309},
+	{"ADCD",NULL,IMMED_16,4,HAS_6309},
+	{"ORD",NULL,IMMED_16,4,HAS_6309},
+	{"ADDW",NULL,IMMED_16,4,HAS_6309},
+	{"CMPY",NULL,IMMED_16,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDY",NULL,IMMED_16,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"SUBW",NULL,DIRECT,3,HAS_6309},
+	{"CMPW",NULL,DIRECT,3,HAS_6309},
+	{"SBCD",NULL,DIRECT,3,HAS_6309},
+	{"CMPD",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"ANDD",NULL,DIRECT,3,HAS_6309},
+	{"BITD",NULL,DIRECT,3,HAS_6309},
+	{"LDW",NULL,DIRECT,3,HAS_6309},
+	{"STW",NULL,DIRECT,3,HAS_6309},
+	{"EORD",NULL,DIRECT,3,HAS_6309},
+	{"ADCD",NULL,DIRECT,3,HAS_6309},
+	{"ORD",NULL,DIRECT,3,HAS_6309},
+	{"ADDW",NULL,DIRECT,3,HAS_6309},
+	{"CMPY",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDY",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"STY",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"SUBW",NULL,WINDEXED,3,HAS_6309},
+	{"CMPW",NULL,WINDEXED,3,HAS_6309},
+	{"SBCD",NULL,INDEXED,3,HAS_6309},
+	{"CMPD",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"ANDD",NULL,INDEXED,3,HAS_6309},
+	{"BITD",NULL,INDEXED,3,HAS_6309},
+	{"LDW",NULL,WINDEXED,3,HAS_6309},
+	{"STW",NULL,WINDEXED,3,HAS_6309},
+	{"EORD",NULL,INDEXED,3,HAS_6309},
+	{"ADCD",NULL,INDEXED,3,HAS_6309},
+	{"ORD",NULL,INDEXED,3,HAS_6309},
+	{"ADDW",NULL,WINDEXED,3,HAS_6309},
+	{"CMPY",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDY",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"STY",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"SUBW",NULL,EXTENDED,4,HAS_6309},
+	{"CMPW",NULL,EXTENDED,4,HAS_6309},
+	{"SBCD",NULL,EXTENDED,4,HAS_6309},
+	{"CMPD",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"ANDD",NULL,EXTENDED,4,HAS_6309},
+	{"BITD",NULL,EXTENDED,4,HAS_6309},
+	{"LDW",NULL,EXTENDED,4,HAS_6309},
+	{"STW",NULL,EXTENDED,4,HAS_6309},
+	{"EORD",NULL,EXTENDED,4,HAS_6309},
+	{"ADCD",NULL,EXTENDED,4,HAS_6309},
+	{"ORD",NULL,EXTENDED,4,HAS_6309},
+	{"ADDW",NULL,EXTENDED,4,HAS_6309},
+	{"CMPY",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDY",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"STY",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDS",NULL,IMMED_16,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDQ",NULL,DIRECT,3,HAS_6309},
+	{"STQ",NULL,DIRECT,3,HAS_6309},
+	{"LDS",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"STS",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDQ",NULL,INDEXED,3,HAS_6309},
+	{"STQ",NULL,INDEXED,3,HAS_6309},
+	{"LDS",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"STS",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDQ",NULL,EXTENDED,4,HAS_6309},
+	{"STQ",NULL,EXTENDED,4,HAS_6309},
+	{"LDS",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"STS",NULL,EXTENDED,4,(HAS_6809|HAS_6309)}
+};
+
+static Instruction ref_page11[] =
+{
+// 0x
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+// 1x
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+// 2x
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+// 3x
+	{"BAND",NULL,SINGLE_BIT,4,HAS_6309},
+	{"BIAND",NULL,SINGLE_BIT,4,HAS_6309},
+	{"BOR",NULL,SINGLE_BIT,4,HAS_6309},
+	{"BIOR",NULL,SINGLE_BIT,4,HAS_6309},
+	{"BEOR",NULL,SINGLE_BIT,4,HAS_6309},
+	{"BIEOR",NULL,SINGLE_BIT,4,HAS_6309},
+	{"LDBT",NULL,SINGLE_BIT,4,HAS_6309},
+	{"STBT",NULL,SINGLE_BIT,4,HAS_6309},
+	{"TFM",NULL,REGISTER,3,HAS_6309},
+	{"TFM",NULL,REGISTER,3,HAS_6309},
+	{"TFM",NULL,REGISTER,3,HAS_6309},
+	{"TFM",NULL,REGISTER,3,HAS_6309},
+	{"BITMD",NULL,IMMED_8,3,HAS_6309},
+	{"LDMD",NULL,IMMED_8,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"SWI3",NULL,INHERENT,2,(TRANSFER|HAS_6809|HAS_6309)},
+// 4x
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"COME",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"DECE",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"INCE",NULL,INHERENT,2,HAS_6309},
+	{"TSTE",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CLRE",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"COMF",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"DECF",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"INCF",NULL,INHERENT,2,HAS_6309},
+	{"TSTF",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CLRF",NULL,INHERENT,2,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"SUBE",NULL,IMMED_8,3,HAS_6309},
+	{"CMPE",NULL,IMMED_8,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CMPU",NULL,IMMED_16,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDE",NULL,IMMED_8,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDE",NULL,IMMED_8,3,HAS_6309},
+	{"CMPS",NULL,IMMED_16,4,(HAS_6809|HAS_6309)},
+	{"DIVD",NULL,IMMED_16,3,HAS_6309},
+	{"DIVQ",NULL,IMMED_16,4,HAS_6309},
+	{"MULD",NULL,IMMED_16,4,HAS_6309},
+// 9x
+	{"SUBE",NULL,DIRECT,3,HAS_6309},
+	{"CMPE",NULL,DIRECT,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CMPU",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDE",NULL,DIRECT,3,HAS_6309},
+	{"STE",NULL,DIRECT,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDE",NULL,DIRECT,3,HAS_6309},
+	{"CMPS",NULL,DIRECT,3,(HAS_6809|HAS_6309)},
+	{"DIVD",NULL,DIRECT,3,HAS_6309},
+	{"DIVQ",NULL,DIRECT,3,HAS_6309},
+	{"MULD",NULL,DIRECT,3,HAS_6309},
+// Ax
+	{"SUBE",NULL,INDEXED,3,HAS_6309},
+	{"CMPE",NULL,INDEXED,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CMPU",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDE",NULL,INDEXED,3,HAS_6309},
+	{"STE",NULL,INDEXED,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDE",NULL,INDEXED,3,HAS_6309},
+	{"CMPS",NULL,INDEXED,3,(HAS_6809|HAS_6309)},
+	{"DIVD",NULL,INDEXED,3,HAS_6309},
+	{"DIVQ",NULL,INDEXED,3,HAS_6309},
+	{"MULD",NULL,INDEXED,3,HAS_6309},
+// Bx
+	{"SUBE",NULL,EXTENDED,4,HAS_6309},
+	{"CMPE",NULL,EXTENDED,4,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"CMPU",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDE",NULL,EXTENDED,4,HAS_6309},
+	{"STE",NULL,EXTENDED,4,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDE",NULL,EXTENDED,4,HAS_6309},
+	{"CMPS",NULL,EXTENDED,4,(HAS_6809|HAS_6309)},
+	{"DIVD",NULL,EXTENDED,4,HAS_6309},
+	{"DIVQ",NULL,EXTENDED,4,HAS_6309},
+	{"MULD",NULL,EXTENDED,4,HAS_6309},
+// Cx
+	{"SUBF",NULL,IMMED_8,3,HAS_6309},
+	{"CMPF",NULL,IMMED_8,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDF",NULL,IMMED_8,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDF",NULL,IMMED_8,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+// Dx
+	{"SUBF",NULL,DIRECT,3,HAS_6309},
+	{"CMPF",NULL,DIRECT,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDF",NULL,DIRECT,3,HAS_6309},
+	{"STF",NULL,DIRECT,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDF",NULL,DIRECT,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+// Ex
+	{"SUBF",NULL,INDEXED,3,HAS_6309},
+	{"CMPF",NULL,INDEXED,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDF",NULL,INDEXED,3,HAS_6309},
+	{"STF",NULL,INDEXED,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDF",NULL,INDEXED,3,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+// Fx
+    {"SUBF",NULL,EXTENDED,4,HAS_6309},
+	{"CMPF",NULL,EXTENDED,4,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"LDF",NULL,EXTENDED,4,HAS_6309},
+	{"STF",NULL,EXTENDED,4,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"ADDF",NULL,EXTENDED,4,HAS_6309},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER},
+	{"",NULL,INVALID,1,NEITHER}
+};
+
+// Indexed addressing mode from lower 5 bits of postbyte
+static short ref_pb6809[] = {
+        // 000xx
+    POSTINC_1,	POSTINC_2,	PREDEC_1,	PREDEC_2,
+        // 001xx
+	OFFSET_0,	OFFSET_B,	OFFSET_A,	OFFSET_E,
+        // 010xx
+	OFFSET_8,	OFFSET_16,	OFFSET_F,	OFFSET_D,
+        // 011xx
+	PCR_8,		PCR_16,	OFFSET_W,	IDXINVALID,
+        // 100xx
+	IDXINVALID,IPOSTINC_2,IDXINVALID,IPREDEC_2,
+        // 101xx
+	IOFFSET_0,	IOFFSET_B,	IOFFSET_A,	IOFFSET_E,
+        // 110xx
+    IOFFSET_8,	IOFFSET_16,IOFFSET_F,IOFFSET_D,
+        // 111xx
+	IPCR_8,	IPCR_16,	IOFFSET_W,	IEXTENDED
+};
+
+// Extra instruction bytes from indexed addressing mode code
+// Works for 6809 and 6309
+static short ref_idxExtra[] = {
+    // OFFSET_0,    OFFSET_5,   OFFSET_8,   OFFSET_16,  OFFSET_A,   OFFSET_B,   OFFSET_D,   OFFSET_E
+    0,      0,	    1,	    2,	    0,	    0,	    0,      0,
+    // OFFSET_F,    OFFSET_W,   POSTINC_1,  POSTINC_2,  PREDEC_1,   PREDEC_2,   PCR_8,      PCR_16
+	0,      0,      0,      0,      0,      0,  1,      2,
+	// IOFFSET_0,   IOFFSET_8,  IOFFSET_16, IOFFSET_A,  IOFFSET_B,  IOFFSET_D,  IOFFSET_E,  IOFFSET_F
+	0,      1,      2,      0,      0,      0,      0,  0,
+	// IOFFSET_W,   IPOSTINC_2, IPREDEC_2,  IPCR_8,     IPCR_16,    IEXTENDED,  IDXINVALID
+	0,      0,      0,      1,      2,      2,      -1
+};
+
+static short REF_pbIndexMode(MemoryFile* mod, int offset) {
+	// Note: offset points to known index postbyte
+	unsigned char postByte = mod->storage[offset];
+	unsigned char pbMasked = postByte & 0b00011111;
+	if (postByte == 0b10011111) {
+		return	IEXTENDED;
+	}
+	if (!(postByte & 0b10000000)) {
+		return	OFFSET_5;
+	}
+	return ref_pb6809[pbMasked];
+}
+
+static short REF_indexBytes(MemoryFile* mod, int offset) {
+	// Note: offset points to postbyte
+	// Return count of additional instruction bytes based on indexed mode
+	// This code doesn't check the end of the module, since
+	// it doesn't know how many other bytes are in the instruction
+	return ref_idxExtra[REF_pbIndexMode(mod, offset) & 0x1F];
+}
+
+static short REF_bytes10(MemoryFile* mod, int offset) {
+	// Note: offset points to postbyte
+	short baseBytes, indexBytes;
+	Instruction i = ref_page10[mod->storage[offset]];
+    baseBytes = i.bytes;
+	if (i.flags & HAS_6809) {
+		switch (i.mode) {
+			case INDEXED:
+				// Opcode followed immediately by indexing mode byte
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return 1;
+				}
+				indexBytes = REF_indexBytes(mod, offset+1);
+                baseBytes = (indexBytes == -1) ? 1 : baseBytes + indexBytes;
+				break;
+			default:
+				break;
+		}
+		if (mod->storage[offset] == SWI2_2) {
+			// In OS9 SWI2 is followed by a postbyte
+            // Note that for OS9 this is disassemled as OS9 callID
+            // but on other systems they show up as FCB on the
+            // following line and a push of the subsequent address.
+			baseBytes += swi2pb;
+		}
+	} else {
+		// Not a valid 6809 opcode
+		baseBytes = 1;
+	}
+	return baseBytes;
+}
+
+static short REF_bytes11(MemoryFile* mod, int offset) {
+	short baseBytes, indexBytes;
+	Instruction i = ref_page11[mod->storage[offset]];
+    baseBytes = i.bytes;
+	if (i.flags & HAS_6809) {
+		switch (i.mode) {
+			case INDEXED:
+				// Opcode followed immediately by indexing mode byte
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return 1;
+				}
+				indexBytes = REF_indexBytes(mod, offset+1);
+                baseBytes = (indexBytes == -1) ? 1 : baseBytes + indexBytes;
+				break;
+			default:
+				break;
+		}
+        if (mod->storage[offset] == SWI3_2) {
+            // SWI3 may be followed by some number of postbytes but
+            // they show up as FCB on the following line and a push
+            // of the subsequent address.
+            baseBytes += swi3pb;
+        }
+    } else {
+		// Not a valid 6809 opcode
+		baseBytes = 1;
+	}
+	return baseBytes;
+}
+
+short REF_bytes(MemoryFile* mod, int offset) {
+	short baseBytes, indexBytes;
+	Instruction i = ref_page00[mod->storage[offset]];
+    baseBytes = i.bytes;
+	if (i.flags & HAS_6809) {
+		switch (i.mode) {
+			case INDEXED:
+				// Opcode followed immediately by indexing mode byte
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return 1;
+				}
+                indexBytes = REF_indexBytes(mod, offset+1);
+                baseBytes = (indexBytes == -1) ? 1 : baseBytes + indexBytes;
+                break;
+			case PREBYTE10:
+				// Prebyte followed immediately by extended opcode byte
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return 1;
+				}
+				baseBytes = REF_bytes10(mod, offset+1);
+				break;
+			case PREBYTE11:
+				// Prebyte followed immediately by extended opcode byte
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return 1;
+				}
+				baseBytes = REF_bytes11(mod, offset+1);
+				break;
+			default:
+				break;
+		}
+        if (mod->storage[offset] == SWI_1) {
+            // SWI may be followed by some number of postbytes but
+            // they show up as FCB on the following line and a push
+            // of the subsequent address.
+            baseBytes += swipb;
+        }
+	} else {
+		// Not a valid 6809 opcode
+		baseBytes = 1;
+	}
+    if (offset+baseBytes > mod->length) {
+		// Not enough postbytes available; exit
+		baseBytes = 1;
+	}
+	return baseBytes;
+}
+
+unsigned char REF_flags(MemoryFile* mod, int offset) {
+	// WARNING: Caller must check flags for HAS_6809
+	// NOTE: PULS and PULU can be LEAF if pull PC
+	// NOTE: TFR and EXG can be LEAF if modify PC
+	unsigned char flags;
+	unsigned char opcode = mod->storage[offset];
+	unsigned char postbyte;
+	Instruction i = ref_page00[opcode];
+	switch (i.mode) {
+		case PREBYTE10:
+			// Prebyte followed immediately by extended opcode byte
+			if (offset != mod->length) {
+				opcode = mod->storage[offset+1];
+				return ref_page10[opcode].flags;
+			}
+			break;
+		case PREBYTE11:
+			// Prebyte followed immediately by extended opcode byte
+			if (offset != mod->length) {
+				opcode = mod->storage[offset+1];
+				return ref_page11[opcode].flags;
+			}
+			break;
+		default:
+			flags = i.flags;
+			switch(opcode) {
+				case 0x1E: // EXG
+					// Leaf if either register is PC
+					if (offset != mod->length) {
+						postbyte = mod->storage[offset+1];
+						flags |= ((postbyte & TREG_MASK) == TREG_PC) ? LEAF : 0;
+						flags |= ((postbyte & (TREG_MASK<<4)) == (TREG_PC<<4)) ? LEAF : 0;
+					}
+					break;
+				case 0x1F: // TFR
+					// Leaf if destination is PC
+					if (offset != mod->length) {
+						postbyte = mod->storage[offset+1];
+						flags |= ((postbyte & TREG_MASK) == TREG_PC) ? LEAF : 0;
+					}
+					break;
+				case 0x35: // PULS
+				case 0x37: // PULU
+					// Leaf if postbyte includes PC
+					if (offset != mod->length) {
+						postbyte = mod->storage[offset+1];
+						flags |= (postbyte & PREG_PC) ? LEAF : 0;
+					}
+					break;
+			}
+			return flags;
+	}
+
+	// Not a valid 6809 opcode or no postbyte available
+	return NEITHER;
+}
+
+// Fetch two bytes
+static unsigned short REF_get16(MemoryFile *mod, int offset) {
+	unsigned short word;
+	word = ((mod->storage[offset+0] << 8) | mod->storage[offset+1]);
+	return word;
+}
+
+// Return destination address of a control transfer (or -1)
+int REF_transfer(MemoryFile* mod, int offset) {
+	int postByte, length;
+	unsigned char flags = REF_flags(mod, offset);
+	if (flags & TRANSFER) {
+		unsigned char opc = mod->storage[offset+0];
+		if ((opc >= 0x20 && opc < 0x30) || opc == 0x8D) {
+			// Branch / bsr instructions with knowable destinations
+			// Result is PC after instruction, plus signed offset
+			length = REF_bytes(mod, offset);
+			postByte = mod->storage[offset+1];
+			if (postByte & 0b10000000) postByte |= (-1 & ~0b01111111); // Sign extend
+			return offset + length + postByte;
+		} else if ((opc == 0x16) || (opc == 0x17)) {
+			// Long branch / lbsr instructions with knowable destinations
+			// Result is PC after instruction, plus signed offset
+			length = REF_bytes(mod, offset);
+			postByte = REF_get16(mod, offset+1);
+			if (postByte & 0b1000000000000000) postByte |= (-1 & ~0b0111111111111111); // Sign extend
+			return offset + length + postByte;
+		} else if (opc == 0x10) {
+			postByte = mod->storage[offset+1];
+			if (postByte >= 0x21 && postByte < 0x30) {
+				// Long branch instructions with knowable destinations
+				// Result is PC after instruction, plus signed offset
+				length = REF_bytes(mod, offset);
+				postByte = REF_get16(mod, offset+2);
+				if (postByte & 0b1000000000000000) postByte |= (-1 & ~0b0111111111111111); // Sign extend
+				return offset + length + postByte;
+			}
+		}
+	}
+	// No transfer address, or unknown transfer address
+	return  -1;
+}
+
+int REF_mode(MemoryFile* mod, int offset) {
+	// Addressing mode of instruction
+	int mode = INVALID;
+	Instruction i = ref_page00[mod->storage[offset]];
+	if (i.flags & HAS_6809) {
+		switch (i.mode) {
+			case PREBYTE10:
+				// Prebyte followed immediately by extended opcode byte
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return INVALID;
+				}
+				i = ref_page10[mod->storage[++offset]];
+				break;
+			case PREBYTE11:
+				if (offset == mod->length) {
+					// No postbyte available; exit
+					return INVALID;
+				}
+				i = ref_page11[mod->storage[++offset]];
+				break;
+			default:
+				break;
+		}
+		mode = i.mode;
+		if (mode == INDEXED) {
+			// Opcode followed immediately by indexing mode byte
+			if (offset == mod->length) {
+				// No postbyte available; exit
+				return INVALID;
+			}
+			mode = REF_pbIndexMode(mod, offset+1);
+		}
+	}
+	return mode;
+}
+
+// Return PC relative effective address of an instruction
+int REF_pcrel(MemoryFile* mod, int offset) {
+	int length, postByte;
+	int dest = REF_transfer(mod, offset);
+	if (dest == -1) {
+		// Check for pc-relative indexed addressing
+		int mode = REF_mode(mod, offset);
+		switch (mode) {
+			case	REL_8:
+			case	PCR_8:
+			case	IPCR_8:
+				length = REF_bytes(mod, offset);
+				postByte = mod->storage[offset+length-1];
+				if (postByte & 0b10000000) postByte |= (-1 & ~0b01111111); // Sign extend
+				return (offset + length + postByte) & 0xFFFF;
+			case	REL_16:
+			case	PCR_16:
+			case	IPCR_16:
+				length = REF_bytes(mod, offset);
+				postByte = REF_get16(mod, offset+length-2);
+				if (postByte & 0b1000000000000000) postByte |= (-1 & ~0b0111111111111111); // Sign extend
+				return (offset + length + postByte) & 0xFFFF;
+			default:
+				dest = -1;
+				break;
+		}
+	}
+	return dest;
+}
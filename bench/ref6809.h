@@ -0,0 +1,20 @@
+/*
+ * ref6809.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef REF6809_H_
+#define REF6809_H_
+
+#include "../memoryfile.h"
+
+// The reference decoder, as the M6809_ functions of the same names
+short REF_bytes(MemoryFile* mod, int offset);
+unsigned char REF_flags(MemoryFile* mod, int offset);
+int REF_mode(MemoryFile* mod, int offset);
+int REF_transfer(MemoryFile* mod, int offset);
+int REF_pcrel(MemoryFile* mod, int offset);
+
+#endif /* REF6809_H_ */
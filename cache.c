@@ -0,0 +1,318 @@
+/*
+ * cache.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Content addressed result cache. Each entry is one file, named by a
+// hash of the image and options, holding the complete output and the
+// line index. Entries are written to a temporary name and renamed, so
+// concurrent runs sharing a directory never see a partial entry. A hit
+// touches the entry, and eviction removes the oldest entries first.
+//
+// A resident server also keeps a cache in memory shared by its workers.
+// Entries are stored one after another around a ring, overwriting the
+// oldest; a small table finds them. A process-shared mutex guards both;
+// it's robust, so a worker killed while holding it doesn't hang the rest.
+// The next worker to lock it empties the cache, since the killed worker
+// may have left an entry half written.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+
+#include "outbuf.h"
+#include "lineindex.h"
+#include "cache.h"
+
+#define CACHE_MAGIC "DDCC"
+#define CACHE_VERSION 1		// Bump when output changes for the same options
+#define CACHE_SUFFIX ".ddc"
+#define SHARED_SLOTS 4096		// Most entries kept in shared memory
+
+typedef struct SharedSlot {
+  CacheKey key;
+  size_t at;		// Offset in the ring: output, then index entries
+  size_t outLength;
+  int indexCount;
+  unsigned base;
+} SharedSlot;
+
+typedef struct SharedCache {
+  pthread_mutex_t lock;
+  int count;		// Slots in use
+  size_t size;		// Ring bytes
+  size_t next;		// Where the next entry goes
+  SharedSlot slot[SHARED_SLOTS];
+  char ring[];
+} SharedCache;
+
+static SharedCache *shared = NULL;
+
+static void entryPath(char *path, size_t size, char *dir, CacheKey *key) {
+	snprintf(path, size, "%s/%016llx%s", dir, key->hash, CACHE_SUFFIX);
+}
+
+int cache_key(CacheKey *key, char *fileName, char *options) {
+	unsigned char buffer[4096];
+	unsigned long long h = 14695981039346656037ULL, c = 5381;
+	size_t n, i;
+	FILE *fp = fopen(fileName, "rb");
+	char version[16];
+
+	if (fp == NULL) return 0;
+	key->length = 0;
+	// FNV-1a names the entry; a djb2 variant checks it
+	while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+		for (i = 0; i < n; i++) {
+			h = (h ^ buffer[i]) * 1099511628211ULL;
+			c = (c * 33) ^ buffer[i];
+		}
+		key->length += n;
+	}
+	fclose(fp);
+	sprintf(version, "/%d/", CACHE_VERSION);
+	for (i = 0; version[i]; i++) {
+		h = (h ^ (unsigned char)version[i]) * 1099511628211ULL;
+		c = (c * 33) ^ (unsigned char)version[i];
+	}
+	for (i = 0; options[i]; i++) {
+		h = (h ^ (unsigned char)options[i]) * 1099511628211ULL;
+		c = (c * 33) ^ (unsigned char)options[i];
+	}
+	key->hash = h;
+	key->check = c;
+	return 1;
+}
+
+static void put64(unsigned char *p, unsigned long long value) {
+	int i;
+	for (i = 0; i < 8; i++) p[i] = (value >> (8 * i)) & 0xFF;
+}
+
+static unsigned long long get64(unsigned char *p) {
+	unsigned long long value = 0;
+	int i;
+	for (i = 7; i >= 0; i--) value = (value << 8) | p[i];
+	return value;
+}
+
+void cache_share(long maxBytes) {
+	pthread_mutexattr_t attr;
+	void *p = mmap(NULL, sizeof(SharedCache) + maxBytes, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_ANON, -1, 0);
+	if (p == MAP_FAILED) {
+		fprintf(stderr, "ERROR: cache_share: Can't map %ld bytes of shared memory\n", maxBytes);
+		exit(1);
+	}
+	shared = (SharedCache *)p;
+	shared->size = maxBytes;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+	if (pthread_mutex_init(&shared->lock, &attr)) {
+		fprintf(stderr, "ERROR: cache_share: Can't create the shared cache lock\n");
+		exit(1);
+	}
+	pthread_mutexattr_destroy(&attr);
+}
+
+int cache_isShared() {
+	return shared != NULL;
+}
+
+static void lock() {
+	if (pthread_mutex_lock(&shared->lock) == EOWNERDEAD) {
+		// Its last holder died; start again with an empty cache
+		shared->count = 0;
+		shared->next = 0;
+		pthread_mutex_consistent(&shared->lock);
+	}
+}
+
+static void unlock() {
+	pthread_mutex_unlock(&shared->lock);
+}
+
+static int sharedFetch(CacheKey *key, OutBuf *out, LineIndex *index) {
+	SharedSlot *s = NULL;
+	int i;
+
+	lock();
+	for (i = 0; i < shared->count && s == NULL; i++) {
+		if (shared->slot[i].key.hash == key->hash && shared->slot[i].key.check == key->check
+				&& shared->slot[i].key.length == key->length) s = &shared->slot[i];
+	}
+	if (s == NULL) {
+		unlock();
+		return 0;
+	}
+	out->length = 0;
+	ob_write(out, shared->ring + s->at, s->outLength);
+	index->top = 0;
+	for (i = 0; i < s->indexCount; i++)
+		li_push(index, (LineList *)(shared->ring + s->at + s->outLength) + i);
+	index->base = s->base;
+	unlock();
+	return 1;
+}
+
+static void sharedStore(CacheKey *key, OutBuf *out, LineIndex *index) {
+	size_t length = out->length + sizeof(LineList) * index->top;
+	size_t at;
+	SharedSlot *s;
+	int i;
+
+	length = (length + 7) & ~(size_t)7;
+	if (length > shared->size) return;
+	lock();
+	at = shared->next + length <= shared->size ? shared->next : 0;
+	// Drop the entries this one overwrites, and make room if the table is full
+	for (i = 0; i < shared->count; ) {
+		s = &shared->slot[i];
+		if ((s->at < at + length && at < s->at + s->outLength + sizeof(LineList) * s->indexCount) ||
+				(s->key.hash == key->hash && s->key.check == key->check)) {
+			*s = shared->slot[--shared->count];
+		} else {
+			++i;
+		}
+	}
+	if (shared->count == SHARED_SLOTS) shared->slot[0] = shared->slot[--shared->count];
+	memcpy(shared->ring + at, out->storage, out->length);
+	if (index->top) memcpy(shared->ring + at + out->length, index->storage, sizeof(LineList) * index->top);
+	s = &shared->slot[shared->count++];
+	s->key = *key;
+	s->at = at;
+	s->outLength = out->length;
+	s->indexCount = index->top;
+	s->base = index->base;
+	shared->next = at + length;
+	unlock();
+}
+
+int cache_fetch(char *dir, CacheKey *key, OutBuf *out, LineIndex *index) {
+	char path[4096];
+	unsigned char header[32];
+	unsigned long long length;
+	FILE *fp;
+
+	if (shared && sharedFetch(key, out, index)) return 1;
+	if (dir == NULL) return 0;
+	entryPath(path, sizeof(path), dir, key);
+	if ((fp = fopen(path, "rb")) == NULL) return 0;
+	if (fread(header, 1, 32, fp) != 32 || memcmp(header, CACHE_MAGIC, 4) ||
+		get64(header+8) != key->check || get64(header+16) != (unsigned long long)key->length) {
+		fclose(fp);
+		return 0;
+	}
+	length = get64(header+24);
+	out->length = 0;
+	if (length > out->maxElements) {
+		ob_destroy(out);
+		ob_init(out, length);
+	}
+	if (fread(out->storage, 1, length, fp) != length || !li_load(index, fp)) {
+		fclose(fp);
+		out->length = 0;
+		return 0;
+	}
+	out->length = length;
+	fclose(fp);
+	utime(path, NULL);	// Recently used
+	if (shared) sharedStore(key, out, index);
+	return 1;
+}
+
+typedef struct Entry {
+	char name[256];
+	time_t used;
+	long size;
+} Entry;
+
+static int byAge(const void *a, const void *b) {
+	time_t ta = ((Entry *)a)->used, tb = ((Entry *)b)->used;
+	return (ta > tb) - (ta < tb);
+}
+
+// Remove the least recently used entries until the total is under maxBytes
+static void evict(char *dir, long maxBytes) {
+	DIR *d = opendir(dir);
+	struct dirent *de;
+	struct stat st;
+	Entry *entries = NULL;
+	int count = 0, max = 0, i;
+	size_t len, slen = strlen(CACHE_SUFFIX);
+	long total = 0;
+	char path[4096];
+
+	if (d == NULL) return;
+	while ((de = readdir(d))) {
+		len = strlen(de->d_name);
+		if (len <= slen || len >= sizeof(entries->name) || strcmp(de->d_name + len - slen, CACHE_SUFFIX)) continue;
+		snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+		if (stat(path, &st)) continue;
+		if (count == max) {
+			max = max ? max * 2 : 64;
+			entries = (Entry *)realloc(entries, sizeof(Entry) * max);
+			if (entries == NULL) {
+				fprintf(stderr, "ERROR: evict: Insufficient memory.\n");
+				exit(1);
+			}
+		}
+		strcpy(entries[count].name, de->d_name);
+		entries[count].used = st.st_mtime;
+		entries[count].size = st.st_size;
+		total += st.st_size;
+		++count;
+	}
+	closedir(d);
+	if (total > maxBytes) {
+		qsort(entries, count, sizeof(Entry), byAge);
+		for (i = 0; i < count && total > maxBytes; i++) {
+			snprintf(path, sizeof(path), "%s/%s", dir, entries[i].name);
+			if (!unlink(path)) total -= entries[i].size;
+		}
+	}
+	free(entries);
+}
+
+void cache_store(char *dir, CacheKey *key, OutBuf *out, LineIndex *index, long maxBytes) {
+	char path[4096], temp[4200];
+	unsigned char header[32];
+	FILE *fp;
+	int ok;
+
+	if (shared) sharedStore(key, out, index);
+	if (dir == NULL) return;
+	mkdir(dir, 0777);	// Fine if it exists
+	entryPath(path, sizeof(path), dir, key);
+	snprintf(temp, sizeof(temp), "%s.%d.tmp", path, (int)getpid());
+	if ((fp = fopen(temp, "wb")) == NULL) {
+		fprintf(stderr, "ERROR: cache_store: Can't create cache entry '%s'\n", temp);
+		return;
+	}
+	memset(header, 0, sizeof(header));
+	memcpy(header, CACHE_MAGIC, 4);
+	header[4] = CACHE_VERSION;
+	put64(header+8, key->check);
+	put64(header+16, key->length);
+	put64(header+24, out->length);
+	ok = fwrite(header, 1, 32, fp) == 32 &&
+		 fwrite(out->storage, 1, out->length, fp) == out->length &&
+		 li_save(index, fp);
+	if (fclose(fp) || !ok || rename(temp, path)) {
+		fprintf(stderr, "ERROR: cache_store: Error writing cache entry '%s'\n", path);
+		unlink(temp);
+		return;
+	}
+	evict(dir, maxBytes);
+}
@@ -0,0 +1,42 @@
+/*
+ * cache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include "outbuf.h"
+#include "lineindex.h"
+
+// Identifies one result: the image bytes plus the options that affect output
+typedef struct CacheKey {
+  unsigned long long hash;      // Names the entry
+  unsigned long long check;     // Independent hash, verified on fetch
+  long length;                  // Image length
+} CacheKey;
+
+// Hash the file and the option text into key; returns 0 if the file
+// can't be read
+int cache_key(CacheKey *key, char *fileName, char *options);
+
+// Fetch the stored output and line index for key, from the shared
+// memory cache if there is one, then from dir if it isn't NULL;
+// returns 1 on a hit
+int cache_fetch(char *dir, CacheKey *key, OutBuf *out, LineIndex *index);
+
+// Store output and line index for key in the shared memory cache if
+// there is one, and in dir if it isn't NULL, then evict the least
+// recently used entries in dir until it is no bigger than maxBytes
+void cache_store(char *dir, CacheKey *key, OutBuf *out, LineIndex *index, long maxBytes);
+
+// Set up a cache of maxBytes in shared memory, used by this process and
+// the processes it forks from now on
+void cache_share(long maxBytes);
+
+// Return whether there is a shared memory cache
+int cache_isShared();
+
+#endif /* CACHE_H_ */
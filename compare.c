@@ -0,0 +1,339 @@
+/*
+ * compare.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Line diff of two disassemblies. Every output line is hashed once.
+// Common leading and trailing lines are stripped, then lines that occur
+// exactly once on each side are used as anchors (keeping the longest
+// run that is in order on both sides), and only the gaps between
+// anchors are diffed with Myers' O(ND) algorithm. Since every line of
+// the disassembly is one instruction or data run, the anchors are
+// usually unchanged labels and instructions, and the gaps are small.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "outbuf.h"
+#include "lineindex.h"
+#include "compare.h"
+
+#define MYERS_MAXD 2048	// Past this many edits a gap is reported as replaced
+
+static void* dl_alloc(size_t size) {
+	void *p = malloc(size ? size : 1);
+	if (p == NULL) {
+		fprintf(stderr, "ERROR: compare: Insufficient memory for line diff.\n");
+		exit(1);
+	}
+	return p;
+}
+
+static void dl_split(DiffLines *d, OutBuf *b) {
+	size_t i, start = 0;
+	int n = 0;
+	unsigned h;
+
+	for (i = 0; i < b->length; i++) {
+		if (b->storage[i] == '\n') ++n;
+	}
+	if (b->length && b->storage[b->length-1] != '\n') ++n;
+	d->count = n;
+	d->text = (char **)dl_alloc(sizeof(char *) * n);
+	d->length = (int *)dl_alloc(sizeof(int) * n);
+	d->hash = (unsigned *)dl_alloc(sizeof(unsigned) * n);
+	d->match = (int *)dl_alloc(sizeof(int) * n);
+	n = 0;
+	h = 2166136261u;	// FNV-1a
+	for (i = 0; i < b->length; i++) {
+		h = (h ^ (unsigned char)b->storage[i]) * 16777619u;
+		if (b->storage[i] == '\n' || i == b->length - 1) {
+			d->text[n] = b->storage + start;
+			d->length[n] = i + 1 - start;
+			d->hash[n] = h;
+			d->match[n] = -1;
+			++n;
+			start = i + 1;
+			h = 2166136261u;
+		}
+	}
+}
+
+static void dl_destroy(DiffLines *d) {
+	free(d->text);
+	free(d->length);
+	free(d->hash);
+	free(d->match);
+}
+
+static int sameLine(DiffLines *a, int i, DiffLines *b, int j) {
+	return a->hash[i] == b->hash[j] && a->length[i] == b->length[j] &&
+		!memcmp(a->text[i], b->text[j], a->length[i]);
+}
+
+static void pair(DiffLines *a, int i, DiffLines *b, int j) {
+	a->match[i] = j;
+	b->match[j] = i;
+}
+
+// Myers' greedy O(ND) diff of a[alo..ahi) and b[blo..bhi); the
+// furthest reaching x on each diagonal is kept for every D so the
+// path can be walked back
+static void myers(DiffLines *a, int alo, int ahi, DiffLines *b, int blo, int bhi) {
+	int n = ahi - alo, m = bhi - blo;
+	int max = n + m, d, k, x, y, rows, prevK, prevX, prevY;
+	int **trace, *v;
+
+	if (max > MYERS_MAXD) max = MYERS_MAXD;
+	trace = (int **)dl_alloc(sizeof(int *) * (max + 1));
+	for (d = 0, rows = 0; d <= max; d++) {
+		// v[k + d] for diagonals k = -d..d
+		v = trace[rows++] = (int *)dl_alloc(sizeof(int) * (2 * d + 1));
+		for (k = -d; k <= d; k += 2) {
+			if (d == 0) {
+				x = 0;
+			} else if (k == -d || (k != d && trace[d-1][k-1 + d-1] < trace[d-1][k+1 + d-1])) {
+				x = trace[d-1][k+1 + d-1];		// Down (insertion)
+			} else {
+				x = trace[d-1][k-1 + d-1] + 1;	// Right (deletion)
+			}
+			y = x - k;
+			while (x < n && y < m && sameLine(a, alo + x, b, blo + y)) ++x, ++y;
+			v[k + d] = x;
+			if (x >= n && y >= m) goto found;
+		}
+	}
+	// Too different; leave the whole gap unmatched
+	goto done;
+
+found:
+	// Walk back from (n, m), pairing the diagonal (matching) moves
+	x = n;
+	y = m;
+	for (; d > 0; d--) {
+		k = x - y;
+		if (k == -d || (k != d && trace[d-1][k-1 + d-1] < trace[d-1][k+1 + d-1])) prevK = k + 1;
+		else prevK = k - 1;
+		prevX = trace[d-1][prevK + d-1];
+		prevY = prevX - prevK;
+		while (x > prevX && y > prevY) {
+			--x, --y;
+			pair(a, alo + x, b, blo + y);
+		}
+		x = prevX;
+		y = prevY;
+	}
+	while (x > 0 && y > 0) {
+		--x, --y;
+		pair(a, alo + x, b, blo + y);
+	}
+
+done:
+	while (rows) free(trace[--rows]);
+	free(trace);
+}
+
+typedef struct Anchor {
+	int a;			// Line in a, or -1
+	int b;			// Line in b, or -1
+	int countA;
+	int countB;
+} Anchor;
+
+// Diff a[alo..ahi) against b[blo..bhi)
+static void diffRange(DiffLines *a, int alo, int ahi, DiffLines *b, int blo, int bhi) {
+	int i, j, size, slot, count, lis;
+	Anchor *table;
+	int *pa, *pb, *tails, *back;
+
+	// Common prefix and suffix
+	while (alo < ahi && blo < bhi && sameLine(a, alo, b, blo)) pair(a, alo++, b, blo++);
+	while (alo < ahi && blo < bhi && sameLine(a, ahi-1, b, bhi-1)) pair(a, --ahi, b, --bhi);
+	if (alo == ahi || blo == bhi) return;
+
+	// Count lines in both ranges (open addressing on the hash)
+	for (size = 64; size < 2 * (ahi - alo + bhi - blo); size *= 2);
+	table = (Anchor *)dl_alloc(sizeof(Anchor) * size);
+	for (i = 0; i < size; i++) table[i].a = table[i].b = -1;
+	for (i = alo; i < ahi; i++) {
+		for (slot = a->hash[i] & (size - 1);
+			 table[slot].a >= 0 && !sameLine(a, table[slot].a, a, i);
+			 slot = (slot + 1) & (size - 1));
+		if (table[slot].a < 0) {
+			table[slot].a = i;
+			table[slot].countA = table[slot].countB = 0;
+		}
+		++table[slot].countA;
+	}
+	for (j = blo; j < bhi; j++) {
+		for (slot = b->hash[j] & (size - 1);
+			 table[slot].a >= 0 && !sameLine(a, table[slot].a, b, j);
+			 slot = (slot + 1) & (size - 1));
+		if (table[slot].a >= 0) {
+			++table[slot].countB;
+			table[slot].b = j;
+		}
+	}
+
+	// Unique on both sides, in a order
+	pa = (int *)dl_alloc(sizeof(int) * (ahi - alo));
+	pb = (int *)dl_alloc(sizeof(int) * (ahi - alo));
+	count = 0;
+	for (i = alo; i < ahi; i++) {
+		for (slot = a->hash[i] & (size - 1); !sameLine(a, table[slot].a, a, i); slot = (slot + 1) & (size - 1));
+		if (table[slot].countA == 1 && table[slot].countB == 1) {
+			pa[count] = i;
+			pb[count] = table[slot].b;
+			++count;
+		}
+	}
+	free(table);
+
+	if (count == 0) {
+		myers(a, alo, ahi, b, blo, bhi);
+	} else {
+		// Longest run of anchors increasing in b (patience sorting)
+		tails = (int *)dl_alloc(sizeof(int) * count);
+		back = (int *)dl_alloc(sizeof(int) * count);
+		lis = 0;
+		for (i = 0; i < count; i++) {
+			int lo = 0, hi = lis;
+			while (lo < hi) {
+				int mid = (lo + hi) / 2;
+				if (pb[tails[mid]] < pb[i]) lo = mid + 1;
+				else hi = mid;
+			}
+			back[i] = lo ? tails[lo-1] : -1;
+			tails[lo] = i;
+			if (lo == lis) ++lis;
+		}
+		// Chosen anchors, in order, at the end of tails
+		for (i = tails[lis-1], j = count; i >= 0; i = back[i]) {
+			tails[--j] = i;
+		}
+		// Diff the gaps between anchors
+		int pia = alo, pib = blo;
+		for (j = count - lis; j < count; j++) {
+			i = tails[j];
+			diffRange(a, pia, pa[i], b, pib, pb[i]);
+			pair(a, pa[i], b, pb[i]);
+			pia = pa[i] + 1;
+			pib = pb[i] + 1;
+		}
+		diffRange(a, pia, ahi, b, pib, bhi);
+		free(tails);
+		free(back);
+	}
+	free(pa);
+	free(pb);
+}
+
+static void printLines(FILE *fp, char tag, DiffLines *d, int from, int to) {
+	for (; from < to; from++) {
+		putc(tag, fp);
+		fwrite(d->text[from], 1, d->length[from], fp);
+		if (d->text[from][d->length[from]-1] != '\n') putc('\n', fp);
+	}
+}
+
+// Unified diff line numbering: start is the line before an empty range
+static int hunkStart(int first, int count) {
+	return count ? first + 1 : first;
+}
+
+void cmp_prepare(CompareSide *side) {
+	if (side->lines == NULL) {
+		side->lines = (DiffLines *)dl_alloc(sizeof(DiffLines));
+		dl_split(side->lines, side->text);
+	}
+}
+
+void cmp_release(CompareSide *side) {
+	if (side->lines) {
+		dl_destroy(side->lines);
+		free(side->lines);
+		side->lines = NULL;
+	}
+}
+
+int cmp_diff(CompareSide *sa, CompareSide *sb, Change **result) {
+	DiffLines *a, *b;
+	Change *changes;
+	int i, j, n;
+
+	cmp_prepare(sa);
+	cmp_prepare(sb);
+	a = sa->lines;
+	b = sb->lines;
+	for (i = 0; i < a->count; i++) a->match[i] = -1;
+	for (j = 0; j < b->count; j++) b->match[j] = -1;
+	diffRange(a, 0, a->count, b, 0, b->count);
+
+	// Collect the changed blocks
+	changes = (Change *)dl_alloc(sizeof(Change) * (a->count + b->count + 1));
+	n = 0;
+	i = j = 0;
+	while (i < a->count || j < b->count) {
+		if (i < a->count && j < b->count && a->match[i] == j) {
+			++i, ++j;
+			continue;
+		}
+		changes[n].a0 = i;
+		changes[n].b0 = j;
+		while (i < a->count && a->match[i] < 0) ++i;
+		while (j < b->count && b->match[j] < 0) ++j;
+		changes[n].a1 = i;
+		changes[n].b1 = j;
+		++n;
+	}
+	*result = changes;
+	return n;
+}
+
+int cmp_write(FILE *fp, CompareSide *sa, CompareSide *sb, Change *changes, int n, int context) {
+	DiffLines *a = sa->lines, *b = sb->lines;
+	int i, k, l, hunks = 0;
+	int ha, hb, ta, tb;
+	char rangeA[32], rangeB[32];
+
+	// Group changes no more than two contexts apart into hunks
+	for (k = 0; k < n; k = l + 1) {
+		for (l = k; l + 1 < n && changes[l+1].a0 - changes[l].a1 <= 2 * context; l++);
+		ha = changes[k].a0 - context;
+		if (ha < 0) ha = 0;
+		hb = changes[k].b0 - (changes[k].a0 - ha);
+		ta = changes[l].a1 + context;
+		if (ta > a->count) ta = a->count;
+		tb = changes[l].b1 + (ta - changes[l].a1);
+
+		if (hunks == 0) fprintf(fp, "--- %s\n+++ %s\n", sa->name, sb->name);
+		fprintf(fp, "@@ -%d,%d +%d,%d @@ %s %s\n", hunkStart(ha, ta - ha), ta - ha, hunkStart(hb, tb - hb), tb - hb,
+			li_describe(rangeA, sa->index, hunkStart(changes[k].a0, changes[l].a1 - changes[k].a0), changes[l].a1 - changes[k].a0),
+			li_describe(rangeB, sb->index, hunkStart(changes[k].b0, changes[l].b1 - changes[k].b0), changes[l].b1 - changes[k].b0));
+		++hunks;
+
+		// Body: context, then - and + for each change
+		i = ha;
+		for (; k <= l; k++) {
+			printLines(fp, ' ', a, i, changes[k].a0);
+			printLines(fp, '-', a, changes[k].a0, changes[k].a1);
+			printLines(fp, '+', b, changes[k].b0, changes[k].b1);
+			i = changes[k].a1;
+		}
+		printLines(fp, ' ', a, i, ta);
+	}
+	return hunks;
+}
+
+int cmp_print(CompareSide *sa, CompareSide *sb, int context) {
+	Change *changes;
+	int n, hunks;
+
+	n = cmp_diff(sa, sb, &changes);
+	hunks = cmp_write(stdout, sa, sb, changes, n, context);
+	free(changes);
+	return hunks;
+}
@@ -0,0 +1,57 @@
+/*
+ * compare.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef COMPARE_H_
+#define COMPARE_H_
+
+#include <stdio.h>
+
+#include "outbuf.h"
+#include "lineindex.h"
+
+// Output lines of a disassembly, hashed for comparison
+typedef struct DiffLines {
+  int count;
+  char **text;          // Start of each line (not terminated)
+  int *length;          // Length of each line including newline
+  unsigned *hash;
+  int *match;           // Matching line on the other side, or -1
+} DiffLines;
+
+// One disassembly to be compared: its output text and line index
+typedef struct CompareSide {
+  char *name;
+  OutBuf *text;
+  LineIndex *index;
+  DiffLines *lines;     // Built by cmp_prepare (NULL until then)
+} CompareSide;
+
+// A block of changed lines (half open ranges)
+typedef struct Change {
+  int a0, a1;           // Lines in the first disassembly
+  int b0, b1;           // Lines in the second disassembly
+} Change;
+
+// Split and hash the lines of a side, if not already done; a side can
+// then be compared against any number of others
+void cmp_prepare(CompareSide *side);
+
+// Release the hashed lines of a side
+void cmp_release(CompareSide *side);
+
+// Diff two sides; sets *changes to a malloc'd array of changed blocks
+// in order and returns how many there are
+int cmp_diff(CompareSide *a, CompareSide *b, Change **changes);
+
+// Write changes as unified diff hunks with context lines, each labelled
+// with the address ranges involved. Returns the number of hunks.
+int cmp_write(FILE *fp, CompareSide *a, CompareSide *b, Change *changes, int n, int context);
+
+// Diff two sides and write the hunks to stdout
+int cmp_print(CompareSide *a, CompareSide *b, int context);
+
+#endif /* COMPARE_H_ */
@@ -0,0 +1,180 @@
+/*
+ * ddmap.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "ddmap.h"
+
+static void put32(unsigned char *p, unsigned value) {
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+unsigned dm_get(unsigned char *section, int i) {
+	unsigned char *p = section + 4 * i;
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+}
+
+unsigned long long dm_hash(unsigned char *data, size_t length) {
+	unsigned long long h = 14695981039346656037ULL;
+	size_t i;
+	for (i = 0; i < length; i++) {
+		h = (h ^ data[i]) * 1099511628211ULL;
+	}
+	return h;
+}
+
+static void put64(unsigned char *p, unsigned long long value) {
+	int i;
+	for (i = 0; i < 8; i++) p[i] = (value >> (8 * i)) & 0xFF;
+}
+
+static unsigned long long get64(unsigned char *p) {
+	unsigned long long value = 0;
+	int i;
+	for (i = 7; i >= 0; i--) value = (value << 8) | p[i];
+	return value;
+}
+
+static unsigned align8(unsigned offset) {
+	return (offset + 7) & ~7;
+}
+
+static void writeStack(FILE *fp, IntStack *s, unsigned at) {
+	unsigned char word[4];
+	int i;
+	fseek(fp, at, SEEK_SET);
+	for (i = 0; i < s->top; i++) {
+		put32(word, s->storage[i]);
+		fwrite(word, 1, 4, fp);
+	}
+}
+
+void dm_save(char *fileName, MemoryMap *map, MemoryFile *mod, IntStack *entries,
+		IntStack *tables, IntStack *segments, unsigned flags, unsigned long long optionsHash) {
+	unsigned char header[DM_HEADER];
+	unsigned entryAt, tableAt, segmentAt, mapAt, imageAt;
+	FILE *fp;
+
+	entryAt = DM_HEADER;
+	tableAt = align8(entryAt + 4 * entries->top);
+	segmentAt = align8(tableAt + 4 * tables->top);
+	mapAt = align8(segmentAt + 4 * segments->top);
+	imageAt = align8(mapAt + map->maxElements);
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, "DDMAP", 6);
+	header[6] = DM_VERSION & 0xFF;
+	header[7] = DM_VERSION >> 8;
+	put32(header+8, DM_HEADER);
+	put32(header+12, flags);
+	put32(header+16, map->maxElements);
+	put32(header+20, map->abs_base);
+	put64(header+24, dm_hash(mod->storage, mod->length));
+	put32(header+32, entries->top);
+	put32(header+36, entryAt);
+	put32(header+40, tables->top / 3);
+	put32(header+44, tableAt);
+	put32(header+48, segments->top / 3);
+	put32(header+52, segmentAt);
+	put32(header+56, mapAt);
+	put32(header+60, imageAt);
+	put64(header+64, optionsHash);
+	put32(header+72, map->conflicts);
+
+	if ((fp = fopen(fileName, "wb")) == NULL) {
+		fprintf(stderr, "ERROR: dm_save: Can't create map file '%s'\n", fileName);
+		exit(1);
+	}
+	fwrite(header, 1, DM_HEADER, fp);
+	writeStack(fp, entries, entryAt);
+	writeStack(fp, tables, tableAt);
+	writeStack(fp, segments, segmentAt);
+	fseek(fp, mapAt, SEEK_SET);
+	fwrite(map->storage, 1, map->maxElements, fp);
+	fseek(fp, imageAt, SEEK_SET);
+	fwrite(mod->storage, 1, mod->length, fp);
+	if (ferror(fp) | fclose(fp)) {
+		fprintf(stderr, "ERROR: dm_save: Error writing map file '%s'\n", fileName);
+		exit(1);
+	}
+}
+
+// Return a pointer to count u32s at offset, or NULL if out of the file
+static unsigned char* section(DdMap *dm, unsigned offset, unsigned count, unsigned size) {
+	if (offset > dm->size || (unsigned long long)count * size > dm->size - offset) return NULL;
+	return dm->mapping + offset;
+}
+
+void dm_open(DdMap *dm, char *fileName) {
+	struct stat st;
+	unsigned char *h;
+	int fd;
+
+	if ((fd = open(fileName, O_RDONLY)) < 0 || fstat(fd, &st)) {
+		fprintf(stderr, "ERROR: dm_open: Can't open map file '%s'\n", fileName);
+		exit(1);
+	}
+	dm->size = st.st_size;
+	if (dm->size < DM_HEADER) {
+		fprintf(stderr, "ERROR: dm_open: '%s' is not a diffdasm map file\n", fileName);
+		exit(1);
+	}
+	// Private so that labels added while formatting don't reach the file
+	dm->mapping = (unsigned char *)mmap(NULL, dm->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (dm->mapping == MAP_FAILED) {
+		fprintf(stderr, "ERROR: dm_open: Can't map '%s'\n", fileName);
+		exit(1);
+	}
+	h = dm->mapping;
+	if (memcmp(h, "DDMAP", 6) || (h[6] | (h[7] << 8)) != DM_VERSION || dm_get(h, 2) != DM_HEADER) {
+		fprintf(stderr, "ERROR: dm_open: '%s' is not a version %d diffdasm map file\n", fileName, DM_VERSION);
+		exit(1);
+	}
+	dm->flags = dm_get(h, 3);
+	dm->length = dm_get(h, 4);
+	dm->base = dm_get(h, 5);
+	dm->imageHash = get64(h+24);
+	dm->optionsHash = get64(h+64);
+	dm->conflicts = dm_get(h, 18);
+	dm->entryCount = dm_get(h, 8);
+	dm->tableCount = dm_get(h, 10);
+	dm->segmentCount = dm_get(h, 12);
+	dm->entries = section(dm, dm_get(h, 9), dm->entryCount, 4);
+	dm->tables = section(dm, dm_get(h, 11), dm->tableCount, 12);
+	dm->segments = section(dm, dm_get(h, 13), dm->segmentCount, 12);
+	dm->types = section(dm, dm_get(h, 14), dm->length, 1);
+	dm->image = section(dm, dm_get(h, 15), dm->length, 1);
+	if (!dm->entries || !dm->tables || !dm->segments || !dm->types || !dm->image) {
+		fprintf(stderr, "ERROR: dm_open: Map file '%s' is truncated\n", fileName);
+		exit(1);
+	}
+}
+
+void dm_attach(DdMap *dm, MemoryMap *map) {
+	map->storage = dm->types;
+	map->maxElements = dm->length;
+	map->end = dm->types + dm->length - 1;
+	map->abs_base = dm->base;
+}
+
+void dm_close(DdMap *dm) {
+	if (dm->mapping) munmap(dm->mapping, dm->size);
+	dm->mapping = NULL;
+}
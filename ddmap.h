@@ -0,0 +1,79 @@
+/*
+ * ddmap.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef DDMAP_H_
+#define DDMAP_H_
+
+#include <stddef.h>
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+
+// A .ddmap file holds the result of tracing a module, so it can be
+// memory-mapped back in instead of tracing again. All values are
+// little-endian; every section starts on an 8 byte boundary.
+//
+//  0  "DDMAP\0" and u16 version
+//  8  u32 header size (80)
+// 12  u32 flags (DM_OS9)
+// 16  u32 map length (bytes; equal to the image length)
+// 20  u32 base address
+// 24  u64 FNV-1a hash of the image bytes
+// 32  u32 entry point count, u32 file offset of entry points (u32 each)
+// 40  u32 jump table count, u32 file offset of jump tables
+//         (u32 start, end, MAPTYPE_* each)
+// 48  u32 segment count, u32 file offset of segments
+//         (u32 offset, length, OS9 type/language byte or DM_RAW each)
+// 56  u32 file offset of the map: one byte per image byte, the MM_* type
+//         with MM_LABEL set on labels
+// 60  u32 file offset of a copy of the image bytes
+// 64  u64 FNV-1a hash of the options that affect tracing
+// 72  u32 conflicts the trace met (bytes _mm_set kept over another type),
+//         u32 zero
+
+#define DM_VERSION 3
+#define DM_HEADER 80
+#define DM_OS9 0x01		// Flag: image holds OS9 modules
+#define DM_RAW 0xFFFF	// Segment type: not an OS9 module
+
+typedef struct DdMap {
+  unsigned char *mapping;	// Whole file, mapped copy-on-write
+  size_t size;
+  unsigned flags;
+  unsigned length;
+  unsigned base;
+  unsigned long long imageHash;
+  unsigned long long optionsHash;
+  unsigned conflicts;
+  unsigned entryCount, tableCount, segmentCount;
+  unsigned char *entries, *tables, *segments;	// Little-endian u32 arrays
+  unsigned char *types;	// The map bytes
+  unsigned char *image;	// The image bytes
+} DdMap;
+
+// Hash bytes the way the header does
+unsigned long long dm_hash(unsigned char *data, size_t length);
+
+// Write a traced map with its image, entry points, jump tables (start,
+// end, type triples) and segments (offset, length, type triples)
+void dm_save(char *fileName, MemoryMap *map, MemoryFile *mod, IntStack *entries,
+		IntStack *tables, IntStack *segments, unsigned flags, unsigned long long optionsHash);
+
+// Map a .ddmap file; exits with an error if it isn't valid
+void dm_open(DdMap *dm, char *fileName);
+
+// Point a memory map at the mapped types (changes stay private)
+void dm_attach(DdMap *dm, MemoryMap *map);
+
+// Read u32 number i of a section
+unsigned dm_get(unsigned char *section, int i);
+
+// Unmap
+void dm_close(DdMap *dm);
+
+#endif /* DDMAP_H_ */
@@ -17,22 +17,57 @@
 #include "intstack.h"
 #include "memorymap.h"
 #include "memoryfile.h"
-#include "linelist.h"
 #include "os9stuff.h"
 #include "stats6809.h"
 #include "statsCoCo3.h"
 #include "jumptable.h"
 #include "srecord.h"
+#include "taskpool.h"
+#include "emitter.h"
+#include "hunks.h"
+#include "outbuf.h"
+#include "compare.h"
+#include "variants.h"
+#include "cache.h"
+#include "ddmap.h"
+#include "retrace.h"
+#include "serve.h"
+#include "hints.h"
+#include "shard.h"
+#include "runstats.h"
+#include "timeline.h"
+#include "provenance.h"
+#include "ngram.h"
+#include "skipzone.h"
+#include "stringtab.h"
+#include "partrace.h"
 
 #include "diffdasm.h"
 
 #define STACKLIMIT 65536
 #define STRMAX 4096
-#define LINEMAX 65536
 #define CODE_THRESHOLD 3
 #define STRING_THRESHOLD 4
+#define TIMELINE_EVENTS 262144
 
 char* inFileName = NULL;
+char* indexFileName = NULL;	// Binary line index sidecar (--index)
+char* compareFileName = NULL;	// Baseline module to compare against (--compare)
+char* reportDir = NULL;	// Where to write per-variant reports (--report)
+OutBuf output;	// Disassembly output, written to stdout at the end
+char* saveMapName = NULL;	// Where to save the traced map (--save-map)
+char* loadMapName = NULL;	// Traced map to use instead of tracing (--load-map)
+char* sinceMapName = NULL;	// Map of an earlier image to trace on from (--since)
+char* cacheDir = NULL;	// Result cache directory (--cache)
+long cacheMax = 64;	// Result cache size limit in MB (--cache-max)
+char* serveSocketName = NULL;	// Unix socket to serve requests on (--serve)
+char* manifestName = NULL;	// Module list to disassemble a shard of (--manifest)
+char* outDir = NULL;	// Where to write shard outputs and index (--out)
+int shardIndex = 0, shardCount = 1;	// Which shard of the manifest (--shard)
+char* timelineName = NULL;	// Where to write a trace-event timeline (--timeline)
+char* provenanceName = NULL;	// Where to write the classification log (--provenance)
+char** moduleNames = NULL;	// All modules named on the command line
+int moduleCount = 0;
 
 unsigned baseAddr = 0;	// Runtime address of start of module
 MemoryFile input;
@@ -42,20 +77,27 @@ int checksum = 0;   // For deep debugging
 
 IntStack addrStack;	// Stack of known-good execution addresses
 IntStack labelStack;	// Stack of labels (e.g. ,pcr references) that could be execution addresses
-IntStack notCodeStack;  // Stack of addresses that might seem like good execution addresses but aren't
-
-LineList lines[LINEMAX]; // Used to map line numbers to byte ranges
-int lineCount = 0;
-
-char operands[32];	// Disassembly operand buffer
-char comment[STRMAX];	// Disassembly comment buffer
+IntStack notCodeStack;  // Ranges of offsets (start, end pairs) that might seem like good execution addresses but aren't
+unsigned char notCodeMap[65536];	// Non-zero for each offset in notCodeStack
+IntStack execStack;	// Execution offsets given with --exec
+IntStack entryStack;	// Execution offsets tracing started from
+IntStack tableStack;	// Jump tables found (start, end, type)
+IntStack segmentStack;	// Modules found (offset, length, type)
 
 int f9info = 0; // Non-zero to output only code / data map info for f9dasm
 int ioflag = 0; // Non-zero to call out potential references to (Color Computer) I/O
 int specflag = 0; // Non-zero to enable execution address speculation
+int specRollback = -1; // Undo speculative traces with more conflicts or invalid opcodes (--spec-rollback)
+double specMin = 0; // Least score of a code candidate, in bits per instruction, with a model (--spec-min)
+char* saveModelName = NULL;	// Where to save the opcode model trained on the image (--save-model)
+int prefilter = 0; // Non-zero to keep speculation out of clearly non-code regions (--prefilter)
+int fcc = 0; // Non-zero to speculate about zero, CR and length delimited strings (--fcc)
+int dataRefs = 0; // Non-zero to type the data traced code reads and writes (--data-refs)
+int jumpTables = 0; // Non-zero to find jump tables from the code that dispatches through them (--jump-tables)
 
 int source = 0; // Non-zero to disassemble in source format
 int _debug = 0; // Non-zero to print debug information
+int statsflag = 0; // Non-zero to report phase times and counters (2 for JSON)
 
 int swipb = 1;  // Number of data bytes to skip after an SWI
 int swi2pb = 1; // Number of data bytes to skip after an SWI2
@@ -63,20 +105,62 @@ int swi3pb = 1; // Number of data bytes to skip after an SWI3
 
 int is_os9 = 0; // Set non-zero if we detect OS9 modules
 
+int jobs = 0;   // Number of threads to use for output (zero for one per CPU)
+
 void usage() {
 	fflush(stderr);
 	printf("Usage:\ndiffdasm <options> <module>\nDisassemble 6809 OS9 module or ROM image to a diffable format.\nInput must be a binary module or in .s19 / .mhx format.\n\n");
+	printf("diffdasm --compare <baseline> <options> <module>\nDisassemble both modules and print the differences between them.\n\n");
+	printf("diffdasm --compare <baseline> [--report dir] <options> <module> <module>...\nCompare each module against the baseline, writing a report per module and a summary of differing routines.\n\n");
+	printf("diffdasm hunks <old index> <new index> [<diff>]\nMap the hunks of a unified diff of two disassemblies to address ranges.\n\n");
+	printf("diffdasm --serve <socket> [--jobs n] [--cache-max n] <options>\nStay resident, running requests from clients on a Unix socket in n worker processes,\nwith a shared in-memory cache. Other options are defaults for every request.\n\n");
+	printf("diffdasm client <socket> <options> <module>\nRun in a server started with --serve. A module of - (or -.s19, -.mhx) is read from stdin.\n\n");
+	printf("diffdasm --manifest <file> [--shard i/n] [--out dir] [--jobs n] <options>\nDisassemble shard i (from 0) of n of the modules listed in a manifest, n modules at a time,\nwriting each output and a shard index to dir.\n\n");
+	printf("diffdasm merge <shard index>...\nCombine the indexes of every shard of a manifest into one corpus report.\n\n");
+	printf("diffdasm explain <provenance file> <address>...\nExplain why each address was classified as it was, from a log written with --provenance.\n\n");
     printf("Options:\n");
 
 	printf("--base xxxx            Specifies a hex base address (defaults to zero)\n");
     printf("--exec xxxx            Specifies a hex execution address. Can use multiple times.\n");
     printf("--notcode xxxx[-yyyy]  Specifies an address or range that must not be disassembled as code.\n");
+	printf("--hints file           Read exec addresses, notcode ranges, data types, jump tables and label names\n");
+	printf("                       from a hint file or f9dasm info file. Can use multiple times.\n");
 	printf("--spec                 Speculate about additional execution addresses by parsing for instructions.\n");
+	printf("--fcc                  Also take zero terminated, CR terminated and length prefixed text\n");
+	printf("                       for strings (FCC), as well as text ending in a character with bit 7 set.\n");
+	printf("--jump-tables          Find jump tables that traced code dispatches through (LDD B,X / JMP D,X,\n");
+	printf("                       JMP [B,X] and the like), sized by a compare or mask of the index.\n");
+	printf("--data-refs            Before speculating, type data that traced code reads or writes at extended\n");
+	printf("                       or PC relative addresses as FCB or FDB by its width, and tables of\n");
+	printf("                       addresses walked with ,X++ after loading X with their address as FDB.\n");
+	printf("--prefilter            Don't speculate in regions that look compressed, random or like fill or\n");
+	printf("                       bitmaps (by byte entropy and the share of $00 and $FF bytes).\n");
+	printf("--spec-model file      Take code candidates likeliest first, and skip unlikely ones, scoring them\n");
+	printf("                       with an opcode model trained on the image's code and the model in file.\n");
+	printf("--spec-min x           As --spec-model, with or without a file; candidates need a score of x bits\n");
+	printf("                       per instruction (defaults to zero).\n");
+	printf("--save-model file      Save the opcode model (with any --spec-model counts) for --spec-model.\n");
+	printf("--spec-rollback n      Undo a speculative trace that meets more than n conflicting data types\n");
+	printf("                       or invalid opcodes, and don't speculate there again.\n");
 
 	printf("--source               Output in assembler source format rather than diff format.\n");
 	printf("--f9info               Output in f9dasm info file format rather than diff format.\n");
     printf("--ioflag               Call out potential references to (Color Computer) I/O.\n");
 	printf("--swipb 1,1,1          Set the number of data bytes to skip after SWI, SWI2, SWI3.\n");
+	printf("--save-map file        Save the traced map to file (.ddmap).\n");
+	printf("--load-map file        Use a map saved with --save-map for this module instead of tracing it.\n");
+	printf("--since file           Trace only what changed since the image a map was saved with --save-map for.\n");
+	printf("                       With --spec, --data-refs or --jump-tables, or if that trace met\n");
+	printf("                       conflicting data types, it traces everything.\n");
+	printf("--cache dir            Reuse output for unchanged modules and options from a cache in dir.\n");
+	printf("--cache-max n          Limit the cache to n MB, removing the least recently used entries (default 64).\n");
+	printf("--index file           Write a binary line / address index for the output to file.\n");
+	printf("--jobs n               Use n threads to trace and generate output (defaults to one per CPU).\n");
+	printf("--stats                Report phase times, tracer counters and peak memory to stderr.\n");
+	printf("--stats-json           As --stats, as a JSON object.\n");
+	printf("--timeline file        Write a timeline of phases, traced runs and speculation to file,\n");
+	printf("                       in Chrome trace-event format (for Perfetto).\n");
+	printf("--provenance file      Log why each byte was classified, for diffdasm explain.\n");
 	printf("--debug                Output debugging information.\n");
 
     exit(1);
@@ -93,12 +177,17 @@ void init() {
 	intstack_init(&addrStack, STACKLIMIT);
     intstack_init(&labelStack, STACKLIMIT);
 	intstack_init(&notCodeStack, STACKLIMIT);
-	comment[0] = '\0';
+	intstack_init(&execStack, STACKLIMIT);
+	intstack_init(&entryStack, STACKLIMIT);
+	intstack_init(&tableStack, STACKLIMIT);
+	intstack_init(&segmentStack, STACKLIMIT);
+	ob_init(&output, 65536);
 }
 
 void processArgs(int argc, char **argv) {
     unsigned address, a2;
-    int matches;
+    int matches, hintCount = 0;
+    char **hintNames;	// --hints files, read once --base is known
 
     IntStack tempExec;	    // Stack of potential known-good execution addresses (need to be offset by base)
     IntStack tempNotCode;	// Stack of potential known-bad execution addresses (need to be offset by base)
@@ -109,6 +198,8 @@ void processArgs(int argc, char **argv) {
 		fprintf(stderr, "ERROR: input module required\n");
 	    usage();
 	}
+	moduleNames = (char **)malloc(sizeof(char *) * argc);
+	hintNames = (char **)malloc(sizeof(char *) * argc);
 	while (++argv,--argc) {
         if (!strcmp(*argv,"--exec")) {
             // Push the specified entry address onto the TEMP stack
@@ -128,8 +219,20 @@ void processArgs(int argc, char **argv) {
 			++argv, --argc;
 			matches = sscanf(*argv, "%x-%x", &address, &a2);
             if (matches == 1) a2 = address;
-            for (int i = address; i <= a2; i++)
-			    intstack_push(&tempNotCode, i);
+            if (matches < 1 || a2 < address) {
+				fprintf(stderr, "ERROR: --notcode range '%s' is not xxxx[-yyyy] with yyyy >= xxxx\n", *argv);
+				usage();
+            }
+            intstack_push(&tempNotCode, address);
+            intstack_push(&tempNotCode, a2);
+		} else if (!strcmp(*argv,"--hints")) {
+			// Read exec addresses, notcode ranges and data types from a file
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --hints requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			hintNames[hintCount++] = *argv;
 		} else if (!strcmp(*argv,"--base")) {
 			// Save the specified base address
 			if ( argc < 2) {
@@ -141,6 +244,51 @@ void processArgs(int argc, char **argv) {
         } else if (!strcmp(*argv,"--spec")) {
             // Flag that we want speculative disassembly
             specflag = 1;
+		} else if (!strcmp(*argv,"--fcc")) {
+			// Look for more kinds of string
+			fcc = 1;
+		} else if (!strcmp(*argv,"--jump-tables")) {
+			// Recognize dispatch through jump tables
+			jumpTables = 1;
+		} else if (!strcmp(*argv,"--data-refs")) {
+			// Type data by how traced code accesses it
+			dataRefs = 1;
+		} else if (!strcmp(*argv,"--prefilter")) {
+			// Keep speculation out of high entropy and fill regions
+			prefilter = 1;
+		} else if (!strcmp(*argv,"--spec-model")) {
+			// Score code candidates with an opcode model read from a file
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --spec-model requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			ng_load(*argv);
+		} else if (!strcmp(*argv,"--spec-min")) {
+			// Score code candidates with an opcode model, needing this much
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --spec-min requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			sscanf(*argv, "%lf", &specMin);
+			ng_init();
+		} else if (!strcmp(*argv,"--save-model")) {
+			// Save the opcode model trained on the image
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --save-model requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			saveModelName = *argv;
+		} else if (!strcmp(*argv,"--spec-rollback")) {
+			// Undo speculative traces that go wrong
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --spec-rollback requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			sscanf(*argv, "%d", &specRollback);
 		} else if (!strcmp(*argv,"--source")) {
 			// Flag that we want source output
 			source = 1;
@@ -159,27 +307,175 @@ void processArgs(int argc, char **argv) {
             }
             ++argv, --argc;
             sscanf(*argv, "%d,%d,%d", &swipb, &swi2pb, &swi3pb);
+		} else if (!strcmp(*argv,"--compare")) {
+			// Save the baseline module to compare against
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --compare requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			compareFileName = *argv;
+		} else if (!strcmp(*argv,"--save-map")) {
+			// Save the traced map
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --save-map requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			saveMapName = *argv;
+		} else if (!strcmp(*argv,"--load-map")) {
+			// Use a saved map instead of tracing
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --load-map requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			loadMapName = *argv;
+		} else if (!strcmp(*argv,"--since")) {
+			if (argc < 2) {
+				fprintf(stderr, "ERROR: processArgs: Missing map file for --since\n");
+				usage();
+			}
+			++argv, --argc;
+			sinceMapName = *argv;
+		} else if (!strcmp(*argv,"--cache")) {
+			// Cache results in a directory
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --cache requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			cacheDir = *argv;
+		} else if (!strcmp(*argv,"--cache-max")) {
+			// Size limit for the cache
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --cache-max requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			sscanf(*argv, "%ld", &cacheMax);
+		} else if (!strcmp(*argv,"--serve")) {
+			// Stay resident serving requests
+			if (argc < 2) {
+				fprintf(stderr, "ERROR: processArgs: Missing socket for --serve\n");
+				usage();
+			}
+			++argv, --argc;
+			serveSocketName = *argv;
+		} else if (!strcmp(*argv,"--manifest")) {
+			// Disassemble the modules listed in a file
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --manifest requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			manifestName = *argv;
+		} else if (!strcmp(*argv,"--shard")) {
+			// Which shard of the manifest to disassemble
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --shard requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			if (sscanf(*argv, "%d/%d", &shardIndex, &shardCount) != 2 ||
+					shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount) {
+				fprintf(stderr, "ERROR: --shard requires i/n with 0 <= i < n\n");
+				usage();
+			}
+		} else if (!strcmp(*argv,"--out")) {
+			// Directory for shard outputs
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --out requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			outDir = *argv;
+		} else if (!strcmp(*argv,"--report")) {
+			// Directory for per-variant comparison reports
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --report requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			reportDir = *argv;
+		} else if (!strcmp(*argv,"--index")) {
+			// Write a line index sidecar
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --index requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			indexFileName = *argv;
+		} else if (!strcmp(*argv,"--jobs")) {
+			// Number of output threads
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --jobs requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			sscanf(*argv, "%d", &jobs);
+		} else if (!strcmp(*argv,"--stats")) {
+			// Flag that we want phase times and counters
+			statsflag = 1;
+		} else if (!strcmp(*argv,"--stats-json")) {
+			// Flag that we want them machine readable
+			statsflag = 2;
+		} else if (!strcmp(*argv,"--timeline")) {
+			// Record a timeline of the run
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --timeline requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			timelineName = *argv;
+		} else if (!strcmp(*argv,"--provenance")) {
+			// Record why each byte was classified
+			if ( argc < 2) {
+				fprintf(stderr, "ERROR: --provenance requires argument\n");
+				usage();
+			}
+			++argv, --argc;
+			provenanceName = *argv;
 		} else if (!strcmp(*argv,"--debug")) {
 			// Flag that we want debug output
 			_debug = 1;
 		} else {
 			// Treat as path to module
 			inFileName = *argv;
+			moduleNames[moduleCount++] = *argv;
 		}
 	}
 
+    // Read hint files now --base is known, for those that give offsets
+    for (int i=0; i < hintCount; i++)
+        hints_read(hintNames[i], &tempExec, &tempNotCode, baseAddr);
+    free(hintNames);
+
     // Postprocess the address stacks relative to --BASE if provided
 
     for (int i=0; i < tempExec.top; i++)
-        intstack_push(&addrStack, (tempExec.storage[i] - baseAddr) & 0xFFFF);
+        intstack_push(&execStack, (tempExec.storage[i] - baseAddr) & 0xFFFF);
     for (int i=0; i < tempNotCode.top; i++)
         intstack_push(&notCodeStack, (tempNotCode.storage[i] - baseAddr) & 0xFFFF);
+    memset(notCodeMap, 0, sizeof(notCodeMap));
+    for (int i=0; i+1 < notCodeStack.top; i += 2) {
+        for (unsigned offset = notCodeStack.storage[i]; ; offset = (offset + 1) & 0xFFFF) {
+            notCodeMap[offset] = 1;
+            if (offset == notCodeStack.storage[i+1]) break;
+        }
+    }
     intstack_destroy(&tempExec);
     intstack_destroy(&tempNotCode);
     if (_debug) {
-        intstack_dump(&addrStack, "Known execution offsets");
-        intstack_dump(&notCodeStack, "Known non-code offsets");
+        intstack_dump(&execStack, "Known execution offsets");
+        intstack_dump(&notCodeStack, "Known non-code offset ranges");
     }
+	if (jobs < 1) jobs = tp_defaultJobs();
+	if (statsflag) {
+		intstack_track(&addrStack);
+		intstack_track(&labelStack);
+	}
+	if (timelineName) tl_init(TIMELINE_EVENTS);
 }
 
 int loadBinaryFile(char* fName) {
@@ -244,6 +540,7 @@ void loadFile(char *fName) {
 	if (exec != 0x0000) {
 		if (_debug) printf("loadFile(%s): Known address: %04X\n", fName, exec);
 		intstack_push(&addrStack, (exec - input.abs_base) & 0xFFFF);
+		if (pv_enabled) pv_push((exec - input.abs_base) & 0xFFFF, PV_LOADEXEC, -1);
 	}
 }
 
@@ -256,7 +553,9 @@ unsigned short getAddrInd(MemoryFile *mod, unsigned offset, unsigned jtOffset) {
 
 // Push an indirect address (load from offset, then adjust by jtOffset)
 void pushAddrInd(MemoryFile *mod, unsigned base, unsigned offset, unsigned jtOffset) {
-	intstack_push(&addrStack, base + getAddrInd(mod, base + offset, jtOffset));
+	unsigned entryPoint = base + getAddrInd(mod, base + offset, jtOffset);
+	intstack_push(&addrStack, entryPoint);
+	if (pv_enabled) pv_push(entryPoint, PV_MODULE, base);
 }
 
 char strTmp[STRMAX];
@@ -294,6 +593,10 @@ void inferEntry(MemoryFile *mod) {
 			char* moduleName = stringAt(mod, offset+nameStart);
 			if (_debug) printf("Found module: '%s' ($%04X bytes)\n", moduleName, modSize);
             is_os9 = 1; // Flag this as an OS9 disassembly
+			if (pv_enabled) pv_cause(PV_MODULE, offset);
+			intstack_push(&segmentStack, offset);
+			intstack_push(&segmentStack, modSize);
+			intstack_push(&segmentStack, mod->storage[offset+6]);
 			mm_setFDB(&map, offset+0, 6); // Sync, size, name
 			mm_set(&map, offset+6, MM_FCB, 3); // TYLA, ATRV, parity
 			mm_setString(&map, offset+nameStart, strlen(moduleName));
@@ -314,7 +617,7 @@ void inferEntry(MemoryFile *mod) {
 						pushAddrInd(mod, offset, 9, 0); // Single entry address
                         // Jump table: Single entry address
                         addr = mf_get_word(mod, offset+9);
-                        jt_lbra(mod, addr, addr+3-1);
+                        jt_lbra(mod, offset+addr, offset+addr+3-1);
 						break;
 					case MT_FLMGR: // File Manager
 						//printf("Processing File Manager: '%s'\n", moduleName);
@@ -323,7 +626,7 @@ void inferEntry(MemoryFile *mod) {
                         // Create, Open, MakDir, ChgDir, Delete, Seek, Read, Write
                         // ReadLn, WriteLn, GetStt, SetStt, Close
                         addr = mf_get_word(mod, offset+9);
-                        jt_lbra(mod, addr, addr+3*13-1);
+                        jt_lbra(mod, offset+addr, offset+addr+3*13-1);
 						break;
 					case MT_DRIVR: // Device Driver
 						//printf("Processing Device Driver: '%s'\n", moduleName);
@@ -331,7 +634,7 @@ void inferEntry(MemoryFile *mod) {
                         // Jump table:
                         // Init, Read, Write, GetStt, SetStt, Term
                         addr = mf_get_word(mod, offset+9);
-                        jt_lbra(mod, addr, addr+3*6-1);
+                        jt_lbra(mod, offset+addr, offset+addr+3*6-1);
 						break;
 					default:
 						// There's no execution entry point for these types
@@ -353,12 +656,14 @@ void inferEntry(MemoryFile *mod) {
 	int baseAddress = mod->abs_base;
 	int endAddress = baseAddress + mod->length - 1;
 	if (_debug) printf("inferEntry: loaded address range is $%04X - $%04X.\n", baseAddress, endAddress);
+    if (pv_enabled) pv_cause(PV_VECTORS, -1);
     if (endAddress >= 0xFFF0)
         jt_extended(mod, 0xFFF0 - mod->abs_base, endAddress - mod->abs_base);
 
 	// If no other entry point, start at offset zero
 	if (intstack_isEmpty(&addrStack)) {
 		intstack_push(&addrStack,0x0000);
+		if (pv_enabled) pv_push(0x0000, PV_DEFAULT, -1);
 	}
 }
 
@@ -366,14 +671,18 @@ void dumpStack() {
     intstack_dump(&addrStack, "Address Stack");
 }
 
-void dumpLines() {
-	int at;
-	printf("\nLine Cross Reference:\n");
-	printf("Line   Addr  Bytes\n");
-	printf("------ ----- -----\n");
-	for (at=1; at<=lineCount; at++) {
-		printf("%5d: $%04X (%d)\n", lines[at].lineNumner, lines[at].startOffset, lines[at].endOffset - lines[at].startOffset + 1);
+// The work of couldBeString; sets *reach past the last map byte read
+static int probeString(MemoryFile *mod, int entryPoint, int *reach) {
+	// The string table has the run; it's a string if the map is empty there
+	int run = st_fcs(entryPoint), offset;
+	for (offset = entryPoint; offset < entryPoint + run; offset++) {
+		*reach = offset + 1;
+		if (mm_type(&map, offset) != MM_UNKNOWN) {
+			// Already visited this byte; it's not a string.
+			return 0;
+		}
 	}
+	return run;
 }
 
 int couldBeString(MemoryFile *mod, int entryPoint) {
@@ -388,68 +697,219 @@ int couldBeString(MemoryFile *mod, int entryPoint) {
 	// NOTE: Just because something passes this check, doesn't
 	// mean it's really text. The longer the returned segment
 	// is, the higher the probability that it's text.
-	unsigned char flags, type;
-	int length, offset = 0;
+	int reach;
 	//printf("Speculatively checking for string at $%04X...\n", entryPoint);
-	do {
-		char c = mod->storage[entryPoint + offset];
-		char cc = c & 0x7F;
-		int valid = ((cc >= 0x20) || (cc == '\n') || (cc == '\r') || (c == '\t') || (c == 0x1b));
-		if (valid) {
-			// One of the chars we're willing to speculatively consider valid
-			if ((type=mm_type(&map, entryPoint + offset)) == MM_UNKNOWN) {
-				// We haven't visited this byte before
-				++offset;
-				if (c != cc) break; // Stop at end of string
-			} else {
-				// Already visited this byte; it's not a string.
-				return 0;
-			}
-		} else {
-			// Invalid character; say it's not a string
-			return 0;
+	++runStats.stringProbes;
+	return probeString(mod, entryPoint, &reach);
+}
+
+// Take an FCC string (--fcc) at entryPoint if the map is empty there,
+// setting its length prefix or zero terminator as FCB; returns the bytes
+// taken, or 0
+static int takeText(MemoryFile *mod, int entryPoint) {
+	int prefix, zero, text, bytes, offset;
+
+	if (!fcc || !(text = st_text(mod, entryPoint, &prefix, &zero))) return 0;
+	bytes = prefix + text + zero;
+	for (offset = entryPoint; offset < entryPoint + bytes; offset++)
+		if (mm_type(&map, offset) != MM_UNKNOWN) return 0;
+	if (prefix) mm_set(&map, entryPoint, MM_FCB, 1);
+	mm_set(&map, entryPoint + prefix, MM_FCC, text);
+	if (zero) mm_set(&map, entryPoint + prefix + text, MM_FCB, 1);
+	return bytes;
+}
+
+//
+// Data references (--data-refs). Each traced instruction is checked once
+// for an operand address in the image, from an extended or PCR mode, and
+// the bytes it reads or writes there are typed FCB or FDB before
+// speculation, unless something else already has them. A word read
+// through ,X++ (or Y or U) after the register was loaded with an address
+// in the image types a table of words from that address, for as long as
+// the words are addresses in the image too.
+//
+
+#define REF_TABLE_MAX 128	// Words in a table
+
+static unsigned char *refChecked = NULL;	// Instructions already checked
+
+static int unknownRun(int offset, int count, int length) {
+	int i;
+	if (offset < 0 || offset + count > length) return 0;
+	for (i = offset; i < offset + count; i++)
+		if (mm_type(&map, i) != MM_UNKNOWN) return 0;
+	return 1;
+}
+
+static void typeRef(MemoryFile *mod, int offset, int width, int from) {
+	if (!unknownRun(offset, width, mod->length)) return;
+	if (pv_enabled) pv_cause(PV_DATAREF, from);
+	if (width == 1) mm_set(&map, offset, MM_FCB, 1);
+	else mm_setFDB(&map, offset, width);
+	runStats.dataRefs += width;
+}
+
+static void typeTable(MemoryFile *mod, int offset, int from) {
+	int count = 0, target;
+	while (count < 2 * REF_TABLE_MAX && unknownRun(offset + count, 2, mod->length)) {
+		target = mf_get_word(mod, offset + count) - mod->abs_base;
+		if (target < 0 || target >= mod->length) break;
+		count += 2;
+	}
+	if (!count) return;
+	if (pv_enabled) pv_cause(PV_DATAREF, from);
+	mm_setFDB(&map, offset, count);
+	runStats.dataRefs += count;
+}
+
+// Index register (0 to 2 for X, Y, U) an LD or LEA mnemonic loads, or -1
+static int loadedReg(char *mnemonic) {
+	char *r;
+	if (!strncmp(mnemonic, "LEA", 3)) r = mnemonic + 3;
+	else if (!strncmp(mnemonic, "LD", 2)) r = mnemonic + 2;
+	else return -1;
+	if (!strcmp(r, "X")) return 0;
+	if (!strcmp(r, "Y")) return 1;
+	if (!strcmp(r, "U")) return 2;
+	return -1;
+}
+
+static void typeDataRefs(MemoryFile *mod) {
+	Decoded d;
+	int offset = 0, end = -1, width, target, r;
+	int loaded[3];		// Image offset X, Y and U were last loaded with, or -1
+
+	if (refChecked == NULL) {
+		refChecked = (unsigned char *)calloc(mod->length, 1);
+		if (refChecked == NULL) {
+			fprintf(stderr, "ERROR: typeDataRefs: Insufficient memory.\n");
+			exit(1);
 		}
-	} while (entryPoint + offset < mod->length);
-	return offset;
+	}
+	while (offset < mod->length) {
+		if (mm_type(&map, offset) != MM_CODE1 || refChecked[offset]) {
+			++offset;
+			continue;
+		}
+		if (offset != end) loaded[0] = loaded[1] = loaded[2] = -1;
+		refChecked[offset] = 1;
+		M6809_decode(mod, offset, &d);
+		end = offset + d.bytes;
+
+		// A direct reference
+		width = M6809_width(&d);
+		target = -1;
+		if (d.mode == EXTENDED || d.mode == IEXTENDED) target = d.value - mod->abs_base;
+		else if (d.mode == PCR_8 || d.mode == PCR_16 || d.mode == IPCR_8 || d.mode == IPCR_16) target = d.eff;
+		if (width && target >= 0) typeRef(mod, target, width, offset);
+
+		// A table walked with a loaded index register
+		if ((r = loadedReg(d.inst->mnemonic)) >= 0) {
+			loaded[r] = -1;
+			if (d.mode == PCR_8 || d.mode == PCR_16) loaded[r] = d.eff;
+			else if (d.mode == IMMED_16 && d.value - mod->abs_base >= 0 && d.value - mod->abs_base < mod->length)
+				loaded[r] = d.value - mod->abs_base;
+		} else if (d.mode == POSTINC_2 && width == 2 && (d.postbyte & IREG_MASK) != IREG_S) {
+			r = (d.postbyte & IREG_MASK) >> 5;
+			if (loaded[r] >= 0) typeTable(mod, loaded[r], offset);
+			loaded[r] = -1;
+		} else if (d.mode == REGISTER || d.mode == REG_PULL_S || d.mode == REG_PULL_U) {
+			// TFR, EXG or PUL might load any of them
+			loaded[0] = loaded[1] = loaded[2] = -1;
+		}
+		if (d.flags & LEAF) end = -1;
+		offset += d.bytes;
+	}
 }
 
 int isNotCode(int entryPoint) {
     // Returns 1 if this entry point (offset) is on the NotCode list
-    for (int i=0; i<notCodeStack.top; i++) {
-        if (entryPoint == notCodeStack.storage[i])
-            return 1;
-    }
-    return 0;
+    return entryPoint >= 0 && entryPoint < (int)sizeof(notCodeMap) && notCodeMap[entryPoint];
 }
 
-int couldBeCode(MemoryFile *mod, int entryPoint) {
-	// Here, we speculatively disassemble forward from offset
-	// checking only the linear instruction stream; if it has
-	// no invalid opcodes until the leaf this "could be" code.
-	//
-	// Returns 0 if bad, else # bytes processed including leaf.
-	// Does not set a label.
-	//
-	// NOTE: Just because something passes this check, doesn't
-	// mean it's really code. The longer the returned segment
-	// is, the higher the probability that it's code.
-	unsigned char flags, type;
-	int length, offset = 0;
-	//printf("Speculatively disassembling at $%04X...\n", entryPoint);
+//
+// Speculative traces that can be undone (--spec-rollback). Entry points
+// taken by speculation are traced one at a time, each with everything it
+// leads to, while the map logs its changes. One that meets too many
+// conflicting map types or invalid opcodes is rolled back, and the code
+// it had mapped can't be a speculation candidate again.
+//
 
-    // Make sure speculative disassembly is allowed
-    if (!specflag) return 0;
-    // Make sure it's not on the NotCode list
-    if (isNotCode(entryPoint)) return 0;
+typedef struct SpecTrace {
+	int depth;		// Address stack depth when it ends, or -1 if none is open
+	int entry;
+	int faults;		// Invalid opcodes met
+	long conflicts;	// map.conflicts when it began
+	int labels;		// labelStack depth when it began
+	long mark;		// Provenance events when it began
+} SpecTrace;
+
+static SpecTrace specTrace = { -1 };
+static int specEntries = 0;	// Non-zero when the address stack holds speculation's entry points
+static unsigned char *specRejected = NULL;	// Code of rolled back traces
+
+static int isRejected(int entryPoint) {
+	return specRejected && specRejected[entryPoint];
+}
+
+static void specBegin(MemoryFile *mod, int entryPoint) {
+	if (specRejected == NULL) {
+		specRejected = (unsigned char *)calloc(mod->length, 1);
+		if (specRejected == NULL) {
+			fprintf(stderr, "ERROR: specBegin: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	specTrace.depth = addrStack.top;
+	specTrace.entry = entryPoint;
+	specTrace.faults = 0;
+	specTrace.conflicts = map.conflicts;
+	specTrace.labels = labelStack.top;
+	specTrace.mark = pv_enabled ? pv_mark() : 0;
+	mm_begin(&map);
+}
+
+static void specEnd() {
+	int faults = specTrace.faults + (int)(map.conflicts - specTrace.conflicts);
+	int i, offset;
+
+	if (faults > specRollback) {
+		if (_debug) printf("Rolling back speculative trace from offset $%04X (%d conflicts or invalid opcodes)\n",
+			specTrace.entry, faults);
+		for (i = 0; i < map.undoCount; i++) {
+			offset = map.undo[i].offset;
+			if ((map.undo[i].old & ~MM_LABEL) == MM_UNKNOWN && mm_type(&map, offset) != MM_UNKNOWN)
+				specRejected[offset] = 1;
+		}
+		++runStats.rollbacks;
+		runStats.undone += map.undoCount;
+		mm_rollback(&map);
+		map.conflicts = specTrace.conflicts;
+		labelStack.top = specTrace.labels;
+		if (pv_enabled) pv_undo(specTrace.mark);
+	} else {
+		mm_commit(&map);
+	}
+	specTrace.depth = -1;
+}
 
+// The work of couldBeCode once it's allowed; counts decoder calls and
+// instructions into *decodes and *probed, and sets *reach past the last
+// map byte read
+static int probeCode(MemoryFile *mod, int entryPoint, long *decodes, long *probed, int *reach) {
+	unsigned char flags, type;
+	int length, offset = 0;
 	do {
 		flags = M6809_flags(mod, entryPoint + offset);
+		++*decodes;
 		if (flags & HAS_6809) {
 			// Valid opcode
+			*reach = entryPoint + offset + 1;
 			if ((type=mm_type(&map, entryPoint + offset)) == MM_UNKNOWN) {
 				// We haven't visited this code before - linear
 				// Don't worry about any branch destinations, etc
 				length = M6809_bytes(mod, entryPoint + offset);
+				++*decodes, ++*probed;
 				offset += length;
 			} else {
 				// Already visited this code; stop looking at code here
@@ -467,20 +927,282 @@ int couldBeCode(MemoryFile *mod, int entryPoint) {
 	return offset;
 }
 
+int couldBeCode(MemoryFile *mod, int entryPoint) {
+	// Here, we speculatively disassemble forward from offset
+	// checking only the linear instruction stream; if it has
+	// no invalid opcodes until the leaf this "could be" code.
+	//
+	// Returns 0 if bad, else # bytes processed including leaf.
+	// Does not set a label.
+	//
+	// NOTE: Just because something passes this check, doesn't
+	// mean it's really code. The longer the returned segment
+	// is, the higher the probability that it's code.
+	int reach;
+	//printf("Speculatively disassembling at $%04X...\n", entryPoint);
+
+    // Make sure speculative disassembly is allowed
+    if (!specflag) return 0;
+    // Make sure it's not on the NotCode list, or rolled back before
+    if (isNotCode(entryPoint) || isRejected(entryPoint)) return 0;
+	++runStats.codeProbes;
+	return probeCode(mod, entryPoint, &runStats.decodes, &runStats.probed, &reach);
+}
+
+//
+// Speculation candidates scored ahead on --jobs threads. Probes only read
+// the map, so a round's candidates are scored against the map as it was
+// when the round began; mapCode then takes them in its usual order and
+// uses a score unless a string it has set since covers a byte the probe
+// read, in which case it probes again. The result is the serial one for
+// any number of threads.
+//
+
+#define SPEC_MIN 4096	// Fewer candidates are probed faster than threads start
+#define SPEC_CHUNK 1024	// Candidates per task
+
+typedef struct SpecScore {
+	int code;		// couldBeCode, or -1 if not scored
+	int string;		// couldBeString, if code is under CODE_THRESHOLD or the model may turn it down
+	int reach;		// Offset past the last map byte the probes read
+} SpecScore;
+
+typedef struct SpecCounts {
+	long decodes, probed, codeProbes, stringProbes;
+} SpecCounts;
+
+typedef struct SpecBatch {
+	MemoryFile *mod;
+	int *offsets;
+	int count;
+	SpecCounts *counts;	// One per task, added to runStats after
+} SpecBatch;
+
+static SpecScore *specScores = NULL;
+static unsigned char *specDirty = NULL;	// Map bytes set since the scores
+
+static void scoreChunk(int task, void *arg) {
+	SpecBatch *b = (SpecBatch *)arg;
+	SpecCounts *n = &b->counts[task];
+	int i, end = (task + 1) * SPEC_CHUNK < b->count ? (task + 1) * SPEC_CHUNK : b->count;
+
+	for (i = task * SPEC_CHUNK; i < end; i++) {
+		int eff = b->offsets[i], reach = eff;
+		SpecScore *s = &specScores[eff];
+		s->code = 0;
+		if (specflag && !isNotCode(eff) && !isRejected(eff)) {
+			++n->codeProbes;
+			s->code = probeCode(b->mod, eff, &n->decodes, &n->probed, &reach);
+		}
+		s->string = 0;
+		if (s->code < CODE_THRESHOLD || ng_enabled) {
+			int stringReach = eff;
+			++n->stringProbes;
+			s->string = probeString(b->mod, eff, &stringReach);
+			if (stringReach > reach) reach = stringReach;
+		}
+		s->reach = reach;
+	}
+}
+
+// Score the candidates at offsets, each once, if there are enough of them
+static void specScore(MemoryFile *mod, int *offsets, int count) {
+	SpecBatch b;
+	int i, tasks;
+
+	if (jobs < 2 || count < SPEC_MIN) return;
+	if (specScores == NULL) {
+		specScores = (SpecScore *)malloc(sizeof(SpecScore) * mod->length);
+		specDirty = (unsigned char *)malloc(mod->length);
+		if (specScores == NULL || specDirty == NULL) {
+			fprintf(stderr, "ERROR: specScore: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	for (i = 0; i < mod->length; i++) specScores[i].code = -1;
+	memset(specDirty, 0, mod->length);
+	tasks = (count + SPEC_CHUNK - 1) / SPEC_CHUNK;
+	b.mod = mod;
+	b.offsets = offsets;
+	b.count = count;
+	b.counts = (SpecCounts *)calloc(tasks, sizeof(SpecCounts));
+	if (b.counts == NULL) {
+		fprintf(stderr, "ERROR: specScore: Insufficient memory.\n");
+		exit(1);
+	}
+	tp_run(jobs, tasks, scoreChunk, &b);
+	for (i = 0; i < tasks; i++) {
+		runStats.decodes += b.counts[i].decodes;
+		runStats.probed += b.counts[i].probed;
+		runStats.codeProbes += b.counts[i].codeProbes;
+		runStats.stringProbes += b.counts[i].stringProbes;
+	}
+	free(b.counts);
+}
+
+// The scores for eff, if it was scored and nothing the probes read has
+// been set since; else NULL
+static SpecScore* specScored(int eff) {
+	SpecScore *s;
+	int i;
+	if (specScores == NULL || specScores[eff].code < 0) return NULL;
+	s = &specScores[eff];
+	for (i = eff; i < s->reach; i++)
+		if (specDirty[i]) return NULL;
+	return s;
+}
+
+// Note bytes set as a string since the scores
+static void specSet(int eff, int run) {
+	if (specScores) memset(specDirty + eff, 1, run);
+}
+
+static void specForget() {
+	free(specScores);
+	free(specDirty);
+	specScores = NULL;
+	specDirty = NULL;
+}
+
+//
+// Code candidates scored with the opcode model (--spec-model, --spec-min).
+// Unlikely ones are skipped, and a round's are pushed together at its
+// end, likeliest last so they are traced first.
+//
+
+typedef struct SpecTake {
+	int offset, run;
+	double score;
+	int order;		// Taken order, to break ties as before
+} SpecTake;
+
+static int modelTrained = 0;	// The model has the image's traced code
+static SpecTake *takes = NULL;
+static int takeCount = 0, takeMax = 0;
+
+static double codeScore(MemoryFile *mod, int eff, int run) {
+	return ng_enabled ? ng_score(mod, eff, run) : NG_UNTRAINED;
+}
+
+static void specPush(MemoryFile *mod, int eff, int run) {
+	intstack_push(&addrStack, eff);
+	if (pv_enabled) pv_push(eff, PV_SPEC, -1);
+	if (tl_enabled) tl_candidate(eff + mod->abs_base, run, 0);
+}
+
+// Take eff as code
+static void specTake(MemoryFile *mod, int eff, int run, double score) {
+	if (!ng_enabled) {
+		specPush(mod, eff, run);
+		return;
+	}
+	if (takeCount == takeMax) {
+		takeMax = takeMax ? takeMax * 2 : 256;
+		takes = (SpecTake *)realloc(takes, sizeof(SpecTake) * takeMax);
+		if (takes == NULL) {
+			fprintf(stderr, "ERROR: specTake: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	takes[takeCount].offset = eff;
+	takes[takeCount].run = run;
+	takes[takeCount].score = score;
+	takes[takeCount].order = takeCount;
+	++takeCount;
+}
+
+static int byScore(const void *a, const void *b) {
+	const SpecTake *x = (const SpecTake *)a, *y = (const SpecTake *)b;
+	if (x->score != y->score) return x->score < y->score ? -1 : 1;
+	return x->order - y->order;
+}
+
+// Push the round's code candidates, likeliest on top
+static void specPushTakes(MemoryFile *mod) {
+	int i;
+	if (takeCount == 0) return;
+	qsort(takes, takeCount, sizeof(SpecTake), byScore);
+	for (i = 0; i < takeCount; i++) specPush(mod, takes[i].offset, takes[i].run);
+	takeCount = 0;
+}
+
+// Score a round's candidates ahead: the labels on labels, or if it's
+// NULL every UNKNOWN byte of the map
+static void specScoreRound(MemoryFile *mod, IntStack *labels) {
+	unsigned char *seen = NULL;
+	int *offsets, count = 0, eff, i;
+
+	if (jobs < 2 || (labels && labels->top < SPEC_MIN)) return;
+	offsets = (int *)malloc(sizeof(int) * mod->length);
+	if (labels) seen = (unsigned char *)calloc(mod->length, 1);
+	if (offsets == NULL || (labels && seen == NULL)) {
+		fprintf(stderr, "ERROR: specScoreRound: Insufficient memory.\n");
+		exit(1);
+	}
+	if (labels) {
+		for (i = 0; i < labels->top; i++) {
+			eff = labels->storage[i];
+			if (eff >= 0 && eff < mod->length && !seen[eff] && mm_type(&map, eff) == MM_UNKNOWN && !sz_isSkip(eff)) {
+				seen[eff] = 1;
+				offsets[count++] = eff;
+			}
+		}
+	} else {
+		for (eff = 0; eff < mod->length; eff++)
+			if (mm_type(&map, eff) == MM_UNKNOWN && !sz_isSkip(eff)) offsets[count++] = eff;
+	}
+	specScore(mod, offsets, count);
+	free(offsets);
+	free(seen);
+}
+
 void mapCode(MemoryFile *mod) {
     int allowed = 1;
-	int entryPoint, length, dest, eff, run;
+	int entryPoint, length, dest, eff, run, start;
+	long strings = 0, traced, probes;
+	long long at = 0;
 	unsigned char flags, type;
+	SpecScore *score;
+	PtDecode *d;
+	int speculative, found, parallel;
+	double likelihood;
 
 	// Build the map based on linear and (easy) branch traversal
-	while (!intstack_isEmpty(&addrStack)) {
+	rs_begin(RS_TRACE);
+	speculative = specEntries && specRollback >= 0;
+	specEntries = 0;
+	// Trace on --jobs threads if that builds the same map; the loop then
+	// replays the trace in its order, without decoding or mapping again
+	parallel = !speculative && !pv_enabled && !tl_enabled && pt_trace(mod, &map, &addrStack, jobs);
+	for (;;) {
+		// A speculative trace ends when everything it pushed is traced
+		if (specTrace.depth == addrStack.top) specEnd();
+		if (intstack_isEmpty(&addrStack)) {
+			if (parallel) {
+				pt_end();
+				parallel = 0;
+			}
+			// Trace through any jump tables the code dispatches through
+			if (!jumpTables || !(found = jt_find(mod))) break;
+			runStats.tables += found;
+			continue;
+		}
 		entryPoint = intstack_pop(&addrStack);
+		if (speculative && specTrace.depth < 0) specBegin(mod, entryPoint);
+		if (tl_enabled) at = tl_now();
+		start = entryPoint;
+		traced = runStats.traced;
 		if (_debug) {
 			if (mod->abs_base)
 				printf("Popping offset $%04X (absolute $%04X)...\n", entryPoint, entryPoint + mod->abs_base);
 			else
 				printf("Popping offset $%04X...\n", entryPoint);
 		}
+        // Transfers can point outside the module; there's nothing to trace there
+        if (entryPoint < 0 || entryPoint >= mod->length) {
+            if (tl_enabled) tl_run(at, entryPoint + mod->abs_base, 0, 0);
+            continue;
+        }
         // Make sure it's not on the NotCode list
         if (isNotCode(entryPoint)) {
             if (_debug) {
@@ -489,32 +1211,40 @@ void mapCode(MemoryFile *mod) {
                 else
                     printf("IGNORING: Offset $%04X is on the NotCode list.\n", entryPoint);
             }
+            if (tl_enabled) tl_run(at, entryPoint + mod->abs_base, 0, 0);
             continue;
         }
 
 		mm_setLabel(&map, entryPoint, 1);  // We know this has a label
+		if (pv_enabled) pv_cause(PV_TRACE, entryPoint);
 		do {
-			flags = M6809_flags(mod, entryPoint);
+			d = parallel ? pt_decoded(entryPoint) : NULL;
+			flags = d ? d->flags : M6809_flags(mod, entryPoint);
+			++runStats.decodes;
 			if (flags & HAS_6809) {
 				// Valid opcode
-				if ((type=mm_type(&map, entryPoint)) == MM_UNKNOWN) {
+				if ((type=parallel ? pt_type(&map, entryPoint) : mm_type(&map, entryPoint)) == MM_UNKNOWN) {
 					// We haven't visited this code before
-					length = M6809_bytes(mod, entryPoint);
-					mm_setCode(&map, entryPoint, length);
+					length = d ? d->bytes : M6809_bytes(mod, entryPoint);
+					if (parallel) pt_visit(entryPoint, length);
+					else mm_setCode(&map, entryPoint, length);
+					runStats.decodes += 2, runStats.traced++;
 					// If there's a transfer address, push it
 					dest = -1;
 					if (flags & TRANSFER) {
-						dest = M6809_transfer(mod, entryPoint);
+						dest = d ? d->dest : M6809_transfer(mod, entryPoint);
+						++runStats.decodes;
 						if (dest != -1) {
 							// We know what the transfer address is! Save it for later
 							intstack_push(&addrStack, dest);
+							if (pv_enabled) pv_push(dest, PV_TRANSFER, entryPoint);
 						}
 					}
 					// Save other PC relative references for later
 					// These could be to data rather than code, so label them immediately
-					eff = M6809_pcrel(mod, entryPoint);
+					eff = d ? d->eff : M6809_pcrel(mod, entryPoint);
 					if ((eff != dest) && (eff != -1)) {
-						type = mm_type(&map, eff);
+						type = parallel ? pt_type(&map, eff) : mm_type(&map, eff);
 						mm_setLabel(&map, eff, 1);
 						if (type == MM_UNKNOWN) {
 							intstack_push(&labelStack, eff);
@@ -533,25 +1263,50 @@ void mapCode(MemoryFile *mod) {
 				// Invalid opcode; stop looking at code here
 				// by faking that this is a "leaf" (e.g. JMP, BRA, RTS)
 				flags |= LEAF;
+				if (specTrace.depth >= 0) ++specTrace.faults;
 			}
 		} while ((entryPoint < mod->length) && !(flags & LEAF));
+		if (tl_enabled) tl_run(at, start + mod->abs_base, runStats.traced - traced, entryPoint - start);
 	}
 
 	// Address stack is empty
+	rs_end(RS_TRACE);
 
 	// Extend the map based on speculative disassembly from the labelStack
+	rs_begin(RS_SPEC);
+	if (tl_enabled) at = tl_now();
+	probes = runStats.codeProbes + runStats.stringProbes;
+	if (pv_enabled) pv_round();
+	if (dataRefs) typeDataRefs(mod);
+	if (pv_enabled) pv_cause(PV_SPEC, -1);
 	length = 0;
+	if ((ng_enabled || saveModelName) && !modelTrained) {
+		// Learn from the code traced from real entry points
+		ng_train(mod, &map);
+		modelTrained = 1;
+	}
 	//printf("Speculatively checking labelStack for referenced regions...\n");
+	specScoreRound(mod, &labelStack);
 	while (!intstack_isEmpty(&labelStack)) {
 		eff = intstack_pop(&labelStack);
-		if (mm_type(&map, eff) == MM_UNKNOWN) {
-			if ((run=couldBeCode(mod, eff)) >= CODE_THRESHOLD) {
-				// Assume a long-enough potential code run is code
-				intstack_push(&addrStack, eff);
+		if (mm_type(&map, eff) == MM_UNKNOWN && !sz_isSkip(eff)) {
+			score = specScored(eff);
+			if ((run=score ? score->code : couldBeCode(mod, eff)) >= CODE_THRESHOLD
+					&& (likelihood=codeScore(mod, eff, run)) >= specMin) {
+				// Assume a long-enough, likely enough potential code run is code
+				specTake(mod, eff, run, likelihood);
 				++length;
-			} else if ((run=couldBeString(mod, eff)) >= STRING_THRESHOLD) {
+			} else if ((run=score ? score->string : couldBeString(mod, eff)) >= STRING_THRESHOLD) {
 				// Assume a long-enough potential string is a string
 				mm_setString(&map, eff, run);
+				specSet(eff, run);
+				++strings;
+				if (tl_enabled) tl_candidate(eff + mod->abs_base, run, 1);
+			} else if ((run=takeText(mod, eff)) > 0) {
+				// Or a delimited one
+				specSet(eff, run);
+				++strings;
+				if (tl_enabled) tl_candidate(eff + mod->abs_base, run, 1);
 			}
 		}
 	}
@@ -560,17 +1315,29 @@ void mapCode(MemoryFile *mod) {
 		// Try walking through the whole map looking for code or strings.
 		// This is a higher-risk speculation
 		//printf("Speculatively checking map for UNKNOWN regions...\n");
+		specScoreRound(mod, NULL);
 		eff = 0;
 		while (eff < map.maxElements) {
-			if (mm_type(&map, eff) == MM_UNKNOWN) {
-				if ((run=couldBeCode(mod, eff)) >= CODE_THRESHOLD) {
-					// Assume a long-enough potential code run is code
-					intstack_push(&addrStack, eff);
+			if (mm_type(&map, eff) == MM_UNKNOWN && !sz_isSkip(eff)) {
+				score = specScored(eff);
+				if ((run=score ? score->code : couldBeCode(mod, eff)) >= CODE_THRESHOLD
+						&& (likelihood=codeScore(mod, eff, run)) >= specMin) {
+					// Assume a long-enough, likely enough potential code run is code
+					specTake(mod, eff, run, likelihood);
 					++length;
 					eff += run;
-				} else if ((run=couldBeString(mod, eff)) >= STRING_THRESHOLD) {
+				} else if ((run=score ? score->string : couldBeString(mod, eff)) >= STRING_THRESHOLD) {
 					// Assume a long-enough potential string is a string
 					mm_setString(&map, eff, run);
+					specSet(eff, run);
+					++strings;
+					if (tl_enabled) tl_candidate(eff + mod->abs_base, run, 1);
+					eff += run;
+				} else if ((run=takeText(mod, eff)) > 0) {
+					// Or a delimited one
+					specSet(eff, run);
+					++strings;
+					if (tl_enabled) tl_candidate(eff + mod->abs_base, run, 1);
 					eff += run;
 				} else {
 					++eff;
@@ -580,8 +1347,15 @@ void mapCode(MemoryFile *mod) {
 			}
 		}
 	}
+	specForget();
+	specPushTakes(mod);
+	runStats.codeHits += length;
+	runStats.stringHits += strings;
+	if (tl_enabled) tl_round(at, length, strings, runStats.codeProbes + runStats.stringProbes - probes);
+	rs_endRound(length, strings);
 	if (length) {
 		// There were changes to the stack; recurse
+		specEntries = 1;
 		mapCode(mod);
 	}
 }
@@ -590,244 +1364,11 @@ void dumpMap() {
 	mm_dump(&map, 64);
 }
 
-void appendComment(char* text) {
-	int cl = strlen(comment);
-	sprintf(comment+cl, " %s", text);
-}
-
-void eol() {
-	// Dump comment (if any) and end-of-line
-	if (*comment)
-	{
-		printf(" ;%s", comment);
-		*comment = '\0';
-	}
-	printf("\n");
-}
-
-void dumpBytes(MemoryFile *mod, int offset, int length) {
-	int i;
-	char sep = ' ';
-	for (i=0; i<length; i++)
-	{
-		if (ioflag && (i<(length-1)))
-		{
-			char *io = CoCo3_ioNameData(mod, offset+i);
-			if (*io)
-			{
-				int cl = strlen(comment);
-				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
-			}
-		}
-		printf("%c$%02X", sep, mod->storage[offset+i]);
-		sep = ',';
-	}
-	eol();
-}
-
-void dumpPairs(MemoryFile *mod, int offset, int length) {
-	int i;
-	char sep = ' ';
-	length &= ~1;
-	for (i=0; i<length; i+=2)
-	{
-		if (ioflag)
-		{
-			char *io = CoCo3_ioNameData(mod, offset+i);
-			if (*io)
-			{
-				int cl = strlen(comment);
-				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
-			}
-		}
-		printf("%c$%02X%02X", sep, mod->storage[offset+i], mod->storage[offset+i+1]);
-		sep = ',';
-	}
-	eol();
-}
-
-void dumpString(MemoryFile *mod, int offset, int length) {
-	int i;
-	printf(" \"");
-	for (i=0; i<length; i++)
-	{
-		unsigned char c = mod->storage[offset+i] & 0x7f;
-		switch (c) {
-			case '\t':
-				printf("\\t");
-				break;
-			case '\n':
-				printf("\\n");
-				break;
-			case '\r':
-				printf("\\r");
-				break;
-			case 0x1B:
-				printf("\\1B");
-				break;
-			default:
-				printf("%c",c);
-				break;
-		}
-	}
-	printf("\"");
-	eol();
-}
-
-void dumpManyBytes(char* mnemonic, MemoryFile *mod, int offset, int length) {
-	int i;
-	char sep;
-	for (i=0; i<length; i++)
-	{
-		if ((i%8) == 0)
-		{
-			if (i) eol();
-			printf(" %s", mnemonic);
-			sep = ' ';
-		}
-		if (ioflag && (i<(length-1)))
-		{
-			char *io = CoCo3_ioNameData(mod, offset+i);
-			if (*io)
-			{
-				int cl = strlen(comment);
-				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
-			}
-		}
-		printf("%c$%02X", sep, mod->storage[offset+i]);
-		sep = ',';
-	}
-	eol();
-}
-
-void dumpManyPairs(char* mnemonic, MemoryFile *mod, int offset, int length) {
-	int i;
-	char sep;
-	length &= ~1;
-	for (i=0; i<length; i+=2)
-	{
-		if ((i%8) == 0)
-		{
-			if (i) eol();
-			printf(" %s", mnemonic);
-			sep = ' ';
-		}
-		if (ioflag)
-		{
-			char *io = CoCo3_ioNameData(mod, offset+i);
-			if (*io)
-			{
-				int cl = strlen(comment);
-				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
-			}
-		}
-		printf("%c$%02X%02X", sep, mod->storage[offset+i], mod->storage[offset+i+1]);
-		sep = ',';
-	}
-	eol();
-}
-void disassemble(MemoryFile *mod, MemoryMap *map) {
-	// TODO: map line numbers to eff values
-	int run, length, type;
-	int eff = 0, effWord;
-	char *label, *postLabel = NULL;
-	//printf("Disassembling...\n");
-	while (eff < map->maxElements) {
-		type = mm_type(map, eff);
-		run = mm_runLength(map, eff);
-		//printf("%d: ", lineCount+1);
-		if ((label=M6809_label(map,eff))) {
-			if (source) {
-				printf("%s", label);
-			} else {
-				// Display a generic string for all labels if diff
-				printf("LABEL");
-			}
-		}
-		switch (type) {
-			case MM_UNKNOWN:
-			case MM_FCB:
-				// Get the run length, crop to 8
-				dumpManyBytes("FCB", mod, eff, run);
-				break;
-			case MM_FCC:
-				// Output as-is
-				printf(" FCC");
-				dumpString(mod, eff, run);
-				break;
-			case INVALID:
-				// Get the run length, crop to 8
-				dumpManyBytes("???", mod, eff,run);
-				break;
-			case MM_FDB:
-				// Get the run length, crop to 8
-				length = run & 0x01;
-				dumpManyPairs("FDB", mod, eff, run - length);
-				// If there's an extra byte at the end, handle it
-				if (length) {
-					printf(" FCB");
-					dumpBytes(mod, eff + run - length, 1);
-				}
-				break;
-            case MM_FDB_JTEXT:
-                // NOTE: Assumes run is 2
-                effWord = mf_get_word(mod, eff);
-                postLabel = M6809_labelUnbounded(map, effWord - mod->abs_base);
-                printf(" FDB $%04X", effWord);
-                if (source && postLabel) appendComment(postLabel);
-                eol();
-                break;
-            case MM_FDB_JTPIC:
-                // NOTE: Assumes run is 2
-                effWord = mf_get_word(mod, eff);
-                postLabel = M6809_labelUnbounded(map, (effWord + eff) & 0xFFFF);
-                printf(" FDB $%04X", effWord);
-                if (source && postLabel) appendComment(postLabel);
-                eol();
-                break;
-            case MM_FDB_JTREL:
-                // TODO: Format these specially
-                dumpManyPairs("FDB", mod, eff, run);
-                break;
-			case MM_FCS:
-				// Output as-is
-				printf(" FCS");
-				dumpString(mod, eff, run);
-				break;
-			case MM_CODE1:
-				// Output as-is
-				if (ioflag)
-				{
-					char *io = CoCo3_ioNameCode(mod, eff);
-					if (*io)
-					{
-						int cl = strlen(comment);
-						sprintf(comment+cl, " IOREF 0x%04X: %s", eff, io);
-					}
-				}
-				printf(" %s %s", M6809_opcode(mod, eff), M6809_operands(operands, mod, map, eff));
-				eol();
-				break;
-			default:
-				// Output as a single FCB
-				run = 1;
-				printf(" FCB");
-				dumpBytes(mod, eff, run);
-				break;
-		}
-		// Track lines for later diff reversal
-		++lineCount;
-		lines[lineCount].lineNumner = lineCount;
-		lines[lineCount].startOffset = eff;
-		lines[lineCount].endOffset = eff + run - 1;
-		// Advance to next part of module
-		eff += run;
-	}
-}
-
-void infogen(MemoryFile *mod) {
+void infogen(MemoryFile *mod, OutBuf *out) {
 	int run, length, type;
 	int eff = 0;
+	// Tell hints_read these are offsets, as a comment f9dasm ignores
+	ob_printf(out, "* offsets\n");
 	//printf("Disassembling...\n");
 	while (eff < map.maxElements) {
 		type = mm_type(&map, eff);
@@ -837,25 +1378,25 @@ void infogen(MemoryFile *mod) {
 			case INVALID:
 			case MM_UNKNOWN:
 			case MM_FCB:
-				printf("HEX 0x%04x-0x%04x\n", eff, eff+run-1);
+				ob_printf(out, "HEX 0x%04x-0x%04x\n", eff, eff+run-1);
 				break;
 			case MM_FCS:
 			case MM_FCC:
-				printf("CHAR 0x%04x-0x%04x\n", eff, eff+run-1);
+				ob_printf(out, "CHAR 0x%04x-0x%04x\n", eff, eff+run-1);
 				break;
             case MM_FDB:
             case MM_FDB_JTEXT:
             case MM_FDB_JTPIC:
 			case MM_FDB_JTREL:
-				printf("WORD 0x%04x-0x%04x\n", eff, eff+run-1);
+				ob_printf(out, "WORD 0x%04x-0x%04x\n", eff, eff+run-1);
 				break;
 			case MM_CODE1:
-				printf("CODE 0x%04x-0x%04x\n", eff, eff+run-1);
+				ob_printf(out, "CODE 0x%04x-0x%04x\n", eff, eff+run-1);
 				break;
 			default:
 				// Output as a single FCB
 				run = 1;
-				printf("HEX 0x%04x-0x%04x\n", eff, eff+run-1);
+				ob_printf(out, "HEX 0x%04x-0x%04x\n", eff, eff+run-1);
 				break;
 		}
 		// Advance to next part of module
@@ -863,24 +1404,243 @@ void infogen(MemoryFile *mod) {
 	}
 }
 
-int main(int argc, char **argv) {
-	init();
-	processArgs(argc, argv);
-	loadFile(inFileName);
+void prepare(char *fName) {
+	// Load a module and find its structure and entry points
+	if (provenanceName) pv_init();
+	free(specRejected);
+	specRejected = NULL;
+	free(refChecked);
+	refChecked = NULL;
+	jt_reset();
+	modelTrained = 0;
+	for (int i=0; i < execStack.top; i++) {
+		intstack_push(&addrStack, execStack.storage[i]);
+		if (pv_enabled) pv_push(execStack.storage[i], PV_EXEC, -1);
+	}
+	is_os9 = 0;
+	entryStack.top = tableStack.top = segmentStack.top = 0;
+	rs_begin(RS_LOAD);
+	loadFile(fName);
+	rs_end(RS_LOAD);
     if (_debug) checksum = mf_checksum(&input);
+	rs_begin(RS_INFER);
+	hints_apply(&input, &map);
 	inferEntry(&input);
+	sz_reset();
+	if (prefilter) runStats.skipped = sz_scan(&input);
+	st_build(&input);
+	rs_end(RS_INFER);
 	//dumpStack();
+	for (int i=0; i < addrStack.top; i++)
+		if (addrStack.storage[i] < input.length)
+			intstack_push(&entryStack, addrStack.storage[i]);
+}
+
+void analyze(char *fName) {
+	// Load a module and trace it into input and map
+	prepare(fName);
 	mapCode(&input);
 	//dumpMap();
-	if (f9info) {
-		infogen(&input);
+}
+
+int compareModules(char *baseName, char *modName) {
+	// Disassemble both modules in turn and diff the results
+	OutBuf text[2];
+	LineIndex index[2];
+	CompareSide side[2];
+	char *names[2] = { baseName, modName };
+	int i, hunks;
+
+	for (i = 0; i < 2; i++) {
+		analyze(names[i]);
+		ob_init(&text[i], input.length * 24);
+		disassemble(&input, &map, jobs, &text[i]);
+		index[i] = lineIndex;
+		mf_destroy(&input);
+		mm_destroy(&map);
+		side[i].name = names[i];
+		side[i].text = &text[i];
+		side[i].index = &index[i];
+		side[i].lines = NULL;
+	}
+	hunks = cmp_print(&side[0], &side[1], 3);
+	for (i = 0; i < 2; i++) {
+		cmp_release(&side[i]);
+		ob_destroy(&text[i]);
+		li_destroy(&index[i]);
+	}
+	// Like diff, exit status 1 means the modules differ
+	return hunks ? 1 : 0;
+}
+
+void saveMap(char *fName) {
+	// Save the traced map, with the whole image as one segment if no modules
+	if (intstack_isEmpty(&segmentStack)) {
+		intstack_push(&segmentStack, 0);
+		intstack_push(&segmentStack, input.length);
+		intstack_push(&segmentStack, DM_RAW);
+	}
+	dm_save(fName, &map, &input, &entryStack, &tableStack, &segmentStack, is_os9 ? DM_OS9 : 0,
+		traceOptionsHash());
+}
+
+void loadMap(char *mapName, char *fName, DdMap *dm) {
+	// Load the module and attach a saved map instead of tracing it
+	rs_begin(RS_LOAD);
+	loadFile(fName);
+	addrStack.top = 0;	// Not tracing
+	dm_open(dm, mapName);
+	if (dm->length != input.length || dm->imageHash != dm_hash(input.storage, input.length)) {
+		fprintf(stderr, "ERROR: loadMap: '%s' is not a map of '%s'\n", mapName, fName);
+		exit(1);
+	}
+	if (dm->base != input.abs_base) {
+		fprintf(stderr, "ERROR: loadMap: '%s' was saved with base $%04X\n", mapName, dm->base);
+		exit(1);
+	}
+	mm_destroy(&map);
+	dm_attach(dm, &map);
+	is_os9 = (dm->flags & DM_OS9) != 0;
+	rs_end(RS_LOAD);
+}
+
+void traceOptions(OutBuf *options) {
+	// Describe everything that affects tracing
+	int i;
+	ob_printf(options, "base=%X;spec=%d;swipb=%d,%d,%d;exec=",
+		baseAddr, specflag, swipb, swi2pb, swi3pb);
+	for (i=0; i < execStack.top; i++)
+		ob_printf(options, "%X,", execStack.storage[i]);
+	ob_puts(options, ";notcode=");
+	for (i=0; i+1 < notCodeStack.top; i += 2)
+		ob_printf(options, "%X-%X,", notCodeStack.storage[i], notCodeStack.storage[i+1]);
+	ob_printf(options, ";hints=%016llx", hints_hash());
+	if (specRollback >= 0) ob_printf(options, ";rollback=%d", specRollback);
+	if (ng_enabled) ob_printf(options, ";model=%016llx,%g", ng_hash(), specMin);
+	if (prefilter) ob_puts(options, ";prefilter");
+	if (fcc) ob_puts(options, ";fcc");
+	if (dataRefs) ob_puts(options, ";datarefs");
+	if (jumpTables) ob_puts(options, ";jumptables");
+}
+
+unsigned long long traceOptionsHash() {
+	OutBuf options;
+	unsigned long long hash;
+	ob_init(&options, 256);
+	traceOptions(&options);
+	hash = dm_hash((unsigned char *)options.storage, options.length);
+	ob_destroy(&options);
+	return hash;
+}
+
+int cacheKey(CacheKey *key, char *fName) {
+	// Hash the module with everything that affects the output
+	OutBuf options;
+	int rv;
+	char *suffix = fName + strlen(fName);
+	if (suffix - fName >= 4) suffix -= 4;
+	ob_init(&options, 256);
+	traceOptions(&options);
+	ob_printf(&options, ";source=%d;f9info=%d;ioflag=%d;type=%s",
+		source, f9info, ioflag,
+		(!strcasecmp(suffix, ".s19") || !strcasecmp(suffix, ".mhx")) ? "srec" : "bin");
+	ob_putc(&options, '\0');
+	rv = cache_key(key, fName, options.storage);
+	ob_destroy(&options);
+	return rv;
+}
+
+int runModule(char *fName) {
+	// Disassemble one module to stdout
+	CacheKey key;
+	DdMap dm;
+	int useCache;
+
+	// Debug output goes to stdout during analysis, so isn't cached
+	// A loaded or earlier map isn't part of the key, so bypasses it too
+	// So does a provenance log, a saved model or a saved map, which need the trace
+	useCache = (cacheDir || cache_isShared()) && !_debug && !loadMapName && !sinceMapName && !provenanceName
+		&& !saveModelName && !saveMapName && cacheKey(&key, fName);
+	if (useCache) li_init(&lineIndex, 0);
+	if (useCache && cache_fetch(cacheDir, &key, &output, &lineIndex)) {
+		if (indexFileName && !f9info) li_write(&lineIndex, indexFileName);
 	} else {
-		disassemble(&input, &map);
-		if (!source) dumpLines();
+		if (loadMapName) {
+			loadMap(loadMapName, fName, &dm);
+		} else if (sinceMapName) {
+			prepare(fName);
+			if (!retrace(sinceMapName)) mapCode(&input);
+		} else {
+			analyze(fName);
+		}
+		if (saveMapName) saveMap(saveMapName);
+		if (provenanceName) pv_write(provenanceName, &map);
+		if (saveModelName) ng_save(saveModelName);
+		rs_begin(RS_EMIT);
+		if (f9info) {
+			infogen(&input, &output);
+		} else {
+			disassemble(&input, &map, jobs, &output);
+			if (!source) dumpLines(&output);
+			if (indexFileName) li_write(&lineIndex, indexFileName);
+		}
+		rs_end(RS_EMIT);
+		if (useCache) cache_store(cacheDir, &key, &output, &lineIndex, cacheMax * 1024 * 1024);
 	}
+	ob_flush(&output, stdout);
+	if (timelineName) tl_write(timelineName, fName);
+	if (statsflag) rs_report(stderr, &map, &addrStack, &labelStack, statsflag == 2);
     intstack_destroy(&addrStack);
     intstack_destroy(&labelStack);
     intstack_destroy(&notCodeStack);
+    intstack_destroy(&execStack);
+    intstack_destroy(&entryStack);
+    intstack_destroy(&tableStack);
+    intstack_destroy(&segmentStack);
+	if (loadMapName) dm_close(&dm);
+	ob_destroy(&output);
 	return 0;
 }
 
+int run() {
+	// Do what the options ask
+	if (manifestName) {
+		if (moduleCount || compareFileName || indexFileName || saveMapName || loadMapName || sinceMapName || timelineName || provenanceName) {
+			fprintf(stderr, "ERROR: --manifest names the modules, and can't be used with --compare, --index, --timeline, --provenance or map files\n");
+			usage();
+		}
+		return shard_run(manifestName, shardIndex, shardCount, outDir ? outDir : ".", jobs);
+	}
+	if (compareFileName && timelineName) {
+		fprintf(stderr, "ERROR: --timeline records a single module, and can't be used with --compare\n");
+		usage();
+	}
+	if (provenanceName && (compareFileName || loadMapName || sinceMapName)) {
+		fprintf(stderr, "ERROR: --provenance records a single full trace, and can't be used with --compare, --load-map or --since\n");
+		usage();
+	}
+	if (compareFileName && (moduleCount > 1 || reportDir))
+		return var_compare(compareFileName, moduleNames, moduleCount, reportDir ? reportDir : ".", jobs);
+	if (compareFileName) return compareModules(compareFileName, inFileName);
+	if (inFileName == NULL) usage();
+	return runModule(inFileName);
+}
+
+int request(int argc, char **argv) {
+	// Run one request in a server, from the server's defaults
+	serveSocketName = NULL;
+	jobs = 1;	// Workers already share the CPUs
+	processArgs(argc, argv);
+	return run();
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1 && !strcmp(argv[1], "hunks")) return hunks_main(argc-1, argv+1);
+	if (argc > 1 && !strcmp(argv[1], "client")) return client_main(argc-1, argv+1);
+	if (argc > 1 && !strcmp(argv[1], "merge")) return merge_main(argc-1, argv+1);
+	if (argc > 1 && !strcmp(argv[1], "explain")) return explain_main(argc-1, argv+1);
+	init();
+	processArgs(argc, argv);
+	if (serveSocketName) return serve(serveSocketName, jobs, cacheMax * 1024 * 1024);
+	return run();
+}
@@ -8,7 +8,14 @@
 #ifndef DIFFDASM_H_
 #define DIFFDASM_H_
 
-void appendComment(char* text);
+#include "memoryfile.h"
+
 void usage();
+void analyze(char *fName);
+void mapCode(MemoryFile *mod);
+int isNotCode(int entryPoint);
+unsigned long long traceOptionsHash();
+int runModule(char *fName);
+int request(int argc, char **argv);
 
 #endif /* DIFFDASM_H_ */
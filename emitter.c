@@ -0,0 +1,504 @@
+/*
+ * emitter.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Once mapCode has finished, the output depends only on the map and the
+// module bytes. The map is split into chunks at run boundaries, each
+// chunk is formatted into its own buffer (on a thread pool when there
+// is more than one), and the buffers are written out in order.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "linelist.h"
+#include "lineindex.h"
+#include "outbuf.h"
+#include "taskpool.h"
+#include "stats6809.h"
+#include "statsCoCo3.h"
+#include "runstats.h"
+
+#include "emitter.h"
+
+#define STRMAX 4096
+#define CHUNK_MIN 4096	// Don't bother splitting finer than this many bytes
+
+extern int source;	// Non-zero to disassemble in source format
+extern int ioflag;	// Non-zero to call out potential references to (Color Computer) I/O
+
+LineIndex lineIndex;	// Used to map line numbers to byte ranges
+
+static __thread char comment[STRMAX];	// Disassembly comment buffer (one per thread)
+
+// Labels that formatting in source mode adds for PC relative references
+// are worked out before the chunks are formatted. For each offset this
+// holds the offset of the instruction that first labels it, or -1 if it
+// was labelled by mapCode; a label is only shown from there on, just as
+// if the output had been generated in a single pass.
+static int *labelFrom = NULL;
+
+typedef struct Chunk {
+	int start;			// First offset in chunk
+	int end;			// Offset after last byte in chunk
+	LineList *lines;	// Runs in chunk (line numbers are chunk relative)
+	int lineCount;
+	int lineMax;
+	IntStack refs;		// Pairs of instruction offset, PC relative destination
+	OutBuf out;
+} Chunk;
+
+typedef struct Emission {
+	MemoryFile *mod;
+	MemoryMap *map;
+	Chunk *chunks;
+	int chunkCount;
+} Emission;
+
+void appendComment(char* text) {
+	int cl = strlen(comment);
+	sprintf(comment+cl, " %s", text);
+}
+
+static void eol(OutBuf *out) {
+	// Dump comment (if any) and end-of-line
+	if (*comment)
+	{
+		ob_printf(out, " ;%s", comment);
+		*comment = '\0';
+	}
+	ob_putc(out, '\n');
+}
+
+static void dumpBytes(OutBuf *out, MemoryFile *mod, int offset, int length) {
+	int i;
+	char sep = ' ';
+	for (i=0; i<length; i++)
+	{
+		if (ioflag && (i<(length-1)))
+		{
+			char *io = CoCo3_ioNameData(mod, offset+i);
+			if (*io)
+			{
+				int cl = strlen(comment);
+				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
+			}
+		}
+		ob_printf(out, "%c$%02X", sep, mod->storage[offset+i]);
+		sep = ',';
+	}
+	eol(out);
+}
+
+static void dumpString(OutBuf *out, MemoryFile *mod, int offset, int length) {
+	int i;
+	ob_puts(out, " \"");
+	for (i=0; i<length; i++)
+	{
+		unsigned char c = mod->storage[offset+i] & 0x7f;
+		switch (c) {
+			case '\t':
+				ob_puts(out, "\\t");
+				break;
+			case '\n':
+				ob_puts(out, "\\n");
+				break;
+			case '\r':
+				ob_puts(out, "\\r");
+				break;
+			case 0x1B:
+				ob_puts(out, "\\1B");
+				break;
+			default:
+				ob_putc(out, c);
+				break;
+		}
+	}
+	ob_putc(out, '"');
+	eol(out);
+}
+
+static void dumpManyBytes(OutBuf *out, char* mnemonic, MemoryFile *mod, int offset, int length) {
+	int i;
+	char sep;
+	for (i=0; i<length; i++)
+	{
+		if ((i%8) == 0)
+		{
+			if (i) eol(out);
+			ob_printf(out, " %s", mnemonic);
+			sep = ' ';
+		}
+		if (ioflag && (i<(length-1)))
+		{
+			char *io = CoCo3_ioNameData(mod, offset+i);
+			if (*io)
+			{
+				int cl = strlen(comment);
+				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
+			}
+		}
+		ob_printf(out, "%c$%02X", sep, mod->storage[offset+i]);
+		sep = ',';
+	}
+	eol(out);
+}
+
+static void dumpManyPairs(OutBuf *out, char* mnemonic, MemoryFile *mod, int offset, int length) {
+	int i;
+	char sep;
+	length &= ~1;
+	for (i=0; i<length; i+=2)
+	{
+		if ((i%8) == 0)
+		{
+			if (i) eol(out);
+			ob_printf(out, " %s", mnemonic);
+			sep = ' ';
+		}
+		if (ioflag)
+		{
+			char *io = CoCo3_ioNameData(mod, offset+i);
+			if (*io)
+			{
+				int cl = strlen(comment);
+				sprintf(comment+cl, " IOREF $%04X: %s", offset+i, io);
+			}
+		}
+		ob_printf(out, "%c$%02X%02X", sep, mod->storage[offset+i], mod->storage[offset+i+1]);
+		sep = ',';
+	}
+	eol(out);
+}
+
+// Return whether the label at target is visible when emitting offset at
+static int labelVisible(MemoryMap *map, int target, int at) {
+	if (!mm_isLabel(map, target)) return 0;
+	return (labelFrom == NULL) || (labelFrom[target] < at);
+}
+
+// Return the label for a jump table destination, as it stood when
+// emitting offset at ("X" prefixed if there isn't one)
+static char* tableLabel(MemoryMap *map, int target, int at) {
+	static __thread char labelBuf[16];
+	if (labelVisible(map, target, at)) {
+		return M6809_label(map, target);
+	}
+	sprintf(labelBuf, "X%04X", (target + map->abs_base) & 0xFFFF);
+	return labelBuf;
+}
+
+// Number of bytes emitted together starting at eff
+static int emitRun(MemoryMap *map, int eff, int type) {
+	int run = mm_runLength(map, eff);
+	switch (type) {
+		case MM_UNKNOWN:
+		case MM_FCB:
+		case MM_FCC:
+		case INVALID:
+		case MM_FDB:
+		case MM_FDB_JTEXT:
+		case MM_FDB_JTPIC:
+		case MM_FDB_JTREL:
+		case MM_FCS:
+		case MM_CODE1:
+			break;
+		default:
+			// Output as a single FCB
+			run = 1;
+			break;
+	}
+	return run;
+}
+
+static int isPCRelative(int mode) {
+	switch (mode) {
+		case REL_8:
+		case REL_16:
+		case PCR_8:
+		case PCR_16:
+		case IPCR_8:
+		case IPCR_16:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+// Pass 1: find the runs in a chunk, and in source mode the PC relative
+// references that might add labels
+static void layoutChunk(int task, void *arg) {
+	Emission *e = (Emission *)arg;
+	Chunk *c = &e->chunks[task];
+	MemoryMap *map = e->map;
+	Decoded decoded;
+	int eff = c->start, run, type;
+
+	c->lineCount = 0;
+	c->lineMax = 256;
+	c->lines = (LineList *)malloc(sizeof(LineList) * c->lineMax);
+	if (c->lines == NULL) {
+		fprintf(stderr, "ERROR: layoutChunk: Insufficient memory for line list.\n");
+		exit(1);
+	}
+	intstack_init(&c->refs, 256);
+	while (eff < c->end) {
+		type = mm_type(map, eff);
+		run = emitRun(map, eff, type);
+		if (source && type == MM_CODE1) {
+			M6809_decode(e->mod, eff, &decoded);
+			if (isPCRelative(decoded.mode)) {
+				if (c->refs.top + 2 > c->refs.maxElements) {
+					IntStack bigger;
+					intstack_init(&bigger, c->refs.maxElements * 2);
+					memcpy(bigger.storage, c->refs.storage, sizeof(unsigned) * c->refs.top);
+					bigger.top = c->refs.top;
+					intstack_destroy(&c->refs);
+					c->refs = bigger;
+				}
+				intstack_push(&c->refs, eff);
+				intstack_push(&c->refs, decoded.eff);
+			}
+		}
+		if (c->lineCount == c->lineMax) {
+			c->lineMax *= 2;
+			c->lines = (LineList *)realloc(c->lines, sizeof(LineList) * c->lineMax);
+			if (c->lines == NULL) {
+				fprintf(stderr, "ERROR: layoutChunk: Insufficient memory for line list.\n");
+				exit(1);
+			}
+		}
+		++c->lineCount;
+		c->lines[c->lineCount-1].lineNumner = c->lineCount;
+		c->lines[c->lineCount-1].startOffset = eff;
+		c->lines[c->lineCount-1].endOffset = eff + run - 1;
+		eff += run;
+	}
+}
+
+// Serially label PC relative destinations in output order
+static void resolveLabels(Emission *e) {
+	MemoryMap *map = e->map;
+	int i, k, at, dest;
+
+	labelFrom = (int *)malloc(sizeof(int) * map->maxElements);
+	if (labelFrom == NULL) {
+		fprintf(stderr, "ERROR: resolveLabels: Insufficient memory for label map.\n");
+		exit(1);
+	}
+	memset(labelFrom, 0xFF, sizeof(int) * map->maxElements);
+	for (i = 0; i < e->chunkCount; i++) {
+		IntStack *refs = &e->chunks[i].refs;
+		for (k = 0; k < refs->top; k += 2) {
+			at = refs->storage[k];
+			dest = refs->storage[k+1];
+			if (dest >= 0 && dest < map->maxElements && !mm_isLabel(map, dest)) {
+				// Destination was not previously declared a label
+				mm_setLabel(map, dest, 1);
+				labelFrom[dest] = at;
+			}
+		}
+	}
+}
+
+// Pass 2: format the runs in a chunk
+static void formatChunk(int task, void *arg) {
+	Emission *e = (Emission *)arg;
+	Chunk *c = &e->chunks[task];
+	MemoryFile *mod = e->mod;
+	MemoryMap *map = e->map;
+	OutBuf *out = &c->out;
+	char operands[256];	// Disassembly operand buffer
+	Decoded decoded;
+	int run, length, type, at;
+	int eff, effWord;
+	int textLine = 0;	// Chunk relative
+	size_t mark;
+	char *postLabel = NULL;
+
+	ob_init(out, (c->end - c->start) * 24);
+	*comment = '\0';
+	for (at = 0; at < c->lineCount; at++) {
+		c->lines[at].firstLine = textLine + 1;
+		mark = out->length;
+		eff = c->lines[at].startOffset;
+		run = c->lines[at].endOffset - eff + 1;
+		type = mm_type(map, eff);
+		if (labelVisible(map, eff, eff)) {
+			if (source) {
+				ob_puts(out, M6809_label(map, eff));
+			} else {
+				// Display a generic string for all labels if diff
+				ob_puts(out, "LABEL");
+			}
+		}
+		switch (type) {
+			case MM_UNKNOWN:
+			case MM_FCB:
+				// Get the run length, crop to 8
+				dumpManyBytes(out, "FCB", mod, eff, run);
+				break;
+			case MM_FCC:
+				// Output as-is
+				ob_puts(out, " FCC");
+				dumpString(out, mod, eff, run);
+				break;
+			case INVALID:
+				// Get the run length, crop to 8
+				dumpManyBytes(out, "???", mod, eff,run);
+				break;
+			case MM_FDB:
+				// Get the run length, crop to 8
+				length = run & 0x01;
+				dumpManyPairs(out, "FDB", mod, eff, run - length);
+				// If there's an extra byte at the end, handle it
+				if (length) {
+					ob_puts(out, " FCB");
+					dumpBytes(out, mod, eff + run - length, 1);
+				}
+				break;
+            case MM_FDB_JTEXT:
+                // NOTE: Assumes run is 2
+                effWord = mf_get_word(mod, eff);
+                postLabel = tableLabel(map, effWord - mod->abs_base, eff);
+                ob_printf(out, " FDB $%04X", effWord);
+                if (source && postLabel) appendComment(postLabel);
+                eol(out);
+                break;
+            case MM_FDB_JTPIC:
+                // NOTE: Assumes run is 2
+                effWord = mf_get_word(mod, eff);
+                postLabel = tableLabel(map, (effWord + eff) & 0xFFFF, eff);
+                ob_printf(out, " FDB $%04X", effWord);
+                if (source && postLabel) appendComment(postLabel);
+                eol(out);
+                break;
+            case MM_FDB_JTREL:
+                // TODO: Format these specially
+                dumpManyPairs(out, "FDB", mod, eff, run);
+                break;
+			case MM_FCS:
+				// Output as-is
+				ob_puts(out, " FCS");
+				dumpString(out, mod, eff, run);
+				break;
+			case MM_CODE1:
+				// Output as-is
+				if (ioflag)
+				{
+					char *io = CoCo3_ioNameCode(mod, eff);
+					if (*io)
+					{
+						int cl = strlen(comment);
+						sprintf(comment+cl, " IOREF 0x%04X: %s", eff, io);
+					}
+				}
+				M6809_decode(mod, eff, &decoded);
+				decoded.newLabel = (labelFrom != NULL) && isPCRelative(decoded.mode) &&
+					decoded.eff >= 0 && decoded.eff < map->maxElements &&
+					labelFrom[decoded.eff] == eff;
+				ob_printf(out, " %s %s", M6809_mnemonic(mod, &decoded), M6809_formatOperands(operands, &decoded, mod, map));
+				eol(out);
+				break;
+			default:
+				// Output as a single FCB
+				ob_puts(out, " FCB");
+				dumpBytes(out, mod, eff, run);
+				break;
+		}
+		// Track output text lines for the index
+		for (; mark < out->length; mark++) {
+			if (out->storage[mark] == '\n') ++textLine;
+		}
+		c->lines[at].lastLine = textLine;
+	}
+}
+
+void disassemble(MemoryFile *mod, MemoryMap *map, int jobs, OutBuf *out) {
+	Emission e;
+	int i, at, count, size, eff, emitting;
+	int textLine = 0;
+
+	// Split the map into chunks at run boundaries
+	count = map->maxElements / CHUNK_MIN;
+	if (count > jobs * 4) count = jobs * 4;
+	if (count < 1 || jobs <= 1) count = 1;
+	size = (map->maxElements + count - 1) / count;
+	e.mod = mod;
+	e.map = map;
+	e.chunks = (Chunk *)calloc(count, sizeof(Chunk));
+	if (e.chunks == NULL) {
+		fprintf(stderr, "ERROR: disassemble: Insufficient memory for chunks.\n");
+		exit(1);
+	}
+	e.chunkCount = 0;
+	eff = 0;
+	for (i = 0; i < count && eff < map->maxElements; i++) {
+		e.chunks[i].start = eff;
+		eff += size;
+		while (eff < map->maxElements && !mm_isRunStart(map, eff)) ++eff;
+		if (eff > map->maxElements) eff = map->maxElements;
+		e.chunks[i].end = eff;
+		++e.chunkCount;
+	}
+	if (e.chunkCount) e.chunks[e.chunkCount-1].end = map->maxElements;
+
+	M6809_buildRegTables();	// Before any threads start
+	emitting = rs_end(RS_EMIT);	// Label resolution is timed apart
+	rs_begin(RS_LABELS);
+	tp_run(jobs, e.chunkCount, layoutChunk, &e);
+	if (source) resolveLabels(&e);
+	rs_end(RS_LABELS);
+	if (emitting) rs_begin(RS_EMIT);
+	tp_run(jobs, e.chunkCount, formatChunk, &e);
+
+	// Write the chunks in order and stitch the line cross reference
+	li_init(&lineIndex, map->maxElements / 2);
+	lineIndex.base = mod->abs_base;
+	if (out) {
+		// Line numbers follow anything already written
+		for (i = 0; i < (int)out->length; i++) {
+			if (out->storage[i] == '\n') ++textLine;
+		}
+	}
+	for (i = 0; i < e.chunkCount; i++) {
+		Chunk *c = &e.chunks[i];
+		if (out) ob_write(out, c->out.storage, c->out.length);
+		else ob_flush(&c->out, stdout);
+		for (at = 0; at < c->lineCount; at++) {
+			c->lines[at].lineNumner = lineIndex.top + 1;
+			c->lines[at].firstLine += textLine;
+			c->lines[at].lastLine += textLine;
+			li_push(&lineIndex, &c->lines[at]);
+		}
+		if (c->lineCount) textLine = c->lines[c->lineCount-1].lastLine;
+		ob_destroy(&c->out);
+		intstack_destroy(&c->refs);
+		free(c->lines);
+	}
+	free(e.chunks);
+	if (labelFrom) {
+		free(labelFrom);
+		labelFrom = NULL;
+	}
+}
+
+void dumpLines(OutBuf *out) {
+	int at;
+	LineList *line;
+	ob_printf(out, "\nLine Cross Reference:\n");
+	ob_printf(out, "Line   Addr  Bytes\n");
+	ob_printf(out, "------ ----- -----\n");
+	for (at=0; at<lineIndex.top; at++) {
+		line = &lineIndex.storage[at];
+		ob_printf(out, "%5d: $%04X (%d)\n", line->lineNumner, line->startOffset, line->endOffset - line->startOffset + 1);
+	}
+}
@@ -0,0 +1,28 @@
+/*
+ * emitter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef EMITTER_H_
+#define EMITTER_H_
+
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "lineindex.h"
+#include "outbuf.h"
+
+extern LineIndex lineIndex;	// Output lines and byte ranges, filled by disassemble
+
+// Append text to the comment for the line being emitted
+void appendComment(char* text);
+
+// Disassemble the mapped module to out (stdout if NULL), in parallel
+// chunks if jobs > 1
+void disassemble(MemoryFile *mod, MemoryMap *map, int jobs, OutBuf *out);
+
+// Append the line cross reference built by disassemble to out
+void dumpLines(OutBuf *out);
+
+#endif /* EMITTER_H_ */
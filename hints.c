@@ -0,0 +1,262 @@
+/*
+ * hints.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "jumptable.h"
+#include "hints.h"
+#include "provenance.h"
+
+#define STRMAX 4096
+
+extern int _debug;		// Non-zero to print debug information
+
+enum { HINT_BYTE, HINT_WORD, HINT_CHAR, HINT_TABLE, HINT_LABEL };
+
+typedef struct Hint {
+  int kind;
+  unsigned start, end;	// Runtime addresses, or offsets
+  int offsets;			// Non-zero if start and end are offsets
+  int table;			// MAPTYPE_* for HINT_TABLE
+  char *name;			// For HINT_LABEL, or NULL
+} Hint;
+
+typedef struct Name {
+  int offset;
+  char *name;
+} Name;
+
+static Hint *hints = NULL;
+static int hintCount = 0, hintMax = 0;
+static Name *names = NULL;
+static int nameCount = 0;
+static unsigned long long hash = 14695981039346656037ULL;
+
+// f9dasm info directives with nothing to do here
+static const char *ignored[] = {
+	"comment", "lcomment", "insert", "prepend", "prepcmt", "cmt", "option", "file",
+	"include", "end", "setdp", "unlabel", "phase", "rmb", "const", "used", "unused",
+	"remap", "force", "patch", "patchw", "relative", NULL
+};
+
+static void keep(int kind, unsigned start, unsigned end, int table, char *name, int offsets) {
+	if (hintCount == hintMax) {
+		hintMax = hintMax ? hintMax * 2 : 256;
+		hints = (Hint *)realloc(hints, sizeof(Hint) * hintMax);
+		if (hints == NULL) {
+			fprintf(stderr, "ERROR: hints_read: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	hints[hintCount].kind = kind;
+	hints[hintCount].start = start;
+	hints[hintCount].end = end;
+	hints[hintCount].table = table;
+	hints[hintCount].name = name;
+	hints[hintCount].offsets = offsets;
+	++hintCount;
+}
+
+// Parse a hex address with an optional 0x or $ prefix; return what follows
+static char* parseAddr(char *p, unsigned *addr) {
+	char *end;
+	while (isspace((unsigned char)*p)) ++p;
+	if (*p == '$') ++p;
+	else if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+	if (!isxdigit((unsigned char)*p)) return NULL;
+	*addr = strtoul(p, &end, 16);
+	return end;
+}
+
+// Parse "xxxx[-yyyy]"; return what follows
+static char* parseRange(char *p, unsigned *start, unsigned *end) {
+	if ((p = parseAddr(p, start)) == NULL) return NULL;
+	*end = *start;
+	if (*p == '-') p = parseAddr(p + 1, end);
+	if (p && *end < *start) return NULL;
+	return p;
+}
+
+void hints_read(char *fileName, IntStack *exec, IntStack *notCode, unsigned base) {
+	char line[STRMAX], word[32], *p, *q;
+	unsigned start, end, shift = 0;
+	int lineNo = 0, table, i, offsets = 0;
+	unsigned codeEnd = -2;
+	FILE *fp;
+
+	if ((fp = fopen(fileName, "r")) == NULL) {
+		fprintf(stderr, "ERROR: hints_read: Can't open hint file '%s'\n", fileName);
+		exit(1);
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		++lineNo;
+		for (p = line; *p; p++) hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+		if ((p = strchr(line, ';'))) *p = '\0';
+		p = line;
+		while (isspace((unsigned char)*p)) ++p;
+		if (*p == '#' || *p == '*') {
+			// offsets and addresses may be hidden from f9dasm in a comment
+			for (++p; isspace((unsigned char)*p); ++p);
+			for (q = p + strlen(p); q > p && isspace((unsigned char)q[-1]); --q);
+			if (q - p == 7 && !strncasecmp(p, "offsets", 7)) offsets = 1;
+			else if (q - p == 9 && !strncasecmp(p, "addresses", 9)) offsets = 0;
+			shift = offsets ? base : 0;
+			continue;
+		}
+		if (*p == '\0') continue;
+		for (i = 0; *p && !isspace((unsigned char)*p) && i < (int)sizeof(word) - 1; )
+			word[i++] = tolower((unsigned char)*p++);
+		word[i] = '\0';
+
+		if (!strcmp(word, "offsets") || !strcmp(word, "addresses")) {
+			offsets = word[0] == 'o';
+			shift = offsets ? base : 0;
+		} else if (!strcmp(word, "exec")) {
+			while ((q = parseAddr(p, &start))) {
+				intstack_push(exec, start + shift);
+				p = q;
+			}
+		} else if (!strcmp(word, "code")) {
+			// Trace from the start of each block of contiguous ranges
+			// (f9dasm info files have one line per instruction)
+			if ((p = parseRange(p, &start, &end))) {
+				if (start != codeEnd + 1) intstack_push(exec, start + shift);
+				codeEnd = end;
+			}
+		} else if (!strcmp(word, "notcode")) {
+			if ((p = parseRange(p, &start, &end))) {
+				intstack_push(notCode, start + shift);
+				intstack_push(notCode, end + shift);
+			}
+		} else if (!strcmp(word, "byte") || !strcmp(word, "data") || !strcmp(word, "hex") ||
+				!strcmp(word, "bin") || !strcmp(word, "dec")) {
+			if ((p = parseRange(p, &start, &end))) keep(HINT_BYTE, start, end, 0, NULL, offsets);
+		} else if (!strcmp(word, "word") || !strcmp(word, "dvec")) {
+			if ((p = parseRange(p, &start, &end))) keep(HINT_WORD, start, end, 0, NULL, offsets);
+		} else if (!strcmp(word, "char") || !strcmp(word, "text") || !strcmp(word, "string")) {
+			if ((p = parseRange(p, &start, &end))) keep(HINT_CHAR, start, end, 0, NULL, offsets);
+		} else if (!strcmp(word, "cvec") || !strcmp(word, "rvec") || !strcmp(word, "table")) {
+			table = word[0] == 'c' ? MAPTYPE_EXT : MAPTYPE_PIC;
+			if (word[0] == 't') {
+				while (isspace((unsigned char)*p)) ++p;
+				if (!strncasecmp(p, "ext", 3)) table = MAPTYPE_EXT;
+				else if (!strncasecmp(p, "pic", 3)) table = MAPTYPE_PIC;
+				else if (!strncasecmp(p, "rel", 3)) table = MAPTYPE_REL;
+				else if (!strncasecmp(p, "lbra", 4)) table = MAPTYPE_LBR;
+				else p = NULL;
+				if (p) p += table == MAPTYPE_LBR ? 4 : 3;
+			}
+			if (p && (p = parseRange(p, &start, &end))) keep(HINT_TABLE, start, end, table, NULL, offsets);
+		} else if (!strcmp(word, "label")) {
+			if ((p = parseAddr(p, &start))) {
+				char *name = NULL;
+				while (isspace((unsigned char)*p)) ++p;
+				for (q = p; *q && !isspace((unsigned char)*q); q++);
+				if (q > p) {
+					*q = '\0';
+					name = strdup(p);
+				}
+				keep(HINT_LABEL, start, start, 0, name, offsets);
+			}
+		} else {
+			for (i = 0; ignored[i] && strcmp(word, ignored[i]); i++);
+			if (ignored[i] == NULL) {
+				fprintf(stderr, "ERROR: hints_read: %s:%d: Unknown directive '%s'\n", fileName, lineNo, word);
+				exit(1);
+			}
+			continue;
+		}
+		if (p == NULL) {
+			fprintf(stderr, "ERROR: hints_read: %s:%d: Bad address or range\n", fileName, lineNo);
+			exit(1);
+		}
+	}
+	fclose(fp);
+	if (_debug) printf("hints_read: %d hints kept from '%s'\n", hintCount, fileName);
+}
+
+unsigned long long hints_hash() {
+	return hash;
+}
+
+static int byOffset(const void *a, const void *b) {
+	return ((Name *)a)->offset - ((Name *)b)->offset;
+}
+
+void hints_apply(MemoryFile *mod, MemoryMap *map) {
+	Hint *h;
+	int start, end, i, applied = 0;
+	unsigned base;
+
+	nameCount = 0;
+	if (pv_enabled) pv_cause(PV_HINT, -1);
+	if (hintCount) names = (Name *)realloc(names, sizeof(Name) * hintCount);
+	for (i = 0; i < hintCount; i++) {
+		h = &hints[i];
+		base = h->offsets ? 0 : mod->abs_base;
+		start = (h->start - base) & 0xFFFF;
+		end = (h->end - base) & 0xFFFF;
+		if (start >= mod->length || end >= mod->length || end < start) {
+			if (_debug) printf("hints_apply: $%04X-$%04X is outside the module\n", h->start, h->end);
+			continue;
+		}
+		++applied;
+		switch (h->kind) {
+			case HINT_BYTE:
+				mm_set(map, start, MM_FCB, end - start + 1);
+				break;
+			case HINT_WORD:
+				mm_setFDB(map, start, end - start + 1);
+				break;
+			case HINT_CHAR:
+				// OS9 strings end with the top bit set
+				if (mod->storage[end] & 0x80)
+					mm_setString(map, start, end - start + 1);
+				else
+					mm_set(map, start, MM_FCC, end - start + 1);
+				break;
+			case HINT_TABLE:
+				switch (h->table) {
+					case MAPTYPE_EXT: jt_extended(mod, start, end); break;
+					case MAPTYPE_PIC: jt_pic(mod, start, end); break;
+					case MAPTYPE_REL: jt_pic_relative(mod, start, end); break;
+					case MAPTYPE_LBR: jt_lbra(mod, start, end); break;
+				}
+				break;
+			case HINT_LABEL:
+				mm_setLabel(map, start, 1);
+				if (h->name) {
+					names[nameCount].offset = start;
+					names[nameCount].name = h->name;
+					++nameCount;
+				}
+				break;
+		}
+	}
+	if (hintCount && !applied)
+		fprintf(stderr, "WARNING: hints_apply: Every hint is outside the module at $%04X-$%04X\n",
+			mod->abs_base, mod->abs_base + mod->length - 1);
+	if (nameCount) qsort(names, nameCount, sizeof(Name), byOffset);
+}
+
+char* hints_name(int offset) {
+	int lo = 0, hi = nameCount - 1, mid;
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (names[mid].offset == offset) return names[mid].name;
+		if (names[mid].offset < offset) lo = mid + 1;
+		else hi = mid - 1;
+	}
+	return NULL;
+}
@@ -0,0 +1,54 @@
+/*
+ * hints.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef HINTS_H_
+#define HINTS_H_
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+
+// A hint file has one directive per line. Addresses are hex runtime
+// addresses (as for --exec), optionally with a 0x or $ prefix; # or *
+// starts a comment line and ; a trailing comment.
+//
+//   offsets                   Addresses that follow are offsets into the
+//                             image (as --f9info writes them)
+//   addresses                 Addresses that follow are runtime addresses
+//   exec xxxx [xxxx...]       Trace from here
+//   code xxxx[-yyyy]          Trace from xxxx
+//   notcode xxxx[-yyyy]       Never trace as code
+//   byte xxxx[-yyyy]          FCB data (also data, hex, bin, dec)
+//   word xxxx[-yyyy]          FDB data (also dvec)
+//   char xxxx[-yyyy]          String (also text, string)
+//   table ext|pic|rel|lbra xxxx-yyyy
+//                             Jump table of absolute addresses, PC relative
+//                             addresses, addresses relative to the table,
+//                             or LBRA instructions (cvec is table ext,
+//                             rvec is table pic)
+//   label xxxx [name]         Label, with the name to use for it
+//
+// Keywords are not case sensitive, so f9dasm info files (such as --f9info
+// writes) can be read too; their other directives are ignored. So that
+// f9dasm can read the file as well, offsets and addresses may also be
+// written as a comment line of their own ("* offsets").
+
+// Read a hint file in one pass. Exec addresses and notcode ranges (start,
+// end pairs) are pushed onto the stacks given, as runtime addresses for a
+// module at base; the rest is kept to apply.
+void hints_read(char *fileName, IntStack *exec, IntStack *notCode, unsigned base);
+
+// Hash of every hint file read, for keys that depend on the options
+unsigned long long hints_hash();
+
+// Apply the kept hints to a loaded module's map before tracing it
+void hints_apply(MemoryFile *mod, MemoryMap *map);
+
+// Name a hint gave the label at an offset, or NULL
+char* hints_name(int offset);
+
+#endif /* HINTS_H_ */
@@ -0,0 +1,67 @@
+/*
+ * hunks.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lineindex.h"
+#include "diffdasm.h"
+#include "hunks.h"
+
+#define STRMAX 4096
+
+// Parse "start[,count]" (count defaults to one); return what follows
+static char* parseRange(char *p, int *start, int *count) {
+	char *end;
+	*start = strtol(p, &end, 10);
+	if (end == p) return NULL;
+	*count = 1;
+	if (*end == ',') {
+		p = end + 1;
+		*count = strtol(p, &end, 10);
+		if (end == p) return NULL;
+	}
+	return end;
+}
+
+int hunks_main(int argc, char **argv) {
+	LineIndex before, after;
+	char line[STRMAX], from[32], to[32];
+	int a, b, c, d;
+	char *p;
+	FILE *fp = stdin;
+
+	if (argc < 3) {
+		fprintf(stderr, "ERROR: hunks requires two index files\n");
+		usage();
+	}
+	li_init(&before, 0);
+	li_init(&after, 0);
+	li_read(&before, argv[1]);
+	li_read(&after, argv[2]);
+	if (argc > 3 && strcmp(argv[3], "-")) {
+		fp = fopen(argv[3], "r");
+		if (fp == NULL) {
+			fprintf(stderr, "ERROR: hunks: Can't open diff '%s'\n", argv[3]);
+			exit(1);
+		}
+	}
+	while (fgets(line, STRMAX, fp)) {
+		if (strncmp(line, "@@ -", 4)) continue;
+		p = parseRange(line + 4, &a, &b);
+		if (p == NULL || strncmp(p, " +", 2) || parseRange(p + 2, &c, &d) == NULL) {
+			fprintf(stderr, "ERROR: hunks: Can't parse hunk header: %s", line);
+			continue;
+		}
+		printf("-%d,%d %s +%d,%d %s\n", a, b, li_describe(from, &before, a, b), c, d, li_describe(to, &after, c, d));
+	}
+	if (fp != stdin) fclose(fp);
+	li_destroy(&before);
+	li_destroy(&after);
+	return 0;
+}
@@ -0,0 +1,16 @@
+/*
+ * hunks.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef HUNKS_H_
+#define HUNKS_H_
+
+// "diffdasm hunks <old index> <new index> [<diff>]"
+// Map each hunk of a unified diff between two disassemblies back to
+// module address ranges, using the --index sidecars of both.
+int hunks_main(int argc, char **argv);
+
+#endif /* HUNKS_H_ */
@@ -28,6 +28,10 @@ void intstack_init(IntStack *s, int maxElements) {
   s->top = 0;
   s->maxElements = maxElements;
   s->storage = storage;
+  s->peak = 0;
+  s->pushes = 0;
+  s->duplicates = 0;
+  s->seen = NULL;
 }
 
 int intstack_isEmpty(IntStack *s) {
@@ -45,6 +49,19 @@ void intstack_push(IntStack *s, unsigned elem) {
     exit(1);
   }
   (s->storage)[s->top++] = elem;
+  ++s->pushes;
+  if (s->top > s->peak) s->peak = s->top;
+  if (s->seen && elem < 65536) {
+    if (s->seen[elem]) ++s->duplicates;
+    else s->seen[elem] = 1;
+  }
+}
+
+void intstack_track(IntStack *s) {
+  if (s->seen == NULL && (s->seen = (unsigned char *)calloc(65536, 1)) == NULL) {
+    fprintf(stderr, "Insufficient memory to track stack.\n");
+    exit(1);
+  }
 }
 
 unsigned intstack_pop(IntStack *s) {
@@ -76,6 +93,10 @@ void intstack_destroy(IntStack *s) {
         free(s->storage);
         s->top = 0;
     }
+    if (s && s->seen) {
+        free(s->seen);
+        s->seen = NULL;
+    }
 }
 
 void intstack_dump(IntStack *s, char *label) {
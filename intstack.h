@@ -14,6 +14,10 @@ typedef struct IntStack {
   int top;              // Next available for storage
   unsigned *storage;
   int maxElements;
+  int peak;             // Greatest depth reached
+  long pushes;          // Elements pushed
+  long duplicates;      // Pushes of values pushed before (if tracked)
+  unsigned char *seen;  // Values below 65536 pushed so far, if tracked
 } IntStack;
 
 /* Function for initializing the Stack */
@@ -39,6 +43,9 @@ unsigned intstack_top(IntStack *s);
 /* Returns the element at a specified depth without removing it from stack */
 unsigned intstack_probe(IntStack *s, int fromTop);
 
+/* Count pushes of values already pushed (below 65536) as duplicates */
+void intstack_track(IntStack *s);
+
 /* Deallocates the memory allocated to stack */
 void intstack_destroy(IntStack *s);
 
@@ -15,11 +15,14 @@
 #include "intstack.h"
 #include "memoryfile.h"
 #include "memorymap.h"
+#include "stats6809.h"
 
 #include "jumptable.h"
+#include "provenance.h"
 
 extern MemoryMap map;
 extern IntStack addrStack;	// Stack of known-good execution addresses
+extern IntStack tableStack;	// Jump tables found (start, end, type)
 extern int _debug;		// Non-zero to print debug information
 
 extern void usage();
@@ -33,6 +36,10 @@ void jt_worker(MemoryFile *mod, unsigned start, unsigned end, int mapType) {
     if (end < 0 || end >= mod->length) return;
 
     mm_setLabel(&map, start, 1);
+    intstack_push(&tableStack, start);
+    intstack_push(&tableStack, end);
+    intstack_push(&tableStack, mapType);
+    if (pv_enabled) pv_table(start, end);
     
     count = (end - start) / 2 + 1;
     if (_debug) printf("jumptable: Processing %d entries at $%04X...\n", count, start + mod->abs_base);
@@ -58,11 +65,13 @@ void jt_worker(MemoryFile *mod, unsigned start, unsigned end, int mapType) {
             effectiveAddr &= 0xFFFF;
             if (_debug) printf("jumptable: Known address [$%04X] = $%04X\n", at + mod->abs_base, effectiveAddr + mod->abs_base);
             intstack_push(&addrStack, effectiveAddr);
+            if (pv_enabled) pv_push(effectiveAddr, PV_JUMPTABLE, start);
             mm_setjtFDB(&map, at, 2, mapType);
             at += 2;
             --count;
         }
     }
+    if (pv_enabled) pv_tableEnd();
 }
 
 /* Process jumptable of EXTENDED (absolute) addresses */
@@ -89,6 +98,10 @@ void jt_lbra(MemoryFile *mod, unsigned start, unsigned end) {
     if (end < 0 || end >= mod->length) return;
 
     mm_setLabel(&map, start, 1);
+    intstack_push(&tableStack, start);
+    intstack_push(&tableStack, end);
+    intstack_push(&tableStack, MAPTYPE_LBR);
+    if (pv_enabled) pv_table(start, end);
     
     /* Every THIRD delta in the range is the start of a 3-byte (offset by 1) table entry */
     count = (end - start) / 3 + 1;
@@ -102,9 +115,245 @@ void jt_lbra(MemoryFile *mod, unsigned start, unsigned end) {
             effectiveAddr = (address + at + 2) & 0xFFFF;
             if (_debug) printf("jt_lbra: Known address [$%04X] = $%04X\n", at + mod->abs_base, effectiveAddr + mod->abs_base);
             intstack_push(&addrStack, effectiveAddr);
+            if (pv_enabled) pv_push(effectiveAddr, PV_JUMPTABLE, start);
             mm_setCode(&map, at-1, 3);
             at += 3;
             --count;
         }
     }
+    if (pv_enabled) pv_tableEnd();
+}
+
+//
+// Dispatch idioms (--jump-tables). Each traced instruction is checked
+// once, in address order, while what the index registers and D hold is
+// followed along straight-line code:
+//
+//  LEAX table,PCR / LDD B,X / JMP D,X	offsets from the table (jt_pic_relative)
+//  LEAX table,PCR / ABX / LDD ,X / JMP D,X	offsets from each entry (jt_pic)
+//  LDY #table / LDX B,Y / JMP ,X	addresses (jt_extended)
+//  LEAX table,PCR / JMP [B,X]		addresses (jt_extended)
+//  LEAX table,PCR / JMP B,X		LBRA instructions (jt_lbra)
+//
+// The entries are counted from a CMPr #n and the conditional branch
+// after it, or an ANDr #mask, before the dispatch; if the index was
+// shifted or multiplied after that it counts entries, otherwise bytes.
+// Without a bound, up to JT_GUESS entries are taken. Either way the
+// table ends at the first entry that's already mapped or leads out of
+// the image.
+//
+
+#define JT_GUESS 16		// Entries taken without a bound
+#define JT_MAX 256		// Entries taken with one
+
+enum { JT_NONE, JT_BASE, JT_ENTRY, JT_ABS, JT_REL, JT_PIC };
+
+typedef struct JtReg {
+	int kind;		// JT_BASE: the table; JT_ENTRY: an entry of it;
+	int table;		// JT_ABS, JT_REL, JT_PIC: a word read from it
+} JtReg;
+
+static unsigned char *checked = NULL;	// Instructions already checked
+
+void jt_reset() {
+	free(checked);
+	checked = NULL;
+}
+
+// 0 to 2 for X, Y, U from the last letter of a mnemonic, 3 for D, or -1
+static int jt_register(char *mnemonic, char *prefix) {
+	int n = strlen(prefix);
+	if (strncmp(mnemonic, prefix, n) || strlen(mnemonic) != (size_t)n + 1) return -1;
+	switch (mnemonic[n]) {
+		case 'X': return 0;
+		case 'Y': return 1;
+		case 'U': return 2;
+		case 'D': return 3;
+		default: return -1;
+	}
+}
+
+static int isAccOffset(int mode) {
+	return mode == OFFSET_A || mode == OFFSET_B || mode == OFFSET_D;
+}
+
+// Indexed modes that step their base register
+static int isAutoIndex(int mode) {
+	return mode == POSTINC_1 || mode == POSTINC_2 || mode == PREDEC_1 || mode == PREDEC_2
+		|| mode == IPOSTINC_2 || mode == IPREDEC_2;
+}
+
+// Subroutines and system calls may change any register
+static int isCall(char *mnemonic) {
+	return !strcmp(mnemonic, "JSR") || !strcmp(mnemonic, "BSR") || !strcmp(mnemonic, "LBSR")
+		|| !strncmp(mnemonic, "SWI", 3);
+}
+
+// Anything that might write A or B, and so D; stores, compares and tests don't
+static int writesD(char *mnemonic) {
+	char last = mnemonic[strlen(mnemonic) - 1];
+	if (!strcmp(mnemonic, "DAA") || !strcmp(mnemonic, "MUL") || !strncmp(mnemonic, "SEX", 3)
+			|| !strcmp(mnemonic, "LDQ") || !strcmp(mnemonic, "DIVQ")) return 1;
+	if (last != 'A' && last != 'B' && last != 'D') return 0;
+	return strncmp(mnemonic, "ST", 2) && strncmp(mnemonic, "CMP", 3) && strncmp(mnemonic, "BIT", 3)
+		&& strncmp(mnemonic, "TST", 3);
+}
+
+static int isInclusive(char *branch) {
+	if (*branch == 'L') ++branch;
+	return !strcmp(branch, "BHI") || !strcmp(branch, "BLS") || !strcmp(branch, "BGT") || !strcmp(branch, "BLE");
+}
+
+static int isExclusive(char *branch) {
+	if (*branch == 'L') ++branch;
+	return !strcmp(branch, "BCC") || !strcmp(branch, "BCS") || !strcmp(branch, "BGE") || !strcmp(branch, "BLT");
+}
+
+// Entries of a table that are unmapped and lead into the image
+static int jt_entries(MemoryFile *mod, int table, int mapType, int count) {
+	int size = mapType == MAPTYPE_LBR ? 3 : 2;
+	int n, at, i, target, type;
+
+	for (n = 0; n < count; n++) {
+		at = table + n * size;
+		if (at + size > mod->length) break;
+		for (i = 0; i < size; i++)
+			if (mm_type(&map, at + i) != MM_UNKNOWN) return n;
+		switch (mapType) {
+			case MAPTYPE_EXT: target = mf_get_word(mod, at) - mod->abs_base; break;
+			case MAPTYPE_PIC: target = (mf_get_word(mod, at) + at) & 0xFFFF; break;
+			case MAPTYPE_REL: target = (mf_get_word(mod, at) + table) & 0xFFFF; break;
+			default:
+				if (mod->storage[at] != 0x16) return n;
+				target = (mf_get_word(mod, at + 1) + at + 3) & 0xFFFF;
+				break;
+		}
+		if (target < 0 || target >= mod->length) break;
+		// Where it leads must be able to be code
+		type = mm_type(&map, target);
+		if ((type != MM_UNKNOWN && type != MM_CODE1) || !(M6809_flags(mod, target) & HAS_6809)) break;
+	}
+	return n;
+}
+
+// The table a dispatch through r (or D and r) reads, and its map type
+static int jt_dispatch(Decoded *d, JtReg *reg, int *mapType) {
+	int r = (d->postbyte & IREG_MASK) >> 5;
+	if (r > 2) return -1;
+	switch (d->mode) {
+		case IOFFSET_A:
+		case IOFFSET_B:
+		case IOFFSET_D:
+			*mapType = MAPTYPE_EXT;
+			return reg[r].kind == JT_BASE ? reg[r].table : -1;
+		case IOFFSET_0:
+			*mapType = MAPTYPE_EXT;
+			return reg[r].kind == JT_ENTRY ? reg[r].table : -1;
+		case OFFSET_0:
+			*mapType = MAPTYPE_EXT;
+			return reg[r].kind == JT_ABS ? reg[r].table : -1;
+		case OFFSET_D:
+			if (reg[3].kind == JT_REL && reg[r].kind == JT_BASE && reg[3].table == reg[r].table) {
+				*mapType = MAPTYPE_REL;
+				return reg[r].table;
+			}
+			if (reg[3].kind == JT_PIC && reg[r].kind == JT_ENTRY && reg[3].table == reg[r].table) {
+				*mapType = MAPTYPE_PIC;
+				return reg[r].table;
+			}
+			// Fall through
+		case OFFSET_A:
+		case OFFSET_B:
+			*mapType = MAPTYPE_LBR;
+			return reg[r].kind == JT_BASE ? reg[r].table : -1;
+		default:
+			return -1;
+	}
+}
+
+int jt_find(MemoryFile *mod) {
+	Decoded d;
+	JtReg reg[4];		// X, Y, U, D
+	JtReg src;
+	char *m;
+	int offset = 0, end = -1, found = 0;
+	int r, s, compare = -1, bound = -1, scaled = 0, table, mapType, count;
+
+	if (checked == NULL) {
+		checked = (unsigned char *)calloc(mod->length, 1);
+		if (checked == NULL) {
+			fprintf(stderr, "ERROR: jt_find: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	while (offset < mod->length) {
+		if (mm_type(&map, offset) != MM_CODE1 || checked[offset]) {
+			++offset;
+			continue;
+		}
+		if (offset != end) {
+			memset(reg, 0, sizeof(reg));
+			compare = bound = -1;
+		}
+		checked[offset] = 1;
+		M6809_decode(mod, offset, &d);
+		end = offset + d.bytes;
+		m = d.inst->mnemonic;
+		s = (d.postbyte & IREG_MASK) >> 5;
+		src = s < 3 ? reg[s] : (JtReg){ JT_NONE, 0 };
+
+		// The bound on the index
+		if (compare >= 0 && isInclusive(m)) bound = compare, scaled = 0;
+		else if (compare >= 0 && isExclusive(m)) bound = compare - 1, scaled = 0;
+		compare = -1;
+		if ((!strcmp(m, "CMPA") || !strcmp(m, "CMPB") || !strcmp(m, "CMPD")) && (d.mode == IMMED_8 || d.mode == IMMED_16))
+			compare = d.value;
+		else if ((!strcmp(m, "ANDA") || !strcmp(m, "ANDB")) && d.mode == IMMED_8) bound = d.value, scaled = 0;
+		else if (bound >= 0 && (!strncmp(m, "ASL", 3) || !strncmp(m, "LSL", 3) || !strcmp(m, "MUL"))) scaled = 1;
+
+		if ((!strcmp(m, "JMP") || !strcmp(m, "JSR")) && (table = jt_dispatch(&d, reg, &mapType)) >= 0) {
+			if (bound < 0) count = JT_GUESS;
+			else if (scaled) count = bound + 1;
+			else count = bound / (mapType == MAPTYPE_LBR ? 3 : 2) + 1;
+			if (count > JT_MAX) count = JT_MAX;
+			count = jt_entries(mod, table, mapType, count);
+			if (count >= (bound < 0 ? 2 : 1)) {
+				if (_debug) printf("jt_find: %s at $%04X dispatches through %d entries at $%04X\n",
+					m, offset + mod->abs_base, count, table + mod->abs_base);
+				if (pv_enabled) pv_cause(PV_DISPATCH, offset);
+				switch (mapType) {
+					case MAPTYPE_EXT: jt_extended(mod, table, table + 2 * count - 1); break;
+					case MAPTYPE_PIC: jt_pic(mod, table, table + 2 * count - 1); break;
+					case MAPTYPE_REL: jt_pic_relative(mod, table, table + 2 * count - 1); break;
+					default: jt_lbra(mod, table, table + 3 * count - 1); break;
+				}
+				++found;
+			}
+		}
+
+		// What the registers hold after the instruction
+		if ((r = jt_register(m, "LEA")) >= 0) {
+			reg[r].kind = JT_NONE;
+			if (d.mode == PCR_8 || d.mode == PCR_16) reg[r] = (JtReg){ JT_BASE, d.eff };
+			else if (isAccOffset(d.mode) && src.kind == JT_BASE) reg[r] = (JtReg){ JT_ENTRY, src.table };
+		} else if ((r = jt_register(m, "LD")) >= 0) {
+			reg[r].kind = JT_NONE;
+			if (d.mode == IMMED_16 && r < 3 && d.value - mod->abs_base >= 0 && d.value - mod->abs_base < mod->length)
+				reg[r] = (JtReg){ JT_BASE, d.value - mod->abs_base };
+			else if (isAccOffset(d.mode) && src.kind == JT_BASE) reg[r] = (JtReg){ r < 3 ? JT_ABS : JT_REL, src.table };
+			else if (d.mode == OFFSET_0 && src.kind == JT_ENTRY) reg[r] = (JtReg){ r < 3 ? JT_ABS : JT_PIC, src.table };
+		} else if (!strcmp(m, "ABX")) {
+			if (reg[0].kind == JT_BASE) reg[0].kind = JT_ENTRY;
+			else reg[0].kind = JT_NONE;
+		} else if (d.mode == REGISTER || d.mode == REG_PULL_S || d.mode == REG_PULL_U || isCall(m)) {
+			// TFR, EXG, PUL or a call might load any of them
+			memset(reg, 0, sizeof(reg));
+		} else if (!(d.flags & TRANSFER) && writesD(m)) {
+			reg[3].kind = JT_NONE;
+		}
+		if (s < 3 && isAutoIndex(d.mode)) reg[s].kind = JT_NONE;
+		if (d.flags & LEAF) end = -1;
+		offset += d.bytes;
+	}
+	return found;
 }
@@ -25,4 +25,12 @@ void jt_pic_relative(MemoryFile *mod, unsigned start, unsigned end);
 /* Process jumptable of LBRA instructions (e.g. in OS9 module) */
 void jt_lbra(MemoryFile *mod, unsigned start, unsigned end);
 
+/* Find tables that traced code dispatches through (JMP D,X after LDD B,X
+   from LEAX table,PCR, and the like), and process them with the handlers
+   above; checks each instruction once. Returns the tables found. */
+int jt_find(MemoryFile *mod);
+
+/* Forget the instructions checked, for a new image */
+void jt_reset();
+
 #endif /* JUMPTABLE_H_ */
@@ -0,0 +1,176 @@
+/*
+ * lineindex.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lineindex.h"
+
+// Sidecar layout (all values 32 bit little-endian):
+//   "DDIX", version, entry count, base address
+//   then per entry: start offset, end offset, first line, last line
+#define LI_MAGIC "DDIX"
+#define LI_VERSION 1
+
+void li_init(LineIndex *li, int maxElements) {
+	if (maxElements < 16) maxElements = 16;
+	li->storage = (LineList *)malloc(sizeof(LineList) * maxElements);
+	if (li->storage == NULL) {
+		fprintf(stderr, "ERROR: li_init: Insufficient memory for line index.\n");
+		exit(1);
+	}
+	li->top = 0;
+	li->maxElements = maxElements;
+	li->base = 0;
+}
+
+void li_push(LineIndex *li, LineList *entry) {
+	if (li->top == li->maxElements) {
+		li->maxElements *= 2;
+		li->storage = (LineList *)realloc(li->storage, sizeof(LineList) * li->maxElements);
+		if (li->storage == NULL) {
+			fprintf(stderr, "ERROR: li_push: Insufficient memory for line index.\n");
+			exit(1);
+		}
+	}
+	li->storage[li->top++] = *entry;
+}
+
+LineList* li_findLine(LineIndex *li, int line) {
+	int lo = 0, hi = li->top - 1, mid;
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (line < li->storage[mid].firstLine) hi = mid - 1;
+		else if (line > li->storage[mid].lastLine) lo = mid + 1;
+		else return &li->storage[mid];
+	}
+	return NULL;
+}
+
+LineList* li_findOffset(LineIndex *li, int offset) {
+	int lo = 0, hi = li->top - 1, mid;
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (offset < li->storage[mid].startOffset) hi = mid - 1;
+		else if (offset > li->storage[mid].endOffset) lo = mid + 1;
+		else return &li->storage[mid];
+	}
+	return NULL;
+}
+
+char* li_describe(char *buffer, LineIndex *li, int first, int count) {
+	LineList *a, *b;
+	int last = li->top ? li->storage[li->top-1].lastLine : 0;
+	if (count == 0) {
+		// Insertion / deletion point follows line first
+		if (first == 0) {
+			sprintf(buffer, "at $%04X", li->base & 0xFFFF);
+		} else if ((a = li_findLine(li, first))) {
+			sprintf(buffer, "at $%04X", (a->endOffset + 1 + li->base) & 0xFFFF);
+		} else {
+			strcpy(buffer, "cross reference");
+		}
+		return buffer;
+	}
+	if (first > last) {
+		// Diff output has a line cross reference after the disassembly
+		strcpy(buffer, "cross reference");
+		return buffer;
+	}
+	if (first + count - 1 > last) count = last - first + 1;
+	a = li_findLine(li, first);
+	b = li_findLine(li, first + count - 1);
+	if (a == NULL || b == NULL) {
+		strcpy(buffer, "?");
+	} else {
+		sprintf(buffer, "$%04X-$%04X", (a->startOffset + li->base) & 0xFFFF, (b->endOffset + li->base) & 0xFFFF);
+	}
+	return buffer;
+}
+
+static void put32(unsigned char *p, unsigned value) {
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+static unsigned get32(unsigned char *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+}
+
+int li_save(LineIndex *li, FILE *fp) {
+	unsigned char record[16];
+	int i;
+	memcpy(record, LI_MAGIC, 4);
+	put32(record+4, LI_VERSION);
+	put32(record+8, li->top);
+	put32(record+12, li->base);
+	if (fwrite(record, 1, 16, fp) != 16) return 0;
+	for (i = 0; i < li->top; i++) {
+		put32(record, li->storage[i].startOffset);
+		put32(record+4, li->storage[i].endOffset);
+		put32(record+8, li->storage[i].firstLine);
+		put32(record+12, li->storage[i].lastLine);
+		if (fwrite(record, 1, 16, fp) != 16) return 0;
+	}
+	return 1;
+}
+
+int li_load(LineIndex *li, FILE *fp) {
+	unsigned char record[16];
+	LineList entry;
+	int i, count;
+	if (fread(record, 1, 16, fp) != 16 || memcmp(record, LI_MAGIC, 4) || get32(record+4) != LI_VERSION) {
+		return 0;
+	}
+	count = get32(record+8);
+	li->top = 0;
+	li->base = get32(record+12);
+	for (i = 0; i < count; i++) {
+		if (fread(record, 1, 16, fp) != 16) return 0;
+		entry.lineNumner = i + 1;
+		entry.startOffset = get32(record);
+		entry.endOffset = get32(record+4);
+		entry.firstLine = get32(record+8);
+		entry.lastLine = get32(record+12);
+		li_push(li, &entry);
+	}
+	return 1;
+}
+
+void li_write(LineIndex *li, char *fileName) {
+	FILE *fp = fopen(fileName, "wb");
+	if (fp == NULL) {
+		fprintf(stderr, "ERROR: li_write: Can't create index file '%s'\n", fileName);
+		exit(1);
+	}
+	if (!li_save(li, fp) || fclose(fp)) {
+		fprintf(stderr, "ERROR: li_write: Error writing index file '%s'\n", fileName);
+		exit(1);
+	}
+}
+
+void li_read(LineIndex *li, char *fileName) {
+	FILE *fp = fopen(fileName, "rb");
+	if (fp == NULL) {
+		fprintf(stderr, "ERROR: li_read: Can't open index file '%s'\n", fileName);
+		exit(1);
+	}
+	if (!li_load(li, fp)) {
+		fprintf(stderr, "ERROR: li_read: '%s' is not a valid diffdasm index file\n", fileName);
+		exit(1);
+	}
+	fclose(fp);
+}
+
+void li_destroy(LineIndex *li) {
+	free(li->storage);
+	li->storage = NULL;
+	li->top = li->maxElements = 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * lineindex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef LINEINDEX_H_
+#define LINEINDEX_H_
+
+#include <stdio.h>
+
+#include "linelist.h"
+
+// Growable list of output line / byte range entries, in output order
+// (so sorted by both line and offset)
+typedef struct LineIndex {
+  int top;              // Next available for storage
+  LineList *storage;
+  int maxElements;
+  unsigned base;        // Runtime address of offset zero
+} LineIndex;
+
+// Initialize an empty index
+void li_init(LineIndex *li, int maxElements);
+
+// Add an entry to the end of the index
+void li_push(LineIndex *li, LineList *entry);
+
+// Return the entry covering an output text line, or NULL
+LineList* li_findLine(LineIndex *li, int line);
+
+// Return the entry covering a module offset, or NULL
+LineList* li_findOffset(LineIndex *li, int offset);
+
+// Describe the module addresses for count output lines starting at
+// first (an insertion point after first if count is zero)
+char* li_describe(char *buffer, LineIndex *li, int first, int count);
+
+// Write the index in sidecar format to an open file; 0 on error
+int li_save(LineIndex *li, FILE *fp);
+
+// Replace the index with one in sidecar format from an open file; 0 on error
+int li_load(LineIndex *li, FILE *fp);
+
+// Write the index as a binary sidecar file
+void li_write(LineIndex *li, char *fileName);
+
+// Replace the index with one read from a binary sidecar file
+void li_read(LineIndex *li, char *fileName);
+
+// Release storage
+void li_destroy(LineIndex *li);
+
+#endif /* LINEINDEX_H_ */
@@ -12,6 +12,8 @@ typedef struct LineList {
   int lineNumner;
   int startOffset;
   int endOffset;
+  int firstLine;        // First line of output text for this range
+  int lastLine;         // Last line of output text for this range
 } LineList;
 
 #endif /* LINELIST_H_ */
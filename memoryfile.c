@@ -83,3 +83,9 @@ int mf_checksum(MemoryFile* file) {
 
 
 
+
+void mf_destroy(MemoryFile* file) {
+	free(file->storage);
+	file->storage = file->end = NULL;
+	file->length = 0;
+}
@@ -29,4 +29,6 @@ long mf_get_abs_dword(MemoryFile* file, int address);
 
 int mf_checksum(MemoryFile* file);
 
+void mf_destroy(MemoryFile* file);
+
 #endif /* MEMORYFILE_H_ */
@@ -9,8 +9,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
 
 #include "memorymap.h"
+#include "provenance.h"
 
 void mm_init(MemoryMap* map, int mapSize, char *id) {
 	// WARNING: id might be an ephemeral string; copy if needed
@@ -25,6 +28,12 @@ void mm_init(MemoryMap* map, int mapSize, char *id) {
 	map->maxElements = mapSize;
 	map->end = map->storage + mapSize - 1;
     map->abs_base = 0;
+	map->conflicts = 0;
+	map->logging = 0;
+	map->undo = NULL;
+	map->undoCount = map->undoMax = 0;
+	map->held = NULL;
+	map->heldLength = map->heldMax = 0;
 }
 
 void mm_set_base(MemoryMap* map, unsigned base) {
@@ -47,9 +56,50 @@ int mm_isLabel(MemoryMap* map, int offset) {
 	return 0;
 }
 
+static void logChange(MemoryMap* map, int offset) {
+	if (map->undoCount == map->undoMax) {
+		map->undoMax = map->undoMax ? map->undoMax * 2 : 4096;
+		map->undo = (MmUndo *)realloc(map->undo, sizeof(MmUndo) * map->undoMax);
+		if (map->undo == NULL) {
+			fprintf(stderr, "ERROR: mm_begin: Insufficient memory to log changes.\n");
+			exit(1);
+		}
+	}
+	map->undo[map->undoCount].offset = offset;
+	map->undo[map->undoCount++].old = map->storage[offset];
+}
+
+// Report a conflict; held while logging, so a rollback can drop it
+static void conflict(MemoryMap* map, const char *format, ...) {
+	char line[128];
+	va_list args;
+	int n;
+
+	++map->conflicts;
+	va_start(args, format);
+	n = vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	if (!map->logging) {
+		fputs(line, stderr);
+		return;
+	}
+	if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+	if (map->heldLength + n + 1 > map->heldMax) {
+		map->heldMax = map->heldMax ? map->heldMax * 2 : 4096;
+		map->held = (char *)realloc(map->held, map->heldMax);
+		if (map->held == NULL) {
+			fprintf(stderr, "ERROR: mm_begin: Insufficient memory to log changes.\n");
+			exit(1);
+		}
+	}
+	memcpy(map->held + map->heldLength, line, n + 1);
+	map->heldLength += n;
+}
+
 void mm_setType(MemoryMap* map, int offset, unsigned char type) {
     if (offset >= 0 && offset < map->maxElements) {
 		int labelFlag = map->storage[offset] & MM_LABEL;
+		if (map->logging) logChange(map, offset);
 		map->storage[offset] = type | labelFlag;
 	} else {
         fprintf(stderr, "ERROR: mm_setLabel: Offset '$%05X' out of range (%d elements)\n", offset, map->maxElements);
@@ -60,6 +110,8 @@ void mm_setType(MemoryMap* map, int offset, unsigned char type) {
 void mm_setLabel(MemoryMap* map, int offset, int value) {
     // It's OK to call this with an out-of range value; just do nothing.
     if (offset >= 0 && offset < map->maxElements) {
+        if (map->logging && ((map->storage[offset] & MM_LABEL) != 0) != (value != 0))
+            logChange(map, offset);
         if (value != 0) {
             map->storage[offset] |= MM_LABEL;
         }
@@ -75,6 +127,7 @@ void _mm_set(MemoryMap* map, int offset, unsigned char type_1, unsigned char typ
 		fprintf(stderr, "ERROR: _mm_set: Map offset '$%05x' is beyond the end of the map\n", offset+count);
         exit(1);
 	}
+	if (pv_enabled) pv_map(offset, count, type_1);
 	// Error if these bytes aren't all currently "unknown"
 	unsigned short i;
 	unsigned char v, t;
@@ -86,7 +139,7 @@ void _mm_set(MemoryMap* map, int offset, unsigned char type_1, unsigned char typ
 			t = type_1;
 		}
 		if (((v = mm_type(map, offset)) != MM_UNKNOWN) && (v != t)) {
-			fprintf(stderr, "ERROR: _mm_set: Map offset '$%04X' has two different data types (%c,%c); keeping %c\n", offset, t, v, v);
+			conflict(map, "ERROR: _mm_set: Map offset '$%04X' has two different data types (%c,%c); keeping %c\n", offset, t, v, v);
 		} else {
 			mm_setType(map, offset, t);
 		}
@@ -94,7 +147,7 @@ void _mm_set(MemoryMap* map, int offset, unsigned char type_1, unsigned char typ
 		for (i=0; i<count; i++) {
 			t = (0 == i) ? type_1 : (((count-1) == i) ? type_n : type);
 			if (((v = mm_type(map, offset+i)) != MM_UNKNOWN) && (v != t)) {
-				fprintf(stderr, "ERROR: _mm_set: Offset '$%04X' has two different data types (%c,%c); keeping %c\n", offset+i, t, v, v);
+				conflict(map, "ERROR: _mm_set: Offset '$%04X' has two different data types (%c,%c); keeping %c\n", offset+i, t, v, v);
 			}
 			else {
 				mm_setType(map, offset+i, t);
@@ -112,6 +165,43 @@ void mm_setCode(MemoryMap* map, int offset, int count) {
 	_mm_set(map, offset, MM_CODE1, MM_CODE, MM_CODE, count);
 }
 
+int mm_claimCode(MemoryMap* map, int offset, int count) {
+	union { unsigned long long word; unsigned char bytes[8]; } old, new;
+	unsigned long long *word;
+	unsigned char was;
+	int i, shift;
+	if (offset < 0 || offset+count > map->maxElements) return -1;
+	shift = (uintptr_t)(map->storage+offset) & 7;
+	if (shift+count <= 8) {
+		// One compare-and-swap on the aligned word holding the instruction
+		word = (unsigned long long *)(map->storage+offset-shift);
+		old.word = __atomic_load_n(word, __ATOMIC_RELAXED);
+		do {
+			new.word = old.word;
+			for (i=0; i<count; i++) {
+				if ((old.bytes[shift+i] & ~MM_LABEL) != MM_UNKNOWN) return i ? -1 : 0;
+				new.bytes[shift+i] = (i ? MM_CODE : MM_CODE1) | (old.bytes[shift+i] & MM_LABEL);
+			}
+		} while (!__atomic_compare_exchange_n(word, &old.word, new.word, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+		return count;
+	}
+	for (i=0; i<count; i++) {
+		// Keep any label flag another thread sets meanwhile
+		was = __atomic_load_n(&map->storage[offset+i], __ATOMIC_RELAXED);
+		do {
+			if ((was & ~MM_LABEL) != MM_UNKNOWN) return i ? -1 : 0;
+		} while (!__atomic_compare_exchange_n(&map->storage[offset+i], &was,
+				(i ? MM_CODE : MM_CODE1) | (was & MM_LABEL), 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	}
+	return count;
+}
+
+void mm_claimLabel(MemoryMap* map, int offset) {
+    // It's OK to call this with an out-of range value; just do nothing.
+    if (offset >= 0 && offset < map->maxElements)
+        __atomic_fetch_or(&map->storage[offset], MM_LABEL, __ATOMIC_RELAXED);
+}
+
 void mm_setString(MemoryMap* map, int offset, int count) {
 	// For strings, last byte is treated differently
 	_mm_set(map, offset, MM_FCS, MM_FCS, MM_FCSN, count);
@@ -209,6 +299,35 @@ int mm_runLength(MemoryMap* map, int offset) {
 	return count;
 }
 
+int mm_isRunStart(MemoryMap* map, int offset) {
+	unsigned char prev, type;
+	if (offset <= 0 || offset >= map->maxElements) return offset == 0;
+	prev = mm_type(map, offset-1);
+	type = mm_type(map, offset);
+	if (prev == type) return 0;
+	switch (type) {
+		case MM_CODE:
+		case MM_FCSN:
+		case MM_FDB2:
+			// Continuation of an instruction, string, or FDB run
+			return 0;
+		case MM_FDB:
+			return (prev != MM_FDB2);
+		default:
+			break;
+	}
+	switch (prev) {
+		case MM_FDB_JTEXT:
+		case MM_FDB_JTPIC:
+		case MM_FDB_JTREL:
+			// Jump table entries are always two bytes
+			return 0;
+		default:
+			break;
+	}
+	return 1;
+}
+
 void mm_dump(MemoryMap* map, int perLine) {
 	// Note, this dump doesn't show label flags
 	// One way to do this would be, two characters per byte
@@ -240,3 +359,39 @@ void mm_dump(MemoryMap* map, int perLine) {
     }
     printf("\n");
 }
+
+void mm_begin(MemoryMap* map) {
+	map->undoCount = 0;
+	map->heldLength = 0;
+	map->logging = 1;
+}
+
+void mm_commit(MemoryMap* map) {
+	if (map->heldLength) fputs(map->held, stderr);
+	map->undoCount = 0;
+	map->heldLength = 0;
+	map->logging = 0;
+}
+
+void mm_rollback(MemoryMap* map) {
+	// Newest first, so a byte changed twice gets its first value back
+	while (map->undoCount > 0) {
+		MmUndo *u = &map->undo[--map->undoCount];
+		map->storage[u->offset] = u->old;
+	}
+	map->heldLength = 0;
+	map->logging = 0;
+}
+
+void mm_destroy(MemoryMap* map) {
+	free(map->undo);
+	map->undo = NULL;
+	map->undoCount = map->undoMax = 0;
+	free(map->held);
+	map->held = NULL;
+	map->heldLength = map->heldMax = 0;
+	map->logging = 0;
+	free(map->storage);
+	map->storage = map->end = NULL;
+	map->maxElements = 0;
+}
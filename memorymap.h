@@ -8,11 +8,23 @@
 #ifndef MEMORYMAP_H_
 #define MEMORYMAP_H_
 
+// A change logged between mm_begin and mm_commit or mm_rollback
+typedef struct MmUndo {
+  int offset;
+  unsigned char old;   // Map byte before the change
+} MmUndo;
+
 typedef struct MemoryMap {
   unsigned abs_base;
   unsigned char *storage;
   unsigned char *end;  // Last byte of storage
   int maxElements;
+  long conflicts;      // Bytes _mm_set kept over a different type
+  int logging;         // Non-zero between mm_begin and its end
+  MmUndo *undo;        // Changes logged since mm_begin
+  int undoCount, undoMax;
+  char *held;          // Conflict messages since mm_begin, not yet printed
+  int heldLength, heldMax;
 } MemoryMap;
 
 // One byte in the map represents one byte of the loaded module.
@@ -65,6 +77,16 @@ void mm_set(MemoryMap* map, int offset, unsigned char type, int count);
 // Set a range of bytes as CODE; 1st byte gets a CODE1 type
 void mm_setCode(MemoryMap* map, int offset, int count);
 
+// Claim count bytes at offset as code from any thread, with the first
+// byte MM_CODE1, if all of them are MM_UNKNOWN. Returns count; 0 if the
+// first byte is already typed (nothing changes); or -1 if a later byte is
+// or the range is outside the map (the bytes before it may stay claimed).
+// Not logged, so not for use between mm_begin and its end.
+int mm_claimCode(MemoryMap* map, int offset, int count);
+
+// Set the label flag at a position from any thread
+void mm_claimLabel(MemoryMap* map, int offset);
+
 // Set a range of bytes as FCS; last byte gets an FCSN type
 void mm_setString(MemoryMap* map, int offset, int count);
 
@@ -77,7 +99,24 @@ void mm_setjtFDB(MemoryMap* map, int offset, int count, int type);
 // Count the number of map bytes in a "run" of the same type
 int mm_runLength(MemoryMap* map, int offset);
 
+// Return whether a new run must start at offset, whatever precedes it
+// (so output can be split there). Conservative: may return 0 at a
+// real run boundary, never 1 inside a run.
+int mm_isRunStart(MemoryMap* map, int offset);
+
+// Log every change from here on, so the changes can be kept with
+// mm_commit or undone with mm_rollback (in time proportional to the
+// number of changes, which are in undo[0..undoCount) meanwhile). The
+// conflicts _mm_set reports meanwhile are printed by mm_commit and
+// dropped by mm_rollback.
+void mm_begin(MemoryMap* map);
+void mm_commit(MemoryMap* map);
+void mm_rollback(MemoryMap* map);
+
 // Dump the memory map with a given number of bytes per line
 void mm_dump(MemoryMap* map, int perLine);
 
+// Release the map storage
+void mm_destroy(MemoryMap* map);
+
 #endif /* MEMORYMAP_H_ */
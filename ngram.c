@@ -0,0 +1,196 @@
+/*
+ * ngram.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Opcode pairs are hashed into a fixed table, so a model is the same
+// small size whatever it was trained on; the odd collision only blurs
+// the counts a little. Counts are smoothed by NG_ALPHA so an opcode pair
+// never seen still scores, if poorly.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "stats6809.h"
+#include "ddmap.h"
+#include "ngram.h"
+
+#define NG_OPCODES 768		// Page 0, then the $10 and $11 pages
+#define NG_PAIR_BITS 14
+#define NG_PAIRS (1 << NG_PAIR_BITS)
+#define NG_MIN_PAIRS 256	// Fewer and the model can't judge
+#define NG_ALPHA 0.5
+#define NG_HEADER 16
+
+typedef struct Model {
+	unsigned opcodes[NG_OPCODES];
+	unsigned pairs[NG_PAIRS];
+} Model;
+
+int ng_enabled = 0;
+
+static Model *fileModel = NULL;		// Read from model files
+static Model *imageModel = NULL;	// Trained on the current image
+static double opcodeTotal, pairTotal;
+
+static Model* newModel() {
+	Model *m = (Model *)calloc(1, sizeof(Model));
+	if (m == NULL) {
+		fprintf(stderr, "ERROR: ng_init: Insufficient memory.\n");
+		exit(1);
+	}
+	return m;
+}
+
+static void models() {
+	if (fileModel == NULL) {
+		fileModel = newModel();
+		imageModel = newModel();
+	}
+}
+
+void ng_init() {
+	models();
+	ng_enabled = 1;
+}
+
+static int opcode(MemoryFile *mod, int offset) {
+	int b = mod->storage[offset];
+	if ((b == 0x10 || b == 0x11) && offset + 1 < mod->length)
+		return (b - 0x0F) * 256 + mod->storage[offset + 1];
+	return b;
+}
+
+static int pair(int first, int second) {
+	return ((unsigned)(first * NG_OPCODES + second) * 2654435761u) >> (32 - NG_PAIR_BITS);
+}
+
+static void total() {
+	int i;
+	opcodeTotal = pairTotal = 0;
+	for (i = 0; i < NG_OPCODES; i++) opcodeTotal += fileModel->opcodes[i] + imageModel->opcodes[i];
+	for (i = 0; i < NG_PAIRS; i++) pairTotal += fileModel->pairs[i] + imageModel->pairs[i];
+}
+
+static void put32(unsigned char *p, unsigned value) {
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+static unsigned get32(unsigned char *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+}
+
+void ng_load(char *fileName) {
+	unsigned char header[NG_HEADER], *counts;
+	int i, n = NG_OPCODES + NG_PAIRS;
+	FILE *fp;
+
+	ng_init();
+	if ((fp = fopen(fileName, "rb")) == NULL) {
+		fprintf(stderr, "ERROR: ng_load: Can't open model '%s'\n", fileName);
+		exit(1);
+	}
+	if (fread(header, 1, NG_HEADER, fp) != NG_HEADER || memcmp(header, "DDNG", 4)
+			|| get32(header+4) != NG_VERSION || get32(header+8) != NG_OPCODES || get32(header+12) != NG_PAIRS) {
+		fprintf(stderr, "ERROR: ng_load: '%s' isn't a model file from this version\n", fileName);
+		exit(1);
+	}
+	counts = (unsigned char *)malloc(4 * n);
+	if (counts == NULL) {
+		fprintf(stderr, "ERROR: ng_load: Insufficient memory.\n");
+		exit(1);
+	}
+	if (fread(counts, 4, n, fp) != (size_t)n) {
+		fprintf(stderr, "ERROR: ng_load: '%s' is truncated\n", fileName);
+		exit(1);
+	}
+	fclose(fp);
+	for (i = 0; i < NG_OPCODES; i++) fileModel->opcodes[i] += get32(counts + 4*i);
+	for (i = 0; i < NG_PAIRS; i++) fileModel->pairs[i] += get32(counts + 4*(NG_OPCODES + i));
+	free(counts);
+	total();
+}
+
+void ng_save(char *fileName) {
+	unsigned char header[NG_HEADER], count[4];
+	FILE *fp;
+	int i;
+
+	models();
+	if ((fp = fopen(fileName, "wb")) == NULL) {
+		fprintf(stderr, "ERROR: ng_save: Can't write model '%s'\n", fileName);
+		exit(1);
+	}
+	memcpy(header, "DDNG", 4);
+	put32(header+4, NG_VERSION);
+	put32(header+8, NG_OPCODES);
+	put32(header+12, NG_PAIRS);
+	fwrite(header, 1, NG_HEADER, fp);
+	for (i = 0; i < NG_OPCODES; i++) {
+		put32(count, fileModel->opcodes[i] + imageModel->opcodes[i]);
+		fwrite(count, 1, 4, fp);
+	}
+	for (i = 0; i < NG_PAIRS; i++) {
+		put32(count, fileModel->pairs[i] + imageModel->pairs[i]);
+		fwrite(count, 1, 4, fp);
+	}
+	if (fclose(fp)) {
+		fprintf(stderr, "ERROR: ng_save: Can't write model '%s'\n", fileName);
+		exit(1);
+	}
+}
+
+void ng_train(MemoryFile *mod, MemoryMap *map) {
+	int offset, op, last = -1, lastEnd = -1;
+
+	models();
+	memset(imageModel, 0, sizeof(Model));
+	for (offset = 0; offset < mod->length; offset++) {
+		if (mm_type(map, offset) != MM_CODE1) continue;
+		op = opcode(mod, offset);
+		++imageModel->opcodes[op];
+		// A pair only if one instruction runs straight into the other
+		if (offset == lastEnd) ++imageModel->pairs[pair(last, op)];
+		last = op;
+		lastEnd = offset + M6809_bytes(mod, offset);
+	}
+	total();
+}
+
+double ng_score(MemoryFile *mod, int offset, int length) {
+	double bits = 0, p;
+	int end = offset + length, op, bytes, last = -1, count = 0;
+	unsigned seen;
+
+	if (pairTotal < NG_MIN_PAIRS) return NG_UNTRAINED;
+	while (offset < end && offset < mod->length) {
+		op = opcode(mod, offset);
+		if (last < 0) {
+			p = (fileModel->opcodes[op] + imageModel->opcodes[op] + NG_ALPHA) / (opcodeTotal + NG_ALPHA * NG_OPCODES);
+		} else {
+			seen = fileModel->opcodes[last] + imageModel->opcodes[last];
+			p = (fileModel->pairs[pair(last, op)] + imageModel->pairs[pair(last, op)] + NG_ALPHA)
+				/ (seen + NG_ALPHA * NG_OPCODES);
+		}
+		// Random bytes give a page 0 opcode 1 time in 256, a prefixed one 1 in 65536
+		bits += log2(p) + (op < 256 ? 8 : 16);
+		++count;
+		last = op;
+		if ((bytes = M6809_bytes(mod, offset)) < 1) break;
+		offset += bytes;
+	}
+	return count ? bits / count : 0;
+}
+
+unsigned long long ng_hash() {
+	return fileModel ? dm_hash((unsigned char *)fileModel, sizeof(Model)) : 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * ngram.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef NGRAM_H_
+#define NGRAM_H_
+
+#include "memoryfile.h"
+#include "memorymap.h"
+
+// Opcode bigram model of 6809 code, for scoring speculation candidates.
+// An opcode is its first byte, or its first two after a $10 or $11
+// prefix. The model counts opcodes and opcode pairs in code traced from
+// real entry points (not from speculation) in the image, plus any counts
+// read from model files trained on other images.
+//
+// A model file is little-endian:
+//
+//  0  "DDNG" and u32 version
+//  8  u32 opcode count, u32 pair count (the sizes of the tables below)
+// 16  u32 count per opcode, then u32 count per hashed opcode pair
+
+#define NG_VERSION 1
+
+// Non-zero once a model is in use; check it before calling ng_score
+extern int ng_enabled;
+
+// Start using a model
+void ng_init();
+
+// Add the counts in a model file
+void ng_load(char *fileName);
+
+// Write the counts read from files and those from the current image
+void ng_save(char *fileName);
+
+// Count the code in map that was traced from real entry points (call
+// before any speculation), after forgetting the previous image's
+void ng_train(MemoryFile *mod, MemoryMap *map);
+
+// Score the run of instructions of length bytes at offset: the mean,
+// per instruction, of how many bits likelier the model makes its opcodes
+// than bytes taken at random. Positive looks like code. A model with too
+// little to go on scores everything NG_UNTRAINED.
+double ng_score(MemoryFile *mod, int offset, int length);
+#define NG_UNTRAINED 1e9
+
+// Hash of the counts read from files, for keys that depend on the options
+unsigned long long ng_hash();
+
+#endif /* NGRAM_H_ */
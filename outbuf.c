@@ -0,0 +1,84 @@
+/*
+ * outbuf.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "outbuf.h"
+
+void ob_init(OutBuf *b, size_t size) {
+	if (size < 64) size = 64;
+	b->storage = (char *)malloc(size);
+	if (b->storage == NULL) {
+		fprintf(stderr, "ERROR: ob_init: Insufficient memory for output buffer.\n");
+		exit(1);
+	}
+	b->length = 0;
+	b->maxElements = size;
+}
+
+static void ob_reserve(OutBuf *b, size_t extra) {
+	if (b->length + extra <= b->maxElements) return;
+	size_t size = b->maxElements * 2;
+	while (size < b->length + extra) size *= 2;
+	char *storage = (char *)realloc(b->storage, size);
+	if (storage == NULL) {
+		fprintf(stderr, "ERROR: ob_reserve: Insufficient memory for output buffer.\n");
+		exit(1);
+	}
+	b->storage = storage;
+	b->maxElements = size;
+}
+
+void ob_write(OutBuf *b, const char *text, size_t length) {
+	ob_reserve(b, length);
+	memcpy(b->storage + b->length, text, length);
+	b->length += length;
+}
+
+void ob_puts(OutBuf *b, const char *text) {
+	ob_write(b, text, strlen(text));
+}
+
+void ob_putc(OutBuf *b, char c) {
+	ob_reserve(b, 1);
+	b->storage[b->length++] = c;
+}
+
+void ob_printf(OutBuf *b, const char *format, ...) {
+	va_list args;
+	int n;
+
+	// Try in the space we have; grow and retry if it didn't fit
+	va_start(args, format);
+	n = vsnprintf(b->storage + b->length, b->maxElements - b->length, format, args);
+	va_end(args);
+	if (n < 0) return;
+	if ((size_t)n >= b->maxElements - b->length) {
+		ob_reserve(b, n + 1);
+		va_start(args, format);
+		vsnprintf(b->storage + b->length, b->maxElements - b->length, format, args);
+		va_end(args);
+	}
+	b->length += n;
+}
+
+void ob_flush(OutBuf *b, FILE *fp) {
+	if (b->length) fwrite(b->storage, 1, b->length, fp);
+	b->length = 0;
+}
+
+void ob_destroy(OutBuf *b) {
+	if (b && b->storage) {
+		free(b->storage);
+		b->storage = NULL;
+		b->length = 0;
+		b->maxElements = 0;
+	}
+}
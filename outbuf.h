@@ -0,0 +1,41 @@
+/*
+ * outbuf.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef OUTBUF_H_
+#define OUTBUF_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct OutBuf {
+  char *storage;
+  size_t length;        // Bytes used
+  size_t maxElements;   // Bytes allocated
+} OutBuf;
+
+/* Initialize an empty buffer with room for size bytes (it grows as needed) */
+void ob_init(OutBuf *b, size_t size);
+
+/* Append bytes to the buffer */
+void ob_write(OutBuf *b, const char *text, size_t length);
+
+/* Append a null-terminated string to the buffer */
+void ob_puts(OutBuf *b, const char *text);
+
+/* Append one character to the buffer */
+void ob_putc(OutBuf *b, char c);
+
+/* Append formatted text to the buffer */
+void ob_printf(OutBuf *b, const char *format, ...);
+
+/* Write the buffer contents to a file and empty the buffer */
+void ob_flush(OutBuf *b, FILE *fp);
+
+/* Deallocates the memory allocated to the buffer */
+void ob_destroy(OutBuf *b);
+
+#endif /* OUTBUF_H_ */
@@ -0,0 +1,209 @@
+/*
+ * partrace.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Work-stealing tracer. Each worker owns a deque of entry points: it
+// pushes the branch targets it finds and pops them from the back, and
+// when it runs dry it steals from the front of another's. An instruction
+// belongs to whichever worker claims its bytes in the map; one that finds
+// a start claimed stops there, as the serial tracer stops at code it has
+// traced. Finding the middle of an instruction, or a typed byte inside
+// one, is where the serial tracer's result would depend on its order, so
+// every worker stops and the map is restored from the copy taken first.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "stats6809.h"
+#include "taskpool.h"
+#include "partrace.h"
+
+#define PT_MIN_BYTES 16384	// Smaller images trace faster than threads start
+
+extern int isNotCode(int entryPoint);
+
+typedef struct Deque {
+	pthread_mutex_t lock;
+	int *items;
+	int head, tail, max;	// Owner works at tail, thieves take from head
+} Deque;
+
+typedef struct Tracer {
+	MemoryFile *mod;
+	MemoryMap *map;
+	Deque *deques;
+	int jobs;
+	int pending;	// Entry points pushed and not yet traced
+	int failed;		// Non-zero once instructions overlap
+} Tracer;
+
+PtDecode *pt_table = NULL;
+unsigned char *pt_typed = NULL;	// The map as it was while tracing
+int pt_length = 0;
+
+static void push(Deque *d, int entry) {
+	pthread_mutex_lock(&d->lock);
+	if (d->tail == d->max) {
+		if (d->head > 0) {
+			memmove(d->items, d->items + d->head, sizeof(int) * (d->tail - d->head));
+			d->tail -= d->head;
+			d->head = 0;
+		} else {
+			d->max = d->max ? d->max * 2 : 256;
+			d->items = (int *)realloc(d->items, sizeof(int) * d->max);
+			if (d->items == NULL) {
+				fprintf(stderr, "ERROR: pt_trace: Insufficient memory.\n");
+				exit(1);
+			}
+		}
+	}
+	d->items[d->tail++] = entry;
+	pthread_mutex_unlock(&d->lock);
+}
+
+static int pop(Deque *d, int *entry) {
+	int found = 0;
+	pthread_mutex_lock(&d->lock);
+	if (d->tail > d->head) {
+		*entry = d->items[--d->tail];
+		found = 1;
+	}
+	pthread_mutex_unlock(&d->lock);
+	return found;
+}
+
+static int steal(Tracer *t, int self, int *entry) {
+	int i, found = 0;
+	for (i = 1; i < t->jobs && !found; i++) {
+		Deque *d = &t->deques[(self + i) % t->jobs];
+		pthread_mutex_lock(&d->lock);
+		if (d->tail > d->head) {
+			*entry = d->items[d->head++];
+			found = 1;
+		}
+		pthread_mutex_unlock(&d->lock);
+	}
+	return found;
+}
+
+static int typedBefore(int offset) {
+	return (pt_typed[offset] & ~MM_LABEL) != MM_UNKNOWN;
+}
+
+// Trace linearly from entry, as mapCode would
+static void traceRun(Tracer *t, Deque *own, int entry) {
+	MemoryFile *mod = t->mod;
+	PtDecode *d;
+	Decoded inst;
+	int offset = entry;
+
+	if (entry < 0 || entry >= mod->length || isNotCode(entry)) return;
+	mm_claimLabel(t->map, entry);
+	while (offset < mod->length && !__atomic_load_n(&t->failed, __ATOMIC_RELAXED)) {
+		M6809_decode(mod, offset, &inst);
+		if (!(inst.flags & HAS_6809)) return;
+		switch (mm_claimCode(t->map, offset, inst.bytes)) {
+			case 0:
+				// Traced by another worker (which carries on from here) or
+				// typed before; but the middle of an instruction is a conflict
+				if (typedBefore(offset)
+						|| (__atomic_load_n(&t->map->storage[offset], __ATOMIC_RELAXED) & ~MM_LABEL) == MM_CODE1)
+					return;
+				// Fall through
+			case -1:
+				__atomic_store_n(&t->failed, 1, __ATOMIC_RELAXED);
+				return;
+		}
+		d = &pt_table[offset];
+		d->bytes = inst.bytes;
+		d->flags = inst.flags;
+		d->dest = inst.dest;
+		d->eff = inst.eff;
+		if (inst.dest != -1) {
+			__atomic_fetch_add(&t->pending, 1, __ATOMIC_RELAXED);
+			push(own, inst.dest);
+		}
+		if (inst.eff != inst.dest && inst.eff != -1) mm_claimLabel(t->map, inst.eff);
+		if (inst.flags & LEAF) return;
+		offset += inst.bytes;
+	}
+}
+
+static void worker(int task, void *arg) {
+	Tracer *t = (Tracer *)arg;
+	Deque *own = &t->deques[task];
+	int entry;
+
+	while (!__atomic_load_n(&t->failed, __ATOMIC_RELAXED)) {
+		if (!pop(own, &entry) && !steal(t, task, &entry)) {
+			// Others may still push work; stop only when none is left
+			if (__atomic_load_n(&t->pending, __ATOMIC_ACQUIRE) == 0) break;
+			sched_yield();
+			continue;
+		}
+		traceRun(t, own, entry);
+		__atomic_fetch_sub(&t->pending, 1, __ATOMIC_RELEASE);
+	}
+}
+
+int pt_trace(MemoryFile *mod, MemoryMap *map, IntStack *stack, int jobs) {
+	Tracer t;
+	int i;
+
+	pt_end();
+	if (jobs < 2 || mod->length < PT_MIN_BYTES || intstack_isEmpty(stack)) return 0;
+	pt_table = (PtDecode *)calloc(mod->length, sizeof(PtDecode));
+	pt_typed = (unsigned char *)malloc(map->maxElements);
+	if (pt_table == NULL || pt_typed == NULL) {
+		fprintf(stderr, "ERROR: pt_trace: Insufficient memory.\n");
+		exit(1);
+	}
+	pt_length = mod->length;
+	memcpy(pt_typed, map->storage, map->maxElements);
+
+	t.mod = mod;
+	t.map = map;
+	t.jobs = jobs;
+	t.pending = stack->top;
+	t.failed = 0;
+	t.deques = (Deque *)calloc(jobs, sizeof(Deque));
+	if (t.deques == NULL) {
+		fprintf(stderr, "ERROR: pt_trace: Insufficient memory.\n");
+		exit(1);
+	}
+	for (i = 0; i < jobs; i++) pthread_mutex_init(&t.deques[i].lock, NULL);
+	// Deal the entry points out; the stack is left for mapCode to replay
+	for (i = 0; i < stack->top; i++) push(&t.deques[i % jobs], stack->storage[i]);
+
+	tp_run(jobs, jobs, worker, &t);
+
+	for (i = 0; i < jobs; i++) {
+		pthread_mutex_destroy(&t.deques[i].lock);
+		free(t.deques[i].items);
+	}
+	free(t.deques);
+	if (t.failed) {
+		memcpy(map->storage, pt_typed, map->maxElements);
+		pt_end();
+		return 0;
+	}
+	for (i = 0; i < map->maxElements; i++) pt_typed[i] = typedBefore(i);
+	return 1;
+}
+
+void pt_end() {
+	free(pt_table);
+	free(pt_typed);
+	pt_table = NULL;
+	pt_typed = NULL;
+	pt_length = 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * partrace.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef PARTRACE_H_
+#define PARTRACE_H_
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+
+// Parallel tracing. Worker threads follow every entry point on the
+// address stack and everything it leads to, claiming each instruction in
+// the map as they go. Where instructions overlap, the map would depend on
+// the order they were traced in; the workers give up, the map is put back
+// and mapCode traces serially, meeting (and reporting) the conflicts as it
+// always has. Otherwise the map is the one mapCode would have built, and
+// mapCode replays the trace in its own order, without decoding or writing
+// the map, to push the labels and count what it traced exactly as before.
+
+// A claimed instruction as mapCode uses it
+typedef struct PtDecode {
+	short bytes;			// As M6809_bytes; 0 if not claimed
+	unsigned char flags;	// As M6809_flags
+	int dest;				// As M6809_transfer, if flags has TRANSFER, else -1
+	int eff;				// As M6809_pcrel
+} PtDecode;
+
+// Trace from the entry points on stack (which is left as it is) on jobs
+// threads. Returns 1 if the map now holds the traced code; 0, with the map
+// unchanged, for one job, a small image, or overlapping instructions.
+int pt_trace(MemoryFile *mod, MemoryMap *map, IntStack *stack, int jobs);
+
+extern PtDecode *pt_table;			// One per image byte
+extern unsigned char *pt_typed;		// One per map byte: non-zero if typed before or replayed
+extern int pt_length;				// Of the image
+
+// The instruction claimed at offset, or NULL
+#define pt_decoded(offset) ((offset) >= 0 && (offset) < pt_length && pt_table[offset].bytes ? &pt_table[offset] : NULL)
+
+// The type mapCode would see at offset, having replayed what it has
+#define pt_type(map, offset) ((offset) >= 0 && (offset) < (map)->maxElements && !pt_typed[offset] ? MM_UNKNOWN : mm_type(map, offset))
+
+// Mark count bytes at offset as replayed
+#define pt_visit(offset, count) memset(pt_typed + (offset), 1, (count))
+
+// Done replaying
+void pt_end();
+
+#endif /* PARTRACE_H_ */
@@ -0,0 +1,340 @@
+/*
+ * provenance.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Provenance of the map. Recording appends 16 byte events to a buffer
+// allocated up front (it grows only for very busy runs) and formats
+// nothing; explain reads the file back and follows each decision to the
+// one before it: a byte to the run that traced it, the run to the push of
+// its entry point, the push to the instruction or table it came from, and
+// so on to an exec address, module header, vector or speculation round.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memorymap.h"
+#include "provenance.h"
+
+#define PV_EVENTS 262144	// Allocated when recording starts
+#define PV_HEADER 20
+#define PV_EVENT 16
+#define PV_DEPTH 1000
+
+typedef struct PvEvent {
+	unsigned char what;		// PV_MAP, PV_PUSH or PV_TABLE
+	unsigned char cause;	// PV_* cause
+	unsigned char type;		// MM_* type of a map event
+	unsigned char round;	// Speculation round (0 before any)
+	unsigned offset, count;
+	int from;
+} PvEvent;
+
+int pv_enabled = 0;
+
+static PvEvent *events = NULL;
+static long eventCount = 0, eventMax = 0;
+static int cause = PV_TRACE, from = -1, round = 0;
+static int outerCause, outerFrom;
+
+void pv_init() {
+	if (events == NULL) {
+		eventMax = PV_EVENTS;
+		events = (PvEvent *)malloc(sizeof(PvEvent) * eventMax);
+		if (events == NULL) {
+			fprintf(stderr, "ERROR: pv_init: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	eventCount = 0;
+	cause = PV_TRACE;
+	from = -1;
+	round = 0;
+	pv_enabled = 1;
+}
+
+static PvEvent* addEvent(int what) {
+	PvEvent *e;
+	if (eventCount == eventMax) {
+		eventMax *= 2;
+		events = (PvEvent *)realloc(events, sizeof(PvEvent) * eventMax);
+		if (events == NULL) {
+			fprintf(stderr, "ERROR: pv_record: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	e = &events[eventCount++];
+	e->what = what;
+	e->round = round < 255 ? round : 255;
+	return e;
+}
+
+void pv_cause(int newCause, int newFrom) {
+	cause = newCause;
+	from = newFrom;
+}
+
+void pv_round() {
+	++round;
+}
+
+void pv_map(int offset, int count, unsigned char type) {
+	PvEvent *e = addEvent(PV_MAP);
+	e->cause = cause;
+	e->type = type;
+	e->offset = offset;
+	e->count = count;
+	e->from = from;
+}
+
+void pv_push(int offset, int pushCause, int pushFrom) {
+	PvEvent *e = addEvent(PV_PUSH);
+	e->cause = pushCause;
+	e->type = 0;
+	e->offset = offset;
+	e->count = 0;
+	e->from = pushFrom;
+}
+
+void pv_table(int start, int end) {
+	PvEvent *e = addEvent(PV_TABLE);
+	e->cause = cause;
+	e->type = 0;
+	e->offset = start;
+	e->count = end - start + 1;
+	e->from = from;
+	outerCause = cause;
+	outerFrom = from;
+	pv_cause(PV_JUMPTABLE, start);
+}
+
+void pv_tableEnd() {
+	pv_cause(outerCause, outerFrom);
+}
+
+long pv_mark() {
+	return eventCount;
+}
+
+void pv_undo(long mark) {
+	if (mark < eventCount) eventCount = mark;
+}
+
+static void put32(unsigned char *p, unsigned value) {
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+static unsigned get32(unsigned char *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+}
+
+void pv_write(char *fileName, MemoryMap *map) {
+	unsigned char header[PV_HEADER], event[PV_EVENT];
+	FILE *fp;
+	long i;
+
+	if ((fp = fopen(fileName, "wb")) == NULL) {
+		fprintf(stderr, "ERROR: pv_write: Can't write provenance '%s'\n", fileName);
+		exit(1);
+	}
+	memcpy(header, "DDPV", 4);
+	put32(header+4, PV_VERSION);
+	put32(header+8, map->abs_base);
+	put32(header+12, map->maxElements);
+	put32(header+16, eventCount);
+	fwrite(header, 1, PV_HEADER, fp);
+	fwrite(map->storage, 1, map->maxElements, fp);
+	for (i = 0; i < eventCount; i++) {
+		event[0] = events[i].what;
+		event[1] = events[i].cause;
+		event[2] = events[i].type;
+		event[3] = events[i].round;
+		put32(event+4, events[i].offset);
+		put32(event+8, events[i].count);
+		put32(event+12, events[i].from);
+		fwrite(event, 1, PV_EVENT, fp);
+	}
+	if (fclose(fp)) {
+		fprintf(stderr, "ERROR: pv_write: Can't write provenance '%s'\n", fileName);
+		exit(1);
+	}
+	eventCount = 0;
+}
+
+//
+// diffdasm explain
+//
+
+static unsigned base, length;
+static unsigned char *types;
+static unsigned char *visited;
+
+static const char* typeName(unsigned char type) {
+	switch (type & ~MM_LABEL) {
+		case MM_CODE1: case MM_CODE: case MM_CODEX: return "code";
+		case MM_FCB: return "FCB";
+		case MM_FDB: case MM_FDB2: return "FDB";
+		case MM_FCC: return "FCC";
+		case MM_FCS: case MM_FCSN: return "string (FCS)";
+		case MM_FDB_JTEXT: case MM_FDB_JTEXT2:
+		case MM_FDB_JTPIC: case MM_FDB_JTPIC2:
+		case MM_FDB_JTREL: case MM_FDB_JTREL2: return "jump table entry";
+		case MM_INVALID: return "invalid";
+		default: return "unknown";
+	}
+}
+
+static void describe(PvEvent *e) {
+	switch (e->cause) {
+		case PV_TRACE: printf("traced from the entry point at $%04X", e->from + base); break;
+		case PV_TRANSFER: printf("branch or call from the instruction at $%04X", e->from + base); break;
+		case PV_JUMPTABLE: printf("entry of the jump table at $%04X", e->from + base); break;
+		case PV_MODULE: printf("OS-9 module at $%04X", e->from + base); break;
+		case PV_VECTORS: printf("6809 vector page"); break;
+		case PV_EXEC: printf("--exec or an exec hint"); break;
+		case PV_LOADEXEC: printf("exec address of the S-record or MHX file"); break;
+		case PV_DEFAULT: printf("start of the image, for lack of another entry point"); break;
+		case PV_SPEC: printf("speculation round %d", e->round); break;
+		case PV_HINT: printf("data type hint"); break;
+		case PV_DATAREF: printf("data access by the instruction at $%04X", e->from + base); break;
+		case PV_DISPATCH: printf("jump table dispatch by the instruction at $%04X", e->from + base); break;
+		default: printf("cause %d", e->cause); break;
+	}
+	if (e->round && e->cause != PV_SPEC) printf(" (speculation round %d)", e->round);
+	printf("\n");
+}
+
+static void explainTable(PvEvent *ev, long before, unsigned start, int depth) {
+	long k;
+	for (k = before - 1; k >= 0; k--)
+		if (ev[k].what == PV_TABLE && ev[k].offset == start) break;
+	printf("%*s$%04X: ", depth ? 2 : 0, "", start + base);
+	if (k < 0) {
+		printf("jump table (no record of why)\n");
+		return;
+	}
+	printf("jump table to $%04X, ", start + ev[k].count - 1 + base);
+	describe(&ev[k]);
+}
+
+static void explainOffset(PvEvent *ev, long before, unsigned offset, int depth);
+
+static void explainEntry(PvEvent *ev, long before, unsigned entry, int depth) {
+	long k;
+	printf("%*s$%04X: ", depth ? 2 : 0, "", entry + base);
+	if (depth > PV_DEPTH || visited[entry]) {
+		printf("entry point, explained above\n");
+		return;
+	}
+	visited[entry] = 1;
+	// The push that led to the run, not one made since it began
+	for (k = 0; k < before; k++)
+		if (ev[k].what == PV_MAP && ev[k].cause == PV_TRACE && ev[k].from == (int)entry) break;
+	for (--k; k >= 0; k--)
+		if (ev[k].what == PV_PUSH && ev[k].offset == entry) break;
+	if (k < 0) {
+		printf("entry point (no record of why)\n");
+		return;
+	}
+	printf("entry point, ");
+	describe(&ev[k]);
+	if (ev[k].cause == PV_TRANSFER) explainOffset(ev, k, ev[k].from, depth + 1);
+	else if (ev[k].cause == PV_JUMPTABLE) explainTable(ev, k, ev[k].from, depth + 1);
+}
+
+static void explainOffset(PvEvent *ev, long before, unsigned offset, int depth) {
+	const char *final = typeName(types[offset]);
+	long k, last = -1;
+
+	// The first type set sticks, so the first decision that gave the
+	// byte its final type made it; else show the last one tried
+	for (k = 0; k < before; k++) {
+		if (ev[k].what != PV_MAP || offset < ev[k].offset || offset >= ev[k].offset + ev[k].count) continue;
+		last = k;
+		if (!strcmp(typeName(ev[k].type), final)) break;
+	}
+	if (k == before) k = last;
+	printf("%*s$%04X: %s%s, ", depth ? 2 : 0, "", offset + base, final,
+		(types[offset] & MM_LABEL) ? " (labelled)" : "");
+	if (k < 0) {
+		printf("never classified\n");
+		return;
+	}
+	if (strcmp(typeName(ev[k].type), final)) printf("kept over %s from ", typeName(ev[k].type));
+	describe(&ev[k]);
+	if (ev[k].cause == PV_TRACE) explainEntry(ev, k, ev[k].from, depth + 1);
+	else if (ev[k].cause == PV_JUMPTABLE) explainTable(ev, k, ev[k].from, depth + 1);
+}
+
+int explain_main(int argc, char **argv) {
+	unsigned char header[PV_HEADER], *p, *raw;
+	unsigned address, count;
+	PvEvent *ev;
+	FILE *fp;
+	long i;
+	int a;
+
+	if (argc < 3) {
+		fprintf(stderr, "Usage:\ndiffdasm explain <provenance file> <address>...\n");
+		return 1;
+	}
+	if ((fp = fopen(argv[1], "rb")) == NULL) {
+		fprintf(stderr, "ERROR: explain: Can't open provenance '%s'\n", argv[1]);
+		return 1;
+	}
+	if (fread(header, 1, PV_HEADER, fp) != PV_HEADER || memcmp(header, "DDPV", 4) || get32(header+4) != PV_VERSION) {
+		fprintf(stderr, "ERROR: explain: '%s' isn't a provenance file from this version\n", argv[1]);
+		fclose(fp);
+		return 1;
+	}
+	base = get32(header+8);
+	length = get32(header+12);
+	count = get32(header+16);
+	types = (unsigned char *)malloc(length + 1);
+	raw = (unsigned char *)malloc((size_t)count * PV_EVENT + 1);
+	ev = (PvEvent *)malloc(sizeof(PvEvent) * (count + 1));
+	visited = (unsigned char *)malloc(length + 1);
+	if (types == NULL || raw == NULL || ev == NULL || visited == NULL) {
+		fprintf(stderr, "ERROR: explain: Insufficient memory.\n");
+		exit(1);
+	}
+	if (fread(types, 1, length, fp) != length || fread(raw, PV_EVENT, count, fp) != count) {
+		fprintf(stderr, "ERROR: explain: '%s' is truncated\n", argv[1]);
+		fclose(fp);
+		return 1;
+	}
+	fclose(fp);
+	for (i = 0, p = raw; i < count; i++, p += PV_EVENT) {
+		ev[i].what = p[0];
+		ev[i].cause = p[1];
+		ev[i].type = p[2];
+		ev[i].round = p[3];
+		ev[i].offset = get32(p+4);
+		ev[i].count = get32(p+8);
+		ev[i].from = (int)get32(p+12);
+	}
+	free(raw);
+
+	for (a = 2; a < argc; a++) {
+		char *s = argv[a];
+		if (*s == '$') ++s;
+		if (sscanf(s, "%x", &address) != 1 || address - base >= length) {
+			fprintf(stderr, "ERROR: explain: '%s' isn't an address in the image ($%04X-$%04X)\n",
+				argv[a], base, base + length - 1);
+			return 1;
+		}
+		memset(visited, 0, length);
+		explainOffset(ev, count, address - base, 0);
+		if (a + 1 < argc) printf("\n");
+	}
+	free(types);
+	free(visited);
+	free(ev);
+	return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * provenance.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef PROVENANCE_H_
+#define PROVENANCE_H_
+
+#include "memorymap.h"
+
+// Why each byte was classified, recorded with --provenance as small
+// binary events and answered afterwards by diffdasm explain. Map events
+// come from every map type change (memorymap calls pv_map) under the
+// cause last set with pv_cause; pushes of entry points record their own.
+//
+// A .ddpv file is little-endian:
+//
+//  0  "DDPV" and u32 version
+//  8  u32 base address, u32 map length, u32 event count
+// 20  the final map, one byte per image byte
+//     then 16 bytes per event: u8 PV_MAP / PV_PUSH / PV_TABLE, u8 cause,
+//     u8 map type, u8 speculation round, u32 offset, u32 count, i32 from
+
+#define PV_VERSION 1
+
+// Events
+#define PV_MAP		0	// Bytes given a map type
+#define PV_PUSH		1	// Entry point pushed for tracing
+#define PV_TABLE	2	// Jump table found
+
+// Causes; from is the offset named in brackets
+#define PV_TRACE	0	// Traced (from the entry point of the run)
+#define PV_TRANSFER	1	// Branch or call (from the instruction)
+#define PV_JUMPTABLE	2	// Jump table entry (from the table start)
+#define PV_MODULE	3	// OS-9 module header or entry (from the module start)
+#define PV_VECTORS	4	// Vector page
+#define PV_EXEC		5	// --exec or an exec hint
+#define PV_LOADEXEC	6	// Exec address of an S-record or MHX file
+#define PV_DEFAULT	7	// Offset zero, for lack of any other entry point
+#define PV_SPEC		8	// Speculation candidate
+#define PV_HINT		9	// Data type hint
+#define PV_DATAREF	10	// Data access (from the instruction)
+#define PV_DISPATCH	11	// Jump table dispatch (from the instruction)
+
+// Non-zero while --provenance is recording; check it before calling
+extern int pv_enabled;
+
+// Start recording
+void pv_init();
+
+// Set the cause of the map events that follow
+void pv_cause(int cause, int from);
+
+// A speculation round begins
+void pv_round();
+
+// Record bytes given a map type; memorymap calls this
+void pv_map(int offset, int count, unsigned char type);
+
+// Record an entry point pushed for tracing
+void pv_push(int offset, int cause, int from);
+
+// Record a jump table under the current cause, and make it the cause of
+// the map events that follow until pv_tableEnd
+void pv_table(int start, int end);
+void pv_tableEnd();
+
+// Forget the events recorded since pv_mark returned mark (the map
+// changes they describe were rolled back)
+long pv_mark();
+void pv_undo(long mark);
+
+// Write the events and final map to file
+void pv_write(char *fileName, MemoryMap *map);
+
+// diffdasm explain <file> <address>...
+int explain_main(int argc, char **argv);
+
+#endif /* PROVENANCE_H_ */
@@ -0,0 +1,225 @@
+//
+// Incremental re-tracing of a patched image against a saved map
+//
+// Created on: Oct 19, 2026
+//     Author: cburke
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "intstack.h"
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "stats6809.h"
+#include "ddmap.h"
+
+#include "diffdasm.h"
+#include "retrace.h"
+
+extern MemoryFile input;
+extern MemoryMap map;
+extern IntStack addrStack;	// Stack of known-good execution addresses
+extern IntStack labelStack;	// Stack of labels that could be execution addresses
+extern IntStack entryStack;	// Execution offsets tracing started from
+extern IntStack tableStack;	// Jump tables found (start, end, type)
+extern IntStack segmentStack;	// Modules found (offset, length, type)
+extern int is_os9;
+extern int _debug;
+extern int specflag, dataRefs, jumpTables;
+
+static int isCodeType(unsigned char type) {
+	return type == MM_CODE1 || type == MM_CODE || type == MM_CODEX;
+}
+
+static int isStringType(unsigned char type) {
+	return type == MM_FCS || type == MM_FCSN || type == MM_FCC;
+}
+
+static int sameStack(IntStack *s, unsigned char *section, unsigned count) {
+	unsigned i;
+	if (s->top != count) return 0;
+	for (i = 0; i < count; i++)
+		if ((unsigned)s->storage[i] != dm_get(section, i)) return 0;
+	return 1;
+}
+
+// Did inferEntry find the same modules, jump tables and entry points in
+// the new image as in the old one, and mark the same bytes?
+static int sameStructure(DdMap *dm) {
+	int i, raw = intstack_isEmpty(&segmentStack);
+	if (((dm->flags & DM_OS9) != 0) != (is_os9 != 0)) return 0;
+	if (!sameStack(&entryStack, dm->entries, dm->entryCount)) return 0;
+	if (!sameStack(&tableStack, dm->tables, dm->tableCount * 3)) return 0;
+	if (raw) {
+		// saveMap wrote the whole image as one raw segment
+		if (dm->segmentCount != 1 || dm_get(dm->segments, 0) != 0 ||
+				dm_get(dm->segments, 2) != DM_RAW) return 0;
+	} else if (!sameStack(&segmentStack, dm->segments, dm->segmentCount * 3)) {
+		return 0;
+	}
+	for (i = 0; i < map.maxElements; i++) {
+		unsigned char type = map.storage[i] & ~MM_LABEL;
+		if (type != MM_UNKNOWN && type != (dm->types[i] & ~MM_LABEL)) return 0;
+	}
+	return 1;
+}
+
+// Mark the maximal run of traced code or strings around offset invalid,
+// queueing code runs so their references are followed
+static void invalidate(DdMap *dm, unsigned char *invalid, int offset, IntStack *work) {
+	unsigned char type = dm->types[offset] & ~MM_LABEL;
+	int (*same)(unsigned char) = isCodeType(type) ? isCodeType : isStringType;
+	int start = offset, end = offset;
+
+	if (invalid[offset] || !same(type)) return;
+	while (start > 0 && !invalid[start-1] && same(dm->types[start-1] & ~MM_LABEL)) --start;
+	while (end+1 < map.maxElements && !invalid[end+1] && same(dm->types[end+1] & ~MM_LABEL)) ++end;
+	memset(invalid+start, 1, end-start+1);
+	if (same == isCodeType) {
+		intstack_push(work, start);
+		intstack_push(work, end+1);
+	}
+}
+
+int retrace(char *mapName) {
+	DdMap dm;
+	MemoryFile old;
+	IntStack work;
+	unsigned char *invalid, *reached, *fresh, flags;
+	int i, start, end, changed = 0;
+	int dest, eff;
+
+	dm_open(&dm, mapName);
+	if (dm.length != input.length || dm.base != input.abs_base ||
+			dm.optionsHash != traceOptionsHash() || !sameStructure(&dm)) {
+		if (_debug) printf("retrace: '%s' doesn't match this image's structure or options; tracing it all.\n", mapName);
+		dm_close(&dm);
+		return 0;
+	}
+	if (dm.conflicts) {
+		// Where instructions overlapped, the old map depends on the order
+		// the trace met them in, which a partial trace can't reproduce
+		if (_debug) printf("retrace: '%s' was traced with %u conflicts; tracing it all.\n", mapName, dm.conflicts);
+		dm_close(&dm);
+		return 0;
+	}
+	for (i = 0; i < map.maxElements; i++)
+		if (dm.image[i] != input.storage[i]) ++changed;
+	if (_debug) printf("retrace: %d bytes changed since '%s'.\n", changed, mapName);
+	if (!changed) {
+		// Nothing to trace; the old map is the map
+		memcpy(map.storage, dm.types, map.maxElements);
+		dm_close(&dm);
+		addrStack.top = 0;
+		return 1;
+	}
+	if (specflag || dataRefs || jumpTables) {
+		// What speculation, data references and dispatch recognition find
+		// depends on the order the whole trace found things in, and their
+		// results aren't invalidated with the code they came from
+		if (_debug) printf("retrace: speculation or recognizers are on; tracing it all.\n");
+		dm_close(&dm);
+		return 0;
+	}
+
+	// The old image, for decoding what the old trace followed
+	old.abs_base = input.abs_base;
+	old.storage = dm.image;
+	old.end = dm.image + dm.length - 1;
+	old.length = dm.length;
+
+	// Invalidate the traced code and strings that overlap changed bytes,
+	// or that stopped at an invalid opcode the changes may have made
+	// valid, then everything the invalid code led to: any of it may no
+	// longer be reachable or may now decode differently
+	invalid = calloc(map.maxElements, 1);
+	if (invalid == NULL) {
+		fprintf(stderr, "ERROR: retrace: Insufficient memory.\n");
+		exit(1);
+	}
+	intstack_init(&work, map.maxElements + 2);
+	for (i = 0; i < map.maxElements; i++) {
+		if (dm.image[i] == input.storage[i] || (map.storage[i] & ~MM_LABEL) != MM_UNKNOWN) continue;
+		for (start = i > 2 ? i - 2 : 0; start <= i; start++)
+			invalidate(&dm, invalid, start, &work);
+	}
+	while (!intstack_isEmpty(&work)) {
+		end = intstack_pop(&work);
+		start = intstack_pop(&work);
+		for (i = start; i < end; i++) {
+			if ((dm.types[i] & ~MM_LABEL) != MM_CODE1) continue;
+			dest = -1;
+			if (M6809_flags(&old, i) & TRANSFER) dest = M6809_transfer(&old, i);
+			eff = M6809_pcrel(&old, i);
+			if (dest >= 0 && dest < map.maxElements) invalidate(&dm, invalid, dest, &work);
+			if (eff >= 0 && eff < map.maxElements) invalidate(&dm, invalid, eff, &work);
+		}
+	}
+	intstack_destroy(&work);
+
+	// Speculative code is found again too, after the rest, as a full
+	// trace would: keep only code the old trace reached from its entry
+	// points by following transfers and falling through
+	reached = calloc(map.maxElements, 1);
+	if (reached == NULL) {
+		fprintf(stderr, "ERROR: retrace: Insufficient memory.\n");
+		exit(1);
+	}
+	intstack_init(&work, map.maxElements + dm.entryCount);
+	for (i = 0; i < dm.entryCount; i++)
+		intstack_push(&work, dm_get(dm.entries, i));
+	while (!intstack_isEmpty(&work)) {
+		i = intstack_pop(&work);
+		while (i >= 0 && i < map.maxElements && !reached[i] &&
+				(dm.types[i] & ~MM_LABEL) == MM_CODE1) {
+			flags = M6809_flags(&old, i);
+			if (flags & TRANSFER) {
+				dest = M6809_transfer(&old, i);
+				if (dest != -1) intstack_push(&work, dest);
+			}
+			do reached[i++] = 1;
+			while (i < map.maxElements && (dm.types[i] & ~MM_LABEL) != MM_CODE1 && isCodeType(dm.types[i] & ~MM_LABEL));
+			if (flags & LEAF) break;
+		}
+	}
+	intstack_destroy(&work);
+
+	// Keep the code that survives, over the structure inferEntry marked
+	// again. Strings are found again: tracing comes first, so new code
+	// may now run through one. Labels on surviving code stay (their
+	// references survived, or the code would be invalid); other labels
+	// are rebuilt below.
+	fresh = map.storage;
+	for (i = 0; i < map.maxElements; i++) {
+		if ((fresh[i] & ~MM_LABEL) != MM_UNKNOWN || invalid[i] || !reached[i]) continue;
+		fresh[i] = (fresh[i] & MM_LABEL) | dm.types[i];
+	}
+	dm_close(&dm);
+
+	// Relabel from the surviving code, and trace on from it into
+	// anything that is now unknown
+	for (i = 0; i < map.maxElements; i++) {
+		if (!reached[i] || invalid[i] || mm_type(&map, i) != MM_CODE1) continue;
+		dest = -1;
+		if (M6809_flags(&input, i) & TRANSFER) {
+			dest = M6809_transfer(&input, i);
+			if (dest >= 0 && dest < map.maxElements && !isNotCode(dest)) {
+				if (mm_type(&map, dest) == MM_UNKNOWN)
+					intstack_push(&addrStack, dest);
+				else
+					mm_setLabel(&map, dest, 1);
+			}
+		}
+		eff = M6809_pcrel(&input, i);
+		if (eff != dest && eff != -1) {
+			if (mm_type(&map, eff) == MM_UNKNOWN) intstack_push(&labelStack, eff);
+			mm_setLabel(&map, eff, 1);
+		}
+	}
+	free(invalid);
+	free(reached);
+	mapCode(&input);
+	return 1;
+}
@@ -0,0 +1,18 @@
+/*
+ * retrace.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef RETRACE_H_
+#define RETRACE_H_
+
+// With a module loaded and its entry points inferred, trace it starting
+// from a map saved for an earlier version of the same image: only code
+// and strings overlapping changed bytes, and what they led to, are traced
+// again. Returns 0, having changed nothing, if the saved map doesn't fit
+// (other options, or changed module headers, jump tables or entry points).
+int retrace(char *mapName);
+
+#endif /* RETRACE_H_ */
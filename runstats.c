@@ -0,0 +1,204 @@
+/*
+ * runstats.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Where a run's time goes. Phases take wall and process CPU time (which
+// counts every output thread, so can exceed wall time) from the clocks
+// only when --stats is on, so timing a run barely changes it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "intstack.h"
+#include "memorymap.h"
+#include "runstats.h"
+#include "timeline.h"
+
+extern int statsflag;	// Non-zero to report phase times and counters
+
+typedef struct Timing {
+  double wall, cpu;		// Seconds accumulated
+  double wallAt, cpuAt;	// When the phase began, if running
+  int running;
+} Timing;
+
+typedef struct Round {
+  double wall, cpu;
+  long codeHits, stringHits;
+} Round;
+
+RunStats runStats;
+
+static Timing timing[RS_PHASES];
+static Round *rounds = NULL;
+static int roundCount = 0, roundMax = 0;
+
+static const char *phaseNames[RS_PHASES] = {
+	"load", "infer", "trace", "speculation", "labels", "emit"
+};
+
+// Map bytes by type, for the report
+static const struct { char *name; char *types; } kinds[] = {
+	{ "code", "Iiy" },
+	{ "fcb", "B" },
+	{ "fdb", "Dd" },
+	{ "fcc", "C" },
+	{ "fcs", "Ss" },
+	{ "jumptable", "EePpRr" },
+	{ "invalid", "X" },
+	{ "unknown", "U" },
+	{ NULL, NULL }
+};
+
+static double seconds(clockid_t clock) {
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void rs_begin(int phase) {
+	Timing *t = &timing[phase];
+	tl_phaseBegin(phase);
+	if (!statsflag || t->running) return;
+	t->wallAt = seconds(CLOCK_MONOTONIC);
+	t->cpuAt = seconds(CLOCK_PROCESS_CPUTIME_ID);
+	t->running = 1;
+}
+
+int rs_end(int phase) {
+	Timing *t = &timing[phase];
+	int timeline = tl_phaseEnd(phase);
+	if (!statsflag || !t->running) return timeline;
+	t->wall += seconds(CLOCK_MONOTONIC) - t->wallAt;
+	t->cpu += seconds(CLOCK_PROCESS_CPUTIME_ID) - t->cpuAt;
+	t->running = 0;
+	return 1;
+}
+
+void rs_endRound(long codeHits, long stringHits) {
+	Timing *t = &timing[RS_SPEC];
+	double wall, cpu;
+	if (!statsflag || !t->running) {
+		rs_end(RS_SPEC);
+		return;
+	}
+	wall = t->wall;
+	cpu = t->cpu;
+	rs_end(RS_SPEC);
+	if (roundCount == roundMax) {
+		roundMax = roundMax ? roundMax * 2 : 16;
+		rounds = (Round *)realloc(rounds, sizeof(Round) * roundMax);
+		if (rounds == NULL) {
+			fprintf(stderr, "ERROR: rs_endRound: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	rounds[roundCount].wall = t->wall - wall;
+	rounds[roundCount].cpu = t->cpu - cpu;
+	rounds[roundCount].codeHits = codeHits;
+	rounds[roundCount].stringHits = stringHits;
+	++roundCount;
+}
+
+static long mapBytes(MemoryMap *map, char *types) {
+	long count = 0;
+	int i;
+	for (i = 0; i < map->maxElements; i++)
+		if (strchr(types, map->storage[i] & ~MM_LABEL)) ++count;
+	return count;
+}
+
+static long mapLabels(MemoryMap *map) {
+	long count = 0;
+	int i;
+	for (i = 0; i < map->maxElements; i++)
+		if (map->storage[i] & MM_LABEL) ++count;
+	return count;
+}
+
+static void reportText(FILE *fp, MemoryMap *map, IntStack *addr, IntStack *label, long maxrss) {
+	long instructions = runStats.traced + runStats.probed;
+	double wall = 0, cpu = 0;
+	int i;
+
+	fprintf(fp, "Phase               Wall ms     CPU ms\n");
+	for (i = 0; i < RS_PHASES; i++) {
+		fprintf(fp, "%-15s %10.3f %10.3f\n", phaseNames[i], timing[i].wall * 1e3, timing[i].cpu * 1e3);
+		if (i == RS_SPEC) {
+			for (int r = 0; r < roundCount; r++)
+				fprintf(fp, "  round %-7d %10.3f %10.3f   %ld code, %ld strings\n", r + 1,
+					rounds[r].wall * 1e3, rounds[r].cpu * 1e3, rounds[r].codeHits, rounds[r].stringHits);
+		}
+		wall += timing[i].wall;
+		cpu += timing[i].cpu;
+	}
+	fprintf(fp, "%-15s %10.3f %10.3f\n\n", "total", wall * 1e3, cpu * 1e3);
+
+	fprintf(fp, "Instructions traced   %ld\n", runStats.traced);
+	fprintf(fp, "Instructions probed   %ld\n", runStats.probed);
+	fprintf(fp, "Decoder calls         %ld (%.2f per instruction)\n", runStats.decodes,
+		instructions ? (double)runStats.decodes / instructions : 0.0);
+	fprintf(fp, "Address stack         %ld pushes, %ld duplicates, peak depth %d\n",
+		addr->pushes, addr->duplicates, addr->peak);
+	fprintf(fp, "Label stack           %ld pushes, %ld duplicates, peak depth %d\n",
+		label->pushes, label->duplicates, label->peak);
+	fprintf(fp, "couldBeCode           %ld probes, %ld hits\n", runStats.codeProbes, runStats.codeHits);
+	fprintf(fp, "couldBeString         %ld probes, %ld hits\n", runStats.stringProbes, runStats.stringHits);
+	fprintf(fp, "Rollbacks             %ld traces, %ld map changes undone\n", runStats.rollbacks, runStats.undone);
+	fprintf(fp, "Skip zones            %ld bytes\n", runStats.skipped);
+	fprintf(fp, "Data references       %ld bytes typed\n", runStats.dataRefs);
+	fprintf(fp, "Jump tables           %ld found by dispatch\n", runStats.tables);
+	if (map->storage) {
+		fprintf(fp, "Map bytes            ");
+		for (i = 0; kinds[i].name; i++)
+			fprintf(fp, " %s %ld,", kinds[i].name, mapBytes(map, kinds[i].types));
+		fprintf(fp, " labels %ld\n", mapLabels(map));
+	}
+	fprintf(fp, "Peak memory           %ld KB\n", maxrss);
+}
+
+static void reportJSON(FILE *fp, MemoryMap *map, IntStack *addr, IntStack *label, long maxrss) {
+	int i;
+
+	fprintf(fp, "{\"phases\":{");
+	for (i = 0; i < RS_PHASES; i++)
+		fprintf(fp, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f}", i ? "," : "",
+			phaseNames[i], timing[i].wall * 1e3, timing[i].cpu * 1e3);
+	fprintf(fp, "},\"rounds\":[");
+	for (i = 0; i < roundCount; i++)
+		fprintf(fp, "%s{\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"code_hits\":%ld,\"string_hits\":%ld}",
+			i ? "," : "", rounds[i].wall * 1e3, rounds[i].cpu * 1e3, rounds[i].codeHits, rounds[i].stringHits);
+	fprintf(fp, "],\"counters\":{\"traced\":%ld,\"probed\":%ld,\"decodes\":%ld,"
+		"\"addr_pushes\":%ld,\"addr_duplicates\":%ld,\"addr_peak\":%d,"
+		"\"label_pushes\":%ld,\"label_duplicates\":%ld,\"label_peak\":%d,"
+		"\"code_probes\":%ld,\"code_hits\":%ld,\"string_probes\":%ld,\"string_hits\":%ld,"
+		"\"rollbacks\":%ld,\"undone\":%ld,\"skipped\":%ld,\"data_refs\":%ld,\"tables\":%ld}",
+		runStats.traced, runStats.probed, runStats.decodes,
+		addr->pushes, addr->duplicates, addr->peak,
+		label->pushes, label->duplicates, label->peak,
+		runStats.codeProbes, runStats.codeHits, runStats.stringProbes, runStats.stringHits,
+		runStats.rollbacks, runStats.undone, runStats.skipped, runStats.dataRefs, runStats.tables);
+	fprintf(fp, ",\"map\":{");
+	if (map->storage) {
+		for (i = 0; kinds[i].name; i++)
+			fprintf(fp, "\"%s\":%ld,", kinds[i].name, mapBytes(map, kinds[i].types));
+		fprintf(fp, "\"labels\":%ld", mapLabels(map));
+	}
+	fprintf(fp, "},\"peak_rss_kb\":%ld}\n", maxrss);
+}
+
+void rs_report(FILE *fp, MemoryMap *map, IntStack *addr, IntStack *label, int json) {
+	struct rusage usage;
+	long maxrss = 0;
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0) maxrss = usage.ru_maxrss;
+	if (json) reportJSON(fp, map, addr, label, maxrss);
+	else reportText(fp, map, addr, label, maxrss);
+	fflush(fp);
+}
@@ -0,0 +1,48 @@
+/*
+ * runstats.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef RUNSTATS_H_
+#define RUNSTATS_H_
+
+#include <stdio.h>
+
+#include "intstack.h"
+#include "memorymap.h"
+
+// Phases of a run, timed when --stats is given
+enum { RS_LOAD, RS_INFER, RS_TRACE, RS_SPEC, RS_LABELS, RS_EMIT, RS_PHASES };
+
+// Tracer counters, always kept (they cost an increment each)
+typedef struct RunStats {
+  long traced;			// Instructions mapped by mapCode
+  long probed;			// Instructions decoded by couldBeCode
+  long decodes;			// Decoder calls by mapCode and couldBeCode
+  long codeProbes, codeHits;	// couldBeCode calls, and runs taken as code
+  long stringProbes, stringHits;	// couldBeString calls, and runs taken as strings
+  long rollbacks, undone;	// Speculative traces rolled back, and map changes undone
+  long skipped;			// Image bytes in skip zones (--prefilter)
+  long dataRefs;		// Image bytes typed by data references (--data-refs)
+  long tables;			// Jump tables found by their dispatch (--jump-tables)
+} RunStats;
+
+extern RunStats runStats;
+
+// Start and stop timing a phase; time accumulates over repeated phases.
+// Nothing is timed unless --stats was given; --timeline also records the
+// phases. rs_end returns whether the phase was running, so a phase can be
+// paused around another.
+void rs_begin(int phase);
+int rs_end(int phase);
+
+// Each speculation round ends with the code and string hits it made
+void rs_endRound(long codeHits, long stringHits);
+
+// Write the phase times, counters, map contents and peak memory, as
+// text or as a JSON object
+void rs_report(FILE *fp, MemoryMap *map, IntStack *addr, IntStack *label, int json);
+
+#endif /* RUNSTATS_H_ */
@@ -0,0 +1,342 @@
+/*
+ * serve.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Resident server. The listening process forks a pool of workers that
+// accept connections on the same socket. A worker reads a whole request,
+// then runs it in a forked copy of itself: the copy starts from the
+// worker's initialized stacks, tables and option defaults, may exit on
+// an error like the command line does, and leaves nothing behind. What
+// it writes to stdout goes straight to the client.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "outbuf.h"
+#include "cache.h"
+#include "diffdasm.h"
+#include "serve.h"
+
+#define REQUEST_MAX 65536			// Working directory and arguments
+#define IMAGE_MAX (16*1024*1024)	// Image bytes sent with a request
+
+typedef struct Request {
+  char *buffer;
+  size_t length, max;
+  int argc;
+  char **argv;		// argv[0] is "diffdasm"
+  char *cwd;
+  int image;		// Argument sent as image bytes, or -1
+  size_t imageAt;	// Offset of the image bytes in buffer
+  unsigned imageLength;
+} Request;
+
+static volatile sig_atomic_t stopping = 0;
+
+static void put32(unsigned char *p, unsigned value) {
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+static unsigned get32(unsigned char *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+}
+
+static int writeAll(int fd, const void *data, size_t length) {
+	const char *p = (const char *)data;
+	ssize_t n;
+	while (length > 0) {
+		if ((n = write(fd, p, length)) < 0) {
+			if (errno == EINTR) continue;
+			return 0;
+		}
+		p += n;
+		length -= n;
+	}
+	return 1;
+}
+
+static int isImageArg(char *arg) {
+	return !strcmp(arg, "-") || !strcmp(arg, "-.s19") || !strcmp(arg, "-.mhx");
+}
+
+// Read more of a request into its buffer, up to limit bytes in all
+static int readMore(int fd, Request *r, size_t limit) {
+	ssize_t n;
+	if (r->length == r->max) {
+		if (r->max >= limit) return 0;
+		r->max = r->max * 2 < limit ? r->max * 2 : limit;
+		if ((r->buffer = (char *)realloc(r->buffer, r->max)) == NULL) {
+			fprintf(stderr, "ERROR: readMore: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	do n = read(fd, r->buffer + r->length, r->max - r->length);
+	while (n < 0 && errno == EINTR);
+	if (n <= 0) return 0;
+	r->length += n;
+	return 1;
+}
+
+// Read and split a request; returns 0 if it is incomplete or too big
+static int readRequest(int fd, Request *r) {
+	size_t scan = 1, end = 0, p;
+	int i;
+
+	r->length = 0;
+	r->image = -1;
+	r->imageLength = 0;
+	// Strings up to an empty one
+	while (!end) {
+		if (!readMore(fd, r, REQUEST_MAX)) return 0;
+		for (; scan < r->length && !end; scan++)
+			if (r->buffer[scan] == '\0' && r->buffer[scan-1] == '\0') end = scan + 1;
+	}
+	r->argc = 0;
+	for (p = strlen(r->buffer) + 1; p < end - 1; p += strlen(r->buffer + p) + 1) {
+		if (isImageArg(r->buffer + p)) r->image = r->argc + 1;
+		++r->argc;
+	}
+	if (r->argc == 0) return 0;
+	// Image bytes
+	if (r->image >= 0) {
+		while (r->length < end + 4)
+			if (!readMore(fd, r, end + 4 + IMAGE_MAX)) return 0;
+		r->imageLength = get32((unsigned char *)r->buffer + end);
+		if (r->imageLength > IMAGE_MAX) return 0;
+		r->imageAt = end + 4;
+		while (r->length < r->imageAt + r->imageLength)
+			if (!readMore(fd, r, r->imageAt + IMAGE_MAX)) return 0;
+	}
+	// The buffer won't move now
+	++r->argc;
+	r->argv = (char **)realloc(r->argv, sizeof(char *) * (r->argc + 1));
+	r->cwd = r->buffer;
+	r->argv[0] = "diffdasm";
+	for (i = 1, p = strlen(r->buffer) + 1; i < r->argc; i++, p += strlen(r->buffer + p) + 1)
+		r->argv[i] = r->buffer + p;
+	r->argv[r->argc] = NULL;
+	return 1;
+}
+
+// Write image bytes to a temporary file with the suffix the argument
+// gives, so it loads like a module on disk
+static int writeImage(Request *r, char *path, size_t size) {
+	char *dir = getenv("TMPDIR"), *suffix = r->argv[r->image] + 1;
+	int fd, ok;
+
+	snprintf(path, size, "%s/diffdasmXXXXXX%s", dir ? dir : "/tmp", suffix);
+	if ((fd = mkstemps(path, strlen(suffix))) < 0) return 0;
+	ok = writeAll(fd, r->buffer + r->imageAt, r->imageLength);
+	if (close(fd) || !ok) {
+		unlink(path);
+		return 0;
+	}
+	r->argv[r->image] = path;
+	return 1;
+}
+
+static void handle(int conn, Request *r) {
+	char temp[4096], buffer[4096];
+	unsigned char trailer[8];
+	unsigned errLength = 0;
+	int status = 1, wstatus;
+	size_t n;
+	pid_t pid;
+	FILE *err;
+
+	if (!readRequest(conn, r)) return;
+	if ((err = tmpfile()) == NULL) return;
+	temp[0] = '\0';
+	if (r->image >= 0 && !writeImage(r, temp, sizeof(temp))) {
+		fprintf(err, "ERROR: serve: Can't write image to a temporary file\n");
+	} else if ((pid = fork()) == 0) {
+		dup2(conn, 1);
+		dup2(fileno(err), 2);
+		if (chdir(r->cwd)) {
+			fprintf(stderr, "ERROR: serve: Can't change to directory '%s'\n", r->cwd);
+			exit(1);
+		}
+		exit(request(r->argc, r->argv));
+	} else if (pid < 0) {
+		fprintf(err, "ERROR: serve: Can't start request\n");
+	} else {
+		while (waitpid(pid, &wstatus, 0) < 0 && errno == EINTR);
+		status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+	}
+	if (temp[0]) unlink(temp);
+
+	// Pass on stderr, then the trailer
+	fflush(err);
+	rewind(err);
+	while ((n = fread(buffer, 1, sizeof(buffer), err)) > 0) {
+		if (!writeAll(conn, buffer, n)) break;
+		errLength += n;
+	}
+	fclose(err);
+	put32(trailer, errLength);
+	put32(trailer+4, status);
+	writeAll(conn, trailer, 8);
+}
+
+static void worker(int listener) {
+	Request r;
+	int conn;
+
+	r.max = 4096;
+	r.buffer = (char *)malloc(r.max);
+	r.argv = NULL;
+	for (;;) {
+		if ((conn = accept(listener, NULL, NULL)) < 0) continue;
+		handle(conn, &r);
+		close(conn);
+	}
+}
+
+static pid_t spawn(int listener) {
+	pid_t pid = fork();
+	if (pid == 0) {
+		signal(SIGTERM, SIG_DFL);
+		signal(SIGINT, SIG_DFL);
+		worker(listener);
+	}
+	return pid;
+}
+
+static void stop(int sig) {
+	stopping = 1;
+}
+
+int serve(char *socketPath, int workers, long cacheBytes) {
+	struct sockaddr_un addr;
+	struct sigaction sa;
+	pid_t *pids, pid;
+	int listener, i, status;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "ERROR: serve: Socket path '%s' is too long\n", socketPath);
+		exit(1);
+	}
+	strcpy(addr.sun_path, socketPath);
+	unlink(socketPath);
+	if ((listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+			bind(listener, (struct sockaddr *)&addr, sizeof(addr)) ||
+			listen(listener, 128)) {
+		fprintf(stderr, "ERROR: serve: Can't listen on '%s'\n", socketPath);
+		exit(1);
+	}
+	cache_share(cacheBytes);
+
+	signal(SIGPIPE, SIG_IGN);	// A client went away; the write fails instead
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stop;		// No SA_RESTART, so wait() returns
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGINT, &sa, NULL);
+
+	pids = (pid_t *)malloc(sizeof(pid_t) * workers);
+	for (i = 0; i < workers; i++)
+		pids[i] = spawn(listener);
+	// Replace workers that die
+	while (!stopping) {
+		if ((pid = wait(&status)) < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+		for (i = 0; i < workers; i++)
+			if (pids[i] == pid && !stopping) pids[i] = spawn(listener);
+	}
+	for (i = 0; i < workers; i++)
+		if (pids[i] > 0) kill(pids[i], SIGTERM);
+	while (wait(&status) > 0 || errno == EINTR);
+	unlink(socketPath);
+	free(pids);
+	return 0;
+}
+
+int client_main(int argc, char **argv) {
+	struct sockaddr_un addr;
+	OutBuf req, resp;
+	unsigned char length[4], *end;
+	char cwd[4096], buffer[65536];
+	unsigned errLength, status;
+	int fd, i, image = 0;
+	ssize_t n;
+
+	if (argc < 3) {
+		fprintf(stderr, "ERROR: client requires a socket and a module\n");
+		usage();
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+			connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		fprintf(stderr, "ERROR: client: Can't connect to '%s'\n", argv[1]);
+		return 1;
+	}
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
+		fprintf(stderr, "ERROR: client: Can't get the working directory\n");
+		return 1;
+	}
+
+	ob_init(&req, 4096);
+	ob_write(&req, cwd, strlen(cwd) + 1);
+	for (i = 2; i < argc; i++) {
+		ob_write(&req, argv[i], strlen(argv[i]) + 1);
+		if (isImageArg(argv[i])) image = 1;
+	}
+	ob_putc(&req, '\0');
+	if (image) {
+		// Send the image from stdin
+		size_t at = req.length;
+		ob_write(&req, "\0\0\0\0", 4);
+		while ((n = fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+			ob_write(&req, buffer, n);
+		put32(length, req.length - at - 4);
+		memcpy(req.storage + at, length, 4);
+	}
+	if (!writeAll(fd, req.storage, req.length)) {
+		fprintf(stderr, "ERROR: client: Can't send request to '%s'\n", argv[1]);
+		return 1;
+	}
+	ob_destroy(&req);
+
+	ob_init(&resp, 65536);
+	while ((n = read(fd, buffer, sizeof(buffer))) != 0) {
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0) break;
+		ob_write(&resp, buffer, n);
+	}
+	close(fd);
+	if (resp.length < 8) {
+		fprintf(stderr, "ERROR: client: Incomplete response from '%s'\n", argv[1]);
+		return 1;
+	}
+	end = (unsigned char *)resp.storage + resp.length - 8;
+	errLength = get32(end);
+	status = get32(end+4);
+	if (errLength > resp.length - 8) {
+		fprintf(stderr, "ERROR: client: Bad response from '%s'\n", argv[1]);
+		return 1;
+	}
+	fwrite(resp.storage, 1, resp.length - 8 - errLength, stdout);
+	fflush(stdout);
+	fwrite(resp.storage + resp.length - 8 - errLength, 1, errLength, stderr);
+	ob_destroy(&resp);
+	return status;
+}
@@ -0,0 +1,33 @@
+/*
+ * serve.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef SERVE_H_
+#define SERVE_H_
+
+// Protocol, one request per connection:
+//
+// The client sends NUL terminated strings: its working directory, then
+// the arguments as on the command line, then an empty string. A module
+// named "-" (or "-.s19" / "-.mhx") is sent as image bytes: a u32
+// little-endian length and the bytes follow the empty string.
+//
+// The server streams back what diffdasm writes to stdout, then what it
+// wrote to stderr, then u32 little-endian stderr length and exit status.
+// The connection is then closed.
+
+// "diffdasm --serve <socket>"
+// Stay resident with workers processes accepting requests on a Unix
+// socket, sharing an in-memory result cache of cacheBytes. Each request
+// runs in a copy of an initialized worker, so nothing carries over from
+// one request to the next. Runs until terminated.
+int serve(char *socketPath, int workers, long cacheBytes);
+
+// "diffdasm client <socket> <options> <module>"
+// Run a request in a server and pass on its output and exit status
+int client_main(int argc, char **argv);
+
+#endif /* SERVE_H_ */
@@ -0,0 +1,381 @@
+/*
+ * shard.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Corpus runs split by hand. Every shard reads the whole manifest and
+// takes the modules whose path hash falls to it, so shards agree on who
+// does what with no coordination. Each module is disassembled in its own
+// process (the tracer keeps its state in globals) with stdout sent to its
+// output file; the shard index records how each one went, and merge puts
+// the indexes back together.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "ddmap.h"
+#include "diffdasm.h"
+#include "shard.h"
+
+#define STRMAX 4096
+
+extern int source;
+extern int f9info;
+extern int jobs;
+
+enum { MOD_OK, MOD_FAILED, MOD_MISSING };
+static const char *statusNames[] = { "ok", "failed", "missing" };
+
+typedef struct Module {
+	char *path;
+	char out[STRMAX];	// Output file
+	int status;
+	unsigned long long hash;	// Of the image file
+	long length;
+	long lines;			// In the output
+	pid_t pid;
+} Module;
+
+static unsigned long long hashString(char *s) {
+	return dm_hash((unsigned char *)s, strlen(s));
+}
+
+// A path built by snprintf, which must have fit
+static void checkPath(int n, char *path) {
+	if (n < 0 || n >= STRMAX) {
+		fprintf(stderr, "ERROR: shard_run: Path too long '%s...'\n", path);
+		exit(1);
+	}
+}
+
+// Hash and size of a file, and how many lines it has; 0 if it can't be read
+static int scanFile(char *path, unsigned long long *hash, long *length, long *lines) {
+	unsigned char buffer[65536];
+	unsigned long long h = 14695981039346656037ULL;
+	size_t n, i;
+	FILE *fp;
+
+	if ((fp = fopen(path, "rb")) == NULL) return 0;
+	*length = 0;
+	if (lines) *lines = 0;
+	while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+		for (i = 0; i < n; i++) {
+			h = (h ^ buffer[i]) * 1099511628211ULL;
+			if (lines && buffer[i] == '\n') ++*lines;
+		}
+		*length += n;
+	}
+	fclose(fp);
+	if (hash) *hash = h;
+	return 1;
+}
+
+// Read the manifest paths; returns how many, and their hash
+static int readManifest(char *manifestName, char ***paths, unsigned long long *hash) {
+	char line[STRMAX], *p, *end;
+	int count = 0, max = 256;
+	FILE *fp;
+
+	if ((fp = fopen(manifestName, "r")) == NULL) {
+		fprintf(stderr, "ERROR: shard_run: Can't open manifest '%s'\n", manifestName);
+		exit(1);
+	}
+	*paths = (char **)malloc(sizeof(char *) * max);
+	*hash = 14695981039346656037ULL;
+	while (fgets(line, sizeof(line), fp)) {
+		for (p = line; *p == ' ' || *p == '\t'; p++);
+		for (end = p + strlen(p); end > p && (unsigned char)end[-1] <= ' '; end--);
+		*end = '\0';
+		if (*p == '\0' || *p == '#') continue;
+		if (count == max) {
+			max *= 2;
+			*paths = (char **)realloc(*paths, sizeof(char *) * max);
+		}
+		if (*paths == NULL) {
+			fprintf(stderr, "ERROR: shard_run: Insufficient memory.\n");
+			exit(1);
+		}
+		(*paths)[count++] = strdup(p);
+		*end = '\n';
+		for (; p <= end; p++) *hash = (*hash ^ (unsigned char)*p) * 1099511628211ULL;
+	}
+	fclose(fp);
+	return count;
+}
+
+static void startModule(Module *m) {
+	fflush(stdout);
+	fflush(stderr);
+	m->pid = fork();
+	if (m->pid < 0) {
+		fprintf(stderr, "ERROR: startModule: Can't fork.\n");
+		exit(1);
+	}
+	if (m->pid == 0) {
+		if (freopen(m->out, "w", stdout) == NULL) {
+			fprintf(stderr, "ERROR: startModule: Can't create '%s'\n", m->out);
+			_exit(1);
+		}
+		jobs = 1;	// The shard already runs a module per CPU
+		exit(runModule(m->path));
+	}
+}
+
+static void finishModule(Module *m) {
+	int status;
+	long length;
+
+	while (waitpid(m->pid, &status, 0) < 0 && errno == EINTR);
+	m->status = WIFEXITED(status) && WEXITSTATUS(status) == 0 ? MOD_OK : MOD_FAILED;
+	if (!scanFile(m->out, NULL, &length, &m->lines)) m->lines = 0;
+	if (m->status == MOD_FAILED) fprintf(stderr, "ERROR: shard_run: '%s' failed.\n", m->path);
+}
+
+int shard_run(char *manifestName, int shard, int shards, char *outDir, int jobs) {
+	Module *m;
+	char **paths, temp[STRMAX], index[STRMAX], *p;
+	unsigned long long manifestHash;
+	int count, selected, i, running, next, counts[3] = { 0, 0, 0 };
+	FILE *fp;
+
+	count = readManifest(manifestName, &paths, &manifestHash);
+	if (mkdir(outDir, 0777) && errno != EEXIST) {
+		fprintf(stderr, "ERROR: shard_run: Can't create directory '%s'\n", outDir);
+		exit(1);
+	}
+
+	// This shard's modules, in manifest order
+	m = (Module *)calloc(count ? count : 1, sizeof(Module));
+	if (m == NULL) {
+		fprintf(stderr, "ERROR: shard_run: Insufficient memory.\n");
+		exit(1);
+	}
+	for (selected = 0, i = 0; i < count; i++) {
+		if (hashString(paths[i]) % shards != (unsigned)shard) continue;
+		m[selected].path = paths[i];
+		// Flattened path plus its hash, so a/b.bin and a_b.bin stay apart
+		checkPath(snprintf(temp, sizeof(temp), "%s", paths[i]), temp);
+		for (p = temp; *p; p++) if (*p == '/') *p = '_';
+		checkPath(snprintf(m[selected].out, sizeof(m[selected].out), "%s/%s-%016llx.%s",
+			outDir, temp, hashString(paths[i]), f9info ? "info" : source ? "asm" : "dis"),
+			m[selected].out);
+		if (!scanFile(paths[i], &m[selected].hash, &m[selected].length, NULL))
+			m[selected].status = MOD_MISSING;
+		++selected;
+	}
+
+	// Up to jobs at a time, skipping the missing
+	for (next = 0, running = 0, i = 0; i < selected; ) {
+		while (running < jobs && next < selected) {
+			if (m[next].status != MOD_MISSING) {
+				startModule(&m[next]);
+				++running;
+			}
+			++next;
+		}
+		if (m[i].status != MOD_MISSING) {
+			finishModule(&m[i]);
+			--running;
+		}
+		++i;
+	}
+
+	// The index appears whole or not at all
+	checkPath(snprintf(index, sizeof(index), "%s/shard-%d-of-%d.idx", outDir, shard, shards), index);
+	checkPath(snprintf(temp, sizeof(temp), "%s.tmp", index), temp);
+	if ((fp = fopen(temp, "w")) == NULL) {
+		fprintf(stderr, "ERROR: shard_run: Can't create index '%s'\n", temp);
+		exit(1);
+	}
+	fprintf(fp, "# diffdasm shard %d/%d %d %016llx %016llx\n",
+		shard, shards, count, manifestHash, traceOptionsHash());
+	for (i = 0; i < selected; i++) {
+		fprintf(fp, "%s\t%016llx\t%ld\t%ld\t%s\t%s\n", statusNames[m[i].status],
+			m[i].hash, m[i].length, m[i].lines,
+			m[i].status == MOD_MISSING ? "-" : m[i].out, m[i].path);
+		++counts[m[i].status];
+	}
+	if (fclose(fp) || rename(temp, index)) {
+		fprintf(stderr, "ERROR: shard_run: Can't write index '%s'\n", index);
+		exit(1);
+	}
+	printf("Shard %d/%d: %d of %d modules, %d ok, %d failed, %d missing (%s)\n",
+		shard, shards, selected, count, counts[MOD_OK], counts[MOD_FAILED], counts[MOD_MISSING], index);
+
+	for (i = 0; i < count; i++) free(paths[i]);
+	free(paths);
+	free(m);
+	return counts[MOD_FAILED] || counts[MOD_MISSING];
+}
+
+typedef struct Entry {
+	char *path;
+	char *out;
+	int status;
+	unsigned long long hash;
+	long length;
+	long lines;
+	int first;		// Entry with the first path with the same image
+} Entry;
+
+static int byPath(const void *a, const void *b) {
+	return strcmp(((Entry *)a)->path, ((Entry *)b)->path);
+}
+
+static Entry *sorted;
+
+static int byHash(const void *a, const void *b) {
+	Entry *x = &sorted[*(int *)a], *y = &sorted[*(int *)b];
+	if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+	return *(int *)a - *(int *)b;
+}
+
+// Read one shard index, adding its modules to entries
+static int readIndex(char *name, int *shard, int *shards, int *count,
+		unsigned long long *manifestHash, unsigned long long *optionsHash,
+		Entry **entries, int *entryCount, int *entryMax) {
+	char line[2 * STRMAX], *field[6], *p;
+	int i, lineNo = 1;
+	Entry *e;
+	FILE *fp;
+
+	if ((fp = fopen(name, "r")) == NULL) {
+		fprintf(stderr, "ERROR: merge: Can't open index '%s'\n", name);
+		return 0;
+	}
+	if (!fgets(line, sizeof(line), fp) ||
+			sscanf(line, "# diffdasm shard %d/%d %d %llx %llx",
+				shard, shards, count, manifestHash, optionsHash) != 5) {
+		fprintf(stderr, "ERROR: merge: '%s' is not a shard index\n", name);
+		fclose(fp);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		++lineNo;
+		line[strcspn(line, "\r\n")] = '\0';
+		for (p = line, i = 0; i < 6; i++) {
+			field[i] = p;
+			if (i < 5 && (p = strchr(p, '\t')) == NULL) break;
+			if (i < 5) *p++ = '\0';
+		}
+		if (i < 6) {
+			fprintf(stderr, "ERROR: merge: %s:%d: Bad index line\n", name, lineNo);
+			fclose(fp);
+			return 0;
+		}
+		if (*entryCount == *entryMax) {
+			*entryMax = *entryMax ? *entryMax * 2 : 1024;
+			*entries = (Entry *)realloc(*entries, sizeof(Entry) * *entryMax);
+			if (*entries == NULL) {
+				fprintf(stderr, "ERROR: merge: Insufficient memory.\n");
+				exit(1);
+			}
+		}
+		e = &(*entries)[(*entryCount)++];
+		for (e->status = MOD_OK; e->status < MOD_MISSING && strcmp(field[0], statusNames[e->status]); e->status++);
+		e->hash = strtoull(field[1], NULL, 16);
+		e->length = strtol(field[2], NULL, 10);
+		e->lines = strtol(field[3], NULL, 10);
+		e->out = strdup(field[4]);
+		e->path = strdup(field[5]);
+	}
+	fclose(fp);
+	return 1;
+}
+
+int merge_main(int argc, char **argv) {
+	Entry *entries = NULL, *e;
+	unsigned char *seen = NULL;
+	unsigned long long manifestHash = 0, optionsHash = 0, mh, oh;
+	int shards = 0, count = 0, entryCount = 0, entryMax = 0;
+	int shard, n, c, i, j, *order, bad = 0, distinct = 0, counts[3] = { 0, 0, 0 };
+	long lines = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "ERROR: merge requires shard indexes\n");
+		usage();
+	}
+	for (i = 1; i < argc; i++) {
+		if (!readIndex(argv[i], &shard, &n, &c, &mh, &oh, &entries, &entryCount, &entryMax)) {
+			bad = 1;
+			continue;
+		}
+		if (seen == NULL) {
+			shards = n;
+			count = c;
+			manifestHash = mh;
+			optionsHash = oh;
+			seen = (unsigned char *)calloc(shards, 1);
+		} else if (n != shards || c != count || mh != manifestHash) {
+			fprintf(stderr, "ERROR: merge: '%s' is a shard of a different manifest or split\n", argv[i]);
+			bad = 1;
+			continue;
+		} else if (oh != optionsHash) {
+			fprintf(stderr, "WARNING: merge: '%s' was run with different options\n", argv[i]);
+		}
+		if (shard < 0 || shard >= shards) {
+			fprintf(stderr, "ERROR: merge: '%s' has a bad shard number\n", argv[i]);
+			bad = 1;
+		} else if (seen[shard]++) {
+			fprintf(stderr, "ERROR: merge: Shard %d/%d given more than once\n", shard, shards);
+			bad = 1;
+		}
+	}
+	if (seen == NULL) return 1;
+	for (i = 0; i < shards; i++) {
+		if (!seen[i]) {
+			fprintf(stderr, "ERROR: merge: Shard %d/%d is missing\n", i, shards);
+			bad = 1;
+		}
+	}
+
+	// Group identical images under the first path with each
+	qsort(entries, entryCount, sizeof(Entry), byPath);
+	order = (int *)malloc(sizeof(int) * (entryCount ? entryCount : 1));
+	for (i = 0; i < entryCount; i++) order[i] = i;
+	sorted = entries;
+	qsort(order, entryCount, sizeof(int), byHash);
+	for (i = 0; i < entryCount; i = j) {
+		for (j = i; j < entryCount && entries[order[j]].hash == entries[order[i]].hash; j++)
+			entries[order[j]].first = order[i];
+		if (entries[order[i]].status != MOD_MISSING) ++distinct;
+	}
+	free(order);
+
+	printf("Corpus: %d modules in %d shards (manifest %016llx)\n", count, shards, manifestHash);
+	for (i = 0; i < entryCount; i++) {
+		e = &entries[i];
+		if (i > 0 && !strcmp(e->path, entries[i-1].path)) {
+			fprintf(stderr, "ERROR: merge: '%s' is in more than one shard\n", e->path);
+			bad = 1;
+		}
+		printf("%s: %s", e->path, statusNames[e->status]);
+		if (e->status != MOD_MISSING) printf(", %ld lines (%s)", e->lines, e->out);
+		if (e->status != MOD_MISSING && e->first != i) printf(", same image as %s", entries[e->first].path);
+		printf("\n");
+		++counts[e->status];
+		lines += e->lines;
+	}
+	if (!bad && entryCount != count) {
+		fprintf(stderr, "ERROR: merge: The shards have %d of %d modules\n", entryCount, count);
+		bad = 1;
+	}
+	printf("\n%d ok, %d failed, %d missing, %d distinct images, %ld lines\n",
+		counts[MOD_OK], counts[MOD_FAILED], counts[MOD_MISSING], distinct, lines);
+
+	for (i = 0; i < entryCount; i++) {
+		free(entries[i].path);
+		free(entries[i].out);
+	}
+	free(entries);
+	free(seen);
+	return bad || counts[MOD_FAILED] || counts[MOD_MISSING];
+}
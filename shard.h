@@ -0,0 +1,37 @@
+/*
+ * shard.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef SHARD_H_
+#define SHARD_H_
+
+// A manifest lists one module path per line (blank lines and lines
+// starting with # are skipped). Shard i of n is the modules whose path
+// hashes to i modulo n, so any number of processes or machines can each
+// take a shard of the same manifest without talking to each other.
+//
+// Each module's disassembly is written to outDir, named after its path
+// with / replaced by _, and the shard's index to outDir/shard-i-of-n.idx:
+//
+//   # diffdasm shard i/n <modules in manifest> <manifest hash> <options hash>
+//   <status> <image hash> <image bytes> <output lines> <output file> <path>
+//
+// one tab separated line per module in manifest order, status being ok,
+// failed (exit status was non-zero) or missing (the module can't be read).
+
+// "diffdasm --manifest <file> [--shard i/n] [--out dir]"
+// Disassemble a shard of a manifest, up to jobs modules at a time, by
+// calling runModule in a process per module. Returns non-zero if any
+// module failed.
+int shard_run(char *manifestName, int shard, int shards, char *outDir, int jobs);
+
+// "diffdasm merge <index>..."
+// Combine shard indexes into one corpus report on stdout. Returns non-zero
+// if shards are missing, duplicated or from different manifests, or any
+// module failed.
+int merge_main(int argc, char **argv);
+
+#endif /* SHARD_H_ */
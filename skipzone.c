@@ -0,0 +1,90 @@
+/*
+ * skipzone.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// The entropy of a window is kept up to date as it slides, from the sum
+// of c * log2(c) over its byte histogram, so the whole image takes one
+// pass whatever the window size.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "memoryfile.h"
+#include "skipzone.h"
+
+#define SZ_WINDOW 1024		// Bytes whose entropy is measured
+#define SZ_BLOCK 256		// Bytes judged together, at the centre of a window
+#define SZ_ENTROPY 7.6		// Bits per byte; random data measures 7.8, 6809 code 6 to 7.5
+#define SZ_FILL_BLOCK 192	// $00 and $FF bytes that make a block fill
+#define SZ_FILL_RUN 32		// Length of a run of $00 or $FF that is fill
+
+unsigned char *sz_skip = NULL;
+
+static void skip(int offset, int count, int length) {
+	if (offset + count > length) count = length - offset;
+	memset(sz_skip + offset, 1, count);
+}
+
+long sz_scan(MemoryFile *mod) {
+	static double cLogC[SZ_WINDOW + 1];
+	unsigned char *image = mod->storage;
+	int count[256] = { 0 };
+	int length = mod->length, block, start, at = 0, end = 0, fill, i, c;
+	double sum = 0;
+	long skipped = 0;
+
+	sz_reset();
+	sz_skip = (unsigned char *)calloc(length + 1, 1);
+	if (sz_skip == NULL) {
+		fprintf(stderr, "ERROR: sz_scan: Insufficient memory.\n");
+		exit(1);
+	}
+	if (cLogC[2] == 0)
+		for (c = 1; c <= SZ_WINDOW; c++) cLogC[c] = c * log2(c);
+
+	// High entropy: compressed or random data
+	if (length >= SZ_WINDOW) {
+		for (block = 0; block < length; block += SZ_BLOCK) {
+			start = block + SZ_BLOCK/2 - SZ_WINDOW/2;
+			if (start < 0) start = 0;
+			if (start > length - SZ_WINDOW) start = length - SZ_WINDOW;
+			while (at < start) {
+				c = image[at++];
+				sum += cLogC[count[c] - 1] - cLogC[count[c]];
+				--count[c];
+			}
+			while (end < start + SZ_WINDOW) {
+				c = image[end++];
+				sum += cLogC[count[c] + 1] - cLogC[count[c]];
+				++count[c];
+			}
+			if (log2(SZ_WINDOW) - sum / SZ_WINDOW >= SZ_ENTROPY) skip(block, SZ_BLOCK, length);
+		}
+	}
+
+	// Mostly $00 and $FF: bitmaps, fonts, cleared tables
+	for (block = 0; block < length; block += SZ_BLOCK) {
+		for (i = block, fill = 0; i < block + SZ_BLOCK && i < length; i++)
+			if (image[i] == 0x00 || image[i] == 0xFF) ++fill;
+		if (fill >= SZ_FILL_BLOCK) skip(block, SZ_BLOCK, length);
+	}
+
+	// Runs of fill
+	for (i = 0; i < length; i = end) {
+		for (end = i + 1; end < length && image[end] == image[i]; end++);
+		if ((image[i] == 0x00 || image[i] == 0xFF) && end - i >= SZ_FILL_RUN) skip(i, end - i, length);
+	}
+
+	for (i = 0; i < length; i++) skipped += sz_skip[i];
+	return skipped;
+}
+
+void sz_reset() {
+	free(sz_skip);
+	sz_skip = NULL;
+}
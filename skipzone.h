@@ -0,0 +1,30 @@
+/*
+ * skipzone.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef SKIPZONE_H_
+#define SKIPZONE_H_
+
+#include "memoryfile.h"
+
+// Regions of an image that are clearly not code or text, found in one
+// pass over the image before speculation (--prefilter): windows whose
+// byte entropy is as high as compressed or random data, blocks mostly of
+// $00 and $FF (bitmaps, fonts), and runs of $00 or $FF fill. Speculation
+// never probes them; tracing is unaffected, and whatever isn't traced is
+// output as data.
+
+// Non-zero per image byte in a skip zone, while there are zones
+extern unsigned char *sz_skip;
+#define sz_isSkip(offset) (sz_skip && sz_skip[offset])
+
+// Find the skip zones of an image; returns the bytes they cover
+long sz_scan(MemoryFile *mod);
+
+// Forget the zones
+void sz_reset();
+
+#endif /* SKIPZONE_H_ */
@@ -15,12 +15,14 @@
 #include "intstack.h"
 #include "memoryfile.h"
 #include "memorymap.h"
+#include "outbuf.h"
 
 #include "srecord.h"
 
 extern MemoryFile input;
 extern MemoryMap map;
 extern IntStack addrStack;	// Stack of known-good execution addresses
+extern OutBuf output;		// Disassembly output
 extern int _debug;		// Non-zero to print debug information
 
 extern void usage();
@@ -103,9 +105,9 @@ int loadMHXFile(char* fName) {
 		if (_debug) printf("loadMHXFile(%s): end of S-record loading pass %d...\n", fName, pass);
 		if (pass == 1) {
 			// Stats
-			printf("Low address:  $%04X\n", lowAddress);
-			printf("High address: $%04X\n", highAddress);
-			printf("Exec address: $%04X\n", execAddress);
+			ob_printf(&output, "Low address:  $%04X\n", lowAddress);
+			ob_printf(&output, "High address: $%04X\n", highAddress);
+			ob_printf(&output, "Exec address: $%04X\n", execAddress);
 			moduleLength = highAddress - lowAddress + 1;
 			// Try to allocate memory for module(s)
 			if (_debug) printf("loadMHXFile(%s): allocating $%04X bytes for map\n", fName, (int)moduleLength);
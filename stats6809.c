@@ -11,11 +11,13 @@
 #include <string.h>
 
 #include "diffdasm.h"
+#include "emitter.h"
 #include "os9stuff.h"
 #include "memoryfile.h"
 #include "memorymap.h"
 #include "stats6809.h"
 #include "statsOS9.h"
+#include "hints.h"
 
 extern int source; // Non-zero to disassemble in source format
 extern int f9info; // Non-zero to output only code / data map info for f9dasm
@@ -1206,9 +1208,52 @@ int M6809_pcrel(MemoryFile* mod, int offset) {
 	return dest;
 }
 
-static char labelBuf[16];
+// Memory operands 16 and 32 bits wide; all others are 8 bits
+static char *words[] = { "LDD", "LDX", "LDY", "LDU", "LDS", "LDW",
+	"STD", "STX", "STY", "STU", "STS", "STW", "ADDD", "SUBD", "ADCD", "SBCD",
+	"ANDD", "ORD", "EORD", "BITD", "ADDW", "SUBW", "CMPD", "CMPX", "CMPY",
+	"CMPU", "CMPS", "CMPW", "MULD", "DIVQ", NULL };
+
+int M6809_width(Decoded* d) {
+	char **w;
+	if (d->inst == NULL || !(d->inst->flags & HAS_6809)) return 0;
+	switch (d->mode) {
+		case	IOFFSET_0:
+		case	IOFFSET_8:
+		case	IOFFSET_16:
+		case	IOFFSET_A:
+		case	IOFFSET_B:
+		case	IOFFSET_D:
+		case	IOFFSET_E:
+		case	IOFFSET_F:
+		case	IOFFSET_W:
+		case	IPOSTINC_2:
+		case	IPREDEC_2:
+		case	IPCR_8:
+		case	IPCR_16:
+		case	IEXTENDED:
+			// Indirect: the operand address holds a pointer, even for JMP and LEA
+			return 2;
+		case	DIRECT:
+		case	EXTENDED:
+			break;
+		default:
+			if (d->mode < OFFSET_0 || d->mode > PCR_16) return 0;
+			break;
+	}
+	if (!strncmp(d->inst->mnemonic, "LEA", 3) || !strcmp(d->inst->mnemonic, "JMP")
+			|| !strcmp(d->inst->mnemonic, "JSR")) return 0;
+	if (!strcmp(d->inst->mnemonic, "LDQ") || !strcmp(d->inst->mnemonic, "STQ")) return 4;
+	for (w = words; *w; w++)
+		if (!strcmp(d->inst->mnemonic, *w)) return 2;
+	return 1;
+}
+
+static __thread char labelBuf[16];
 char* M6809_label(MemoryMap* map, int offset) {
+	char *name;
 	if (mm_isLabel(map, offset)) {
+		if ((name = hints_name(offset))) return name;
 		sprintf(labelBuf, "L%04X", (offset + map->abs_base) & 0xFFFF);
 		return labelBuf;
 	}
@@ -1284,10 +1329,14 @@ char *modeNames[] = {
 	"IPCR_16",		"IEXTENDED",	"IDXINVALID"
 };
 
+// Codes $C-$F aren't 6809 registers. Earlier builds indexed past the
+// end of a 12-entry table and picked up the stacking names below, so
+// those are spelled out here to keep existing disassemblies diffable.
 char *tregNames[] = {
 	"D",	"X",	"Y",	"U",
 	"S",	"PC",	"",		"",
-	"A",	"B",	"CC",	"DP"
+	"A",	"B",	"CC",	"DP",
+	"CC",	"A",	"B",	"DP"
 };
 
 // When using U as stack, U here becomes S
@@ -1304,309 +1353,561 @@ char* M6809_modeName(MemoryFile* mod, int offset) {
 	return modeNames[M6809_mode(mod, offset)];
 }
 
-char* M6809_iregName(int postbyte) {
-	return iregNames[(postbyte>>5) & 0x03];
+
+//
+// Table-driven operand formatting
+//
+// Each addressing mode (including the indexed sub-modes) maps to a
+// formatter that writes straight into the output buffer from the fields
+// already pulled out by M6809_decode. Register lists for the stacking
+// instructions and register pairs for TFR / EXG are built once into
+// 256-entry tables, so most operands are a table lookup and a memcpy.
+//
+
+typedef struct RegText {
+	unsigned char length;
+	char text[23];
+} RegText;
+
+typedef char* (*OperandFormatter)(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel);
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+static RegText pushRegs[2][256];	// PSHS, PSHU
+static RegText pullRegs[2][256];	// PULS, PULU
+static RegText pairRegs[256];		// TFR, EXG
+static int regTablesBuilt = 0;
+
+static char* put_text(char *p, const char *text, int length) {
+	memcpy(p, text, length);
+	return p + length;
 }
 
-char* M6809_indir1(char *p, int mode) {
-	if (mode >= IOFFSET_0) *p++ = '[';
-	*p = '\0';
-	return p;
+static char* put_str(char *p, const char *text) {
+	return put_text(p, text, strlen(text));
 }
 
-char* M6809_indir2(char *p, int mode) {
-	if (mode >= IOFFSET_0) *p++ = ']';
-	*p = '\0';
+static char* put_reg(char *p, RegText *r) {
+	return put_text(p, r->text, r->length);
+}
+
+// Same as "%0*X" with at most 8 digits
+static char* put_hex(char *p, unsigned value, int minDigits) {
+	int digits = 1;
+	while (digits < 8 && (value >> (digits * 4))) ++digits;
+	if (digits < minDigits) digits = minDigits;
+	for (int i = digits - 1; i >= 0; --i) {
+		*p++ = hexDigits[(value >> (i * 4)) & 0x0F];
+	}
 	return p;
 }
 
-void append_postbytes(char* buffer, MemoryFile* mod, MemoryMap* map, int offset, int count) {
-    *buffer = 0;
-    for (int delta = 1; delta <= count; delta++) {
-        sprintf(buffer, "#$%02X", mf_get_byte(mod, offset + delta));
-        // TODO: set these bytes as FDB in the map
-        buffer += 4;
-        if (delta != count) {
-            *buffer++ = ',';
-            *buffer = 0;
-        }
-    }
+static void reg_append(RegText *r, const char *name) {
+	if (r->length) r->text[r->length++] = ',';
+	r->length = put_str(r->text + r->length, name) - r->text;
+	r->text[r->length] = '\0';
 }
 
-char* M6809_operands(char* buffer, MemoryFile* mod, MemoryMap* map, int offset) {
-	int postbyte, v, i, eff;
-	int mode = M6809_mode(mod, offset);
-	int length = M6809_bytes(mod, offset);
-	char *label, *postLabel = NULL;
-	char *p = buffer;
-	p = M6809_indir1(buffer, mode);
-	switch (mode) {
-		case	DIRECT:
-			// OK to show direct page references whether source or not
-			sprintf(p, "<$%02X", mod->storage[offset+length-1]);
-			break;
-		case	INHERENT:
-			if (mod->storage[offset+0] == SWI_1) {
-				// Display postbytes if needed
-                append_postbytes(p, mod, map, offset, swipb);
-			} else if ((mod->storage[offset+0] == SWI2_1) && (mod->storage[offset+1] == SWI2_2)) {
-                if (is_os9) {
-                    // OS9 system call has pseudo-operand
-                    sprintf(p, "%s", OS9_svcName(mod, offset));
-                } else {
-                    // Display postbytes if needed
-                    append_postbytes(p, mod, map, offset, swipb);
-                }
-            } else if ((mod->storage[offset+0] == SWI3_1) && (mod->storage[offset+1] == SWI3_2)) {
-                // Display postbytes if needed
-                append_postbytes(p, mod, map, offset, swipb);
-            }
-			break;
-		case	REL_8:
-			if (source) {
-				eff = M6809_pcrel(mod, offset);
-				if((label=M6809_label(map, eff))) {
-					sprintf(p, "%s", label);
-					break;
-				}
-				// Destination was not previously declared a label
-				mm_setLabel(map, eff, 1);
-				postLabel = M6809_labelUnbounded(map, eff);
-				postbyte = mod->storage[offset+length-1];
-				if (postbyte & 0b10000000) {
-					sprintf(p, "*-$%02X", (~postbyte+1) & 0b01111111);
-				} else {
-					sprintf(p, "*+$%02X", postbyte);
-				}
-			} else {
-				sprintf(p, "__");
-			}
-			break;
-		case	REL_16:
-			if (source) {
-				eff = M6809_pcrel(mod, offset);
-				if((label=M6809_label(map, eff))) {
-					sprintf(p, "%s", label);
-					break;
-				}
-				// Destination was not previously declared a label
-				mm_setLabel(map, eff, 1);
-				postLabel = M6809_labelUnbounded(map, eff);
-				postbyte = M6809_get16(mod, offset+length-2);
-				if (postbyte & 0b1000000000000000) {
-					sprintf(p, "*-$%02X", (~postbyte+1) & 0b0111111111111111);
-				} else {
-					sprintf(p, "*+$%02X", postbyte);
-				}
-			} else {
-				sprintf(p, "__");
-			}
-			break;
-		case	IMMED_8:
-			// Probably OK to show immediates whether source or not
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, "#$%02X", postbyte);
-			break;
-		case	IMMED_16:
-			// Probably OK to show immediates whether source or not
-			postbyte = M6809_get16(mod, offset+length-2);
-			sprintf(p, "#$%04X", postbyte);
-			break;
-		case	IMMED_32:
-			// Probably OK to show immediates whether source or not
-			postbyte = M6809_get16(mod, offset+length-4) << 16;
-			postbyte |= M6809_get16(mod, offset+length-2);
-			sprintf(p, "<$%08X", postbyte);
-			break;
-		case	REGISTER:
-			// OK to show register operations whether source or not
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, "%s,%s", tregNames[postbyte>>4], tregNames[postbyte & TREG_MASK]);
-			break;
-		case	EXTENDED:
-		case	IEXTENDED:
-			// Probably OK to show absolute references whether source or not
-			postbyte = M6809_get16(mod, offset+length-2);
-			sprintf(p, "$%04X", postbyte);
-			break;
-		case	REG_PULL_S:
-		case	REG_PULL_U:
-			// OK to show register stacking operations whether source or not
-			postbyte = mod->storage[offset+length-1];
+// Build the register list and register pair tables
+void M6809_buildRegTables() {
+	int postbyte, pb, i, u;
+	for (u = 0; u < 2; u++) {
+		for (postbyte = 0; postbyte < 256; postbyte++) {
+			// Pulls come off in CC..PC order; D is shown for A+B
+			RegText *r = &pullRegs[u][postbyte];
+			r->length = 0;
+			pb = postbyte;
 			for (i=0; i<8; i++) {
-				if (postbyte & 1) {
-					if (p!=buffer) {
-						*p++ = ',';
-					}
-					if ((i==1) && (postbyte & 2)) {
-						*p++ = 'D';
-						*p = '\0';
-						postbyte >>= 1;
+				if (pb & 1) {
+					if ((i==1) && (pb & 2)) {
+						reg_append(r, "D");
+						pb >>= 1;
 						i++;
-					} else if ((i==6) && (mode==REG_PULL_U)) {
-						*p++ = 'U';
-						*p = '\0';
+					} else if ((i==6) && u) {
+						reg_append(r, "U");
 					} else {
-						strcpy(p, pregNames[i]);
-						p += strlen(p);
+						reg_append(r, pregNames[i]);
 					}
 				}
-				postbyte >>= 1;
+				pb >>= 1;
 			}
-			break;
-		case	REG_PUSH_S:
-		case	REG_PUSH_U:
-			// OK to show register stacking operations whether source or not
-			postbyte = mod->storage[offset+length-1];
+			// Pushes go on in PC..CC order; D is shown for B+A
+			r = &pushRegs[u][postbyte];
+			r->length = 0;
+			pb = postbyte;
 			for (i=7; i>=0; --i) {
-				if (postbyte & 0b10000000) {
-					if (p!=buffer) {
-						*p++ = ',';
-					}
-					if ((i==2) && (postbyte & 0b01000000)) {
-						*p++ = 'D';
-						*p = '\0';
-						postbyte <<= 1;
+				if (pb & 0b10000000) {
+					if ((i==2) && (pb & 0b01000000)) {
+						reg_append(r, "D");
+						pb <<= 1;
 						--i;
-					} else if ((i==6) && (mode==REG_PUSH_U)) {
-						*p++ = 'U';
-						*p = '\0';
+					} else if ((i==6) && u) {
+						reg_append(r, "U");
 					} else {
-						strcpy(p, pregNames[i]);
-						p += strlen(p);
+						reg_append(r, pregNames[i]);
 					}
 				}
-				postbyte <<= 1;
+				pb <<= 1;
+			}
+		}
+	}
+	for (postbyte = 0; postbyte < 256; postbyte++) {
+		RegText *r = &pairRegs[postbyte];
+		r->length = put_str(r->text, tregNames[postbyte>>4]) - r->text;
+		r->text[r->length++] = ',';
+		r->length = put_str(r->text + r->length, tregNames[postbyte & TREG_MASK]) - r->text;
+		r->text[r->length] = '\0';
+	}
+	regTablesBuilt = 1;
+}
+
+static char* fmt_invalid(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	p = put_str(p, modeNames[d->mode]);
+	for (int i=0; i<d->bytes; i++) {
+		*p++ = ' ';
+		p = put_hex(p, mod->storage[d->offset+i], 2);
+	}
+	return p;
+}
+
+static char* fmt_direct(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	// OK to show direct page references whether source or not
+	*p++ = '<';
+	*p++ = '$';
+	return put_hex(p, d->value, 2);
+}
+
+// Display SWI postbytes as immediates
+static char* put_postbytes(char *p, MemoryFile* mod, int offset, int count) {
+	for (int delta = 1; delta <= count; delta++) {
+		*p++ = '#';
+		*p++ = '$';
+		p = put_hex(p, mf_get_byte(mod, offset + delta), 2);
+		if (delta != count) *p++ = ',';
+	}
+	return p;
+}
+
+static char* fmt_inherent(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	unsigned char *s = mod->storage + d->offset;
+	if (s[0] == SWI_1) {
+		p = put_postbytes(p, mod, d->offset, swipb);
+	} else if ((s[0] == SWI2_1) && (s[1] == SWI2_2)) {
+		if (is_os9) {
+			// OS9 system call has pseudo-operand
+			p = put_str(p, OS9_svcName(mod, d->offset));
+		} else {
+			p = put_postbytes(p, mod, d->offset, swipb);
+		}
+	} else if ((s[0] == SWI3_1) && (s[1] == SWI3_2)) {
+		p = put_postbytes(p, mod, d->offset, swipb);
+	}
+	return p;
+}
+
+// Show a label for a PC relative destination if one is known; otherwise
+// show the offset, with the label in the comment
+static int put_pcrLabel(char **pp, Decoded *d, MemoryMap* map, char **postLabel) {
+	char *label = d->newLabel ? NULL : M6809_label(map, d->eff);
+	if (label) {
+		*pp = put_str(*pp, label);
+		return 1;
+	}
+	*postLabel = M6809_labelUnbounded(map, d->eff);
+	return 0;
+}
+
+static char* fmt_rel8(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (!source) return put_text(p, "__", 2);
+	if (put_pcrLabel(&p, d, map, postLabel)) return p;
+	if (d->value & 0b10000000) {
+		p = put_text(p, "*-$", 3);
+		return put_hex(p, (~d->value+1) & 0b01111111, 2);
+	}
+	p = put_text(p, "*+$", 3);
+	return put_hex(p, d->value, 2);
+}
+
+static char* fmt_rel16(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (!source) return put_text(p, "__", 2);
+	if (put_pcrLabel(&p, d, map, postLabel)) return p;
+	if (d->value & 0b1000000000000000) {
+		p = put_text(p, "*-$", 3);
+		return put_hex(p, (~d->value+1) & 0b0111111111111111, 2);
+	}
+	p = put_text(p, "*+$", 3);
+	return put_hex(p, d->value, 2);
+}
+
+static char* fmt_pcr8(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (!source) return put_text(p, "__,PCR", 6);
+	if (!put_pcrLabel(&p, d, map, postLabel)) {
+		if (d->value & 0b10000000) {
+			p = put_text(p, "*-$", 3);
+			p = put_hex(p, (~d->value+1) & 0b011111111, 2);
+		} else {
+			p = put_text(p, "*+$", 3);
+			p = put_hex(p, d->value, 2);
+		}
+	}
+	return put_text(p, ",PCR", 4);
+}
+
+static char* fmt_pcr16(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (!source) return put_text(p, "__,PCR", 6);
+	if (!put_pcrLabel(&p, d, map, postLabel)) {
+		if (d->value & 0b1000000000000000) {
+			p = put_text(p, "*-$", 3);
+			p = put_hex(p, (~d->value+1) & 0b01111111111111111, 4);
+		} else {
+			p = put_text(p, "*+$", 3);
+			p = put_hex(p, d->value, 4);
+		}
+	}
+	return put_text(p, ",PCR", 4);
+}
+
+static char* fmt_immed8(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = '#';
+	*p++ = '$';
+	return put_hex(p, d->value, 2);
+}
+
+static char* fmt_immed16(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = '#';
+	*p++ = '$';
+	return put_hex(p, d->value, 4);
+}
+
+static char* fmt_immed32(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = '<';
+	*p++ = '$';
+	return put_hex(p, d->value, 8);
+}
+
+static char* fmt_register(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	return put_reg(p, &pairRegs[d->postbyte]);
+}
+
+static char* fmt_extended(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = '$';
+	return put_hex(p, d->value, 4);
+}
+
+static char* fmt_pulls(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	return put_reg(p, &pullRegs[0][d->postbyte]);
+}
+
+static char* fmt_pullu(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	return put_reg(p, &pullRegs[1][d->postbyte]);
+}
+
+static char* fmt_pushs(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	return put_reg(p, &pushRegs[0][d->postbyte]);
+}
+
+static char* fmt_pushu(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	return put_reg(p, &pushRegs[1][d->postbyte]);
+}
+
+static char* put_ireg(char *p, int postbyte) {
+	*p++ = *iregNames[(postbyte>>5) & 0x03];
+	return p;
+}
+
+static char* fmt_offset0(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = ',';
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_offset5(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (d->value & 0b00010000) {
+		*p++ = '-';
+		*p++ = '$';
+		p = put_hex(p, (~d->value+1) & 0b00011111, 1);
+	} else {
+		*p++ = '$';
+		p = put_hex(p, d->value, 1);
+	}
+	*p++ = ',';
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_offset8(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (d->value & 0b10000000) {
+		*p++ = '-';
+		*p++ = '$';
+		p = put_hex(p, (~d->value+1) & 0b011111111, 1);
+	} else {
+		*p++ = '$';
+		p = put_hex(p, d->value, 1);
+	}
+	*p++ = ',';
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_offset16(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	if (d->value & 0b1000000000000000) {
+		*p++ = '-';
+		*p++ = '$';
+		p = put_hex(p, (~d->value+1) & 0b01111111111111111, 1);
+	} else {
+		*p++ = '$';
+		p = put_hex(p, d->value, 1);
+	}
+	*p++ = ',';
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_offsetA(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	p = put_text(p, "A,", 2);
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_offsetB(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	p = put_text(p, "B,", 2);
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_offsetD(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	p = put_text(p, "D,", 2);
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_postinc1(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = ',';
+	p = put_ireg(p, d->postbyte);
+	*p++ = '+';
+	return p;
+}
+
+static char* fmt_postinc2(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	*p++ = ',';
+	p = put_ireg(p, d->postbyte);
+	return put_text(p, "++", 2);
+}
+
+static char* fmt_predec1(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	p = put_text(p, ",-", 2);
+	return put_ireg(p, d->postbyte);
+}
+
+static char* fmt_predec2(char *p, Decoded *d, MemoryFile* mod, MemoryMap* map, char **postLabel) {
+	p = put_text(p, ",--", 3);
+	return put_ireg(p, d->postbyte);
+}
+
+// One formatter per addressing mode; anything not listed is shown raw
+static OperandFormatter formatters[0x40] = {
+	[DIRECT]		= fmt_direct,
+	[PREBYTE10]		= fmt_invalid,
+	[PREBYTE11]		= fmt_invalid,
+	[INHERENT]		= fmt_inherent,
+	[INVALID]		= fmt_invalid,
+	[REL_8]			= fmt_rel8,
+	[REL_16]		= fmt_rel16,
+	[IMMED_8]		= fmt_immed8,
+	[IMMED_16]		= fmt_immed16,
+	[IMMED_32]		= fmt_immed32,
+	[REGISTER]		= fmt_register,
+	[INDEXED]		= fmt_invalid,
+	[EXTENDED]		= fmt_extended,
+	[SINGLE_BIT]	= fmt_invalid,
+	[WINDEXED]		= fmt_invalid,
+	[REG_PULL_S]	= fmt_pulls,
+	[REG_PULL_U]	= fmt_pullu,
+	[REG_PUSH_S]	= fmt_pushs,
+	[REG_PUSH_U]	= fmt_pushu,
+
+	[OFFSET_0]		= fmt_offset0,
+	[OFFSET_5]		= fmt_offset5,
+	[OFFSET_8]		= fmt_offset8,
+	[OFFSET_16]		= fmt_offset16,
+	[OFFSET_A]		= fmt_offsetA,
+	[OFFSET_B]		= fmt_offsetB,
+	[OFFSET_D]		= fmt_offsetD,
+	[OFFSET_E]		= fmt_invalid,
+	[OFFSET_F]		= fmt_invalid,
+	[OFFSET_W]		= fmt_invalid,
+	[POSTINC_1]		= fmt_postinc1,
+	[POSTINC_2]		= fmt_postinc2,
+	[PREDEC_1]		= fmt_predec1,
+	[PREDEC_2]		= fmt_predec2,
+	[PCR_8]			= fmt_pcr8,
+	[PCR_16]		= fmt_pcr16,
+	[IOFFSET_0]		= fmt_offset0,
+	[IOFFSET_8]		= fmt_offset8,
+	[IOFFSET_16]	= fmt_offset16,
+	[IOFFSET_A]		= fmt_offsetA,
+	[IOFFSET_B]		= fmt_offsetB,
+	[IOFFSET_D]		= fmt_offsetD,
+	[IOFFSET_E]		= fmt_invalid,
+	[IOFFSET_F]		= fmt_invalid,
+	[IOFFSET_W]		= fmt_invalid,
+	[IPOSTINC_2]	= fmt_postinc2,
+	[IPREDEC_2]		= fmt_predec2,
+	[IPCR_8]		= fmt_pcr8,
+	[IPCR_16]		= fmt_pcr16,
+	[IEXTENDED]		= fmt_extended,
+	[IDXINVALID]	= fmt_invalid
+};
+
+void M6809_decode(MemoryFile* mod, int offset, Decoded* d) {
+	// One pass over the tables, giving what M6809_mode, M6809_bytes,
+	// M6809_flags, M6809_transfer and M6809_pcrel would, without decoding
+	// again for each
+	unsigned char *s = mod->storage + offset;
+	Instruction *i = &page00[s[0]];
+	int at = offset;		// Opcode offset, after any prebyte
+	int bytes = 1, extra;
+
+	d->offset = offset;
+	d->newLabel = 0;
+	d->flags = i->flags;
+	d->mode = INVALID;
+	if (i->flags & HAS_6809) {
+		if (i->mode == PREBYTE10 || i->mode == PREBYTE11) {
+			i = (i->mode == PREBYTE10) ? &page10[s[1]] : &page11[s[1]];
+			at = offset + 1;
+			d->flags = i->flags;
+		}
+		d->mode = i->mode;
+		if (i->mode == INDEXED) {
+			// Opcode followed immediately by indexing mode byte
+			d->mode = (at == mod->length) ? INVALID : M6809_pbIndexMode(mod, at + 1);
+		}
+		if (i->flags & HAS_6809) {
+			bytes = i->bytes;
+			if (i->mode == INDEXED) {
+				extra = (d->mode == INVALID) ? -1 : idxExtra[d->mode & 0x1F];
+				bytes = (extra == -1) ? 1 : bytes + extra;
+			}
+			// Postbytes skipped after SWI, SWI2 (OS9 calls) and SWI3
+			if (at == offset && s[0] == SWI_1) bytes += swipb;
+			else if (at != offset && s[0] == 0x10 && s[1] == SWI2_2) bytes += swi2pb;
+			else if (at != offset && s[0] == 0x11 && s[1] == SWI3_2) bytes += swi3pb;
+		}
+		if (at == offset) {
+			// EXG and TFR to PC, and PULS and PULU of PC, end a run
+			switch (s[0]) {
+				case 0x1E: // EXG
+					if ((s[1] & TREG_MASK) == TREG_PC || (s[1] & (TREG_MASK<<4)) == (TREG_PC<<4)) d->flags |= LEAF;
+					break;
+				case 0x1F: // TFR
+					if ((s[1] & TREG_MASK) == TREG_PC) d->flags |= LEAF;
+					break;
+				case 0x35: // PULS
+				case 0x37: // PULU
+					if (s[1] & PREG_PC) d->flags |= LEAF;
+					break;
 			}
+		}
+	}
+	if (offset + bytes > mod->length) {
+		// Not enough postbytes available
+		bytes = 1;
+	}
+	d->bytes = bytes;
+	d->inst = i;
+
+	// Control transfer destination, or PC relative effective address
+	d->eff = -1;
+	if (d->flags & TRANSFER) {
+		if ((s[0] >= 0x20 && s[0] < 0x30) || s[0] == 0x8D)
+			d->eff = offset + bytes + (signed char)s[1];
+		else if (s[0] == 0x16 || s[0] == 0x17)
+			d->eff = offset + bytes + (short)M6809_get16(mod, offset+1);
+		else if (s[0] == 0x10 && s[1] >= 0x21 && s[1] < 0x30)
+			d->eff = offset + bytes + (short)M6809_get16(mod, offset+2);
+	}
+	d->dest = d->eff;
+	if (d->eff == -1) {
+		switch (d->mode) {
+			case	REL_8:
+			case	PCR_8:
+			case	IPCR_8:
+				d->eff = (offset + bytes + (signed char)s[bytes-1]) & 0xFFFF;
+				break;
+			case	REL_16:
+			case	PCR_16:
+			case	IPCR_16:
+				d->eff = (offset + bytes + (short)M6809_get16(mod, offset+bytes-2)) & 0xFFFF;
+				break;
+		}
+	}
+
+	// Pull out the operand fields from the end of the instruction
+	s += d->bytes;
+	d->postbyte = s[-1];
+	d->value = 0;
+	switch (d->mode) {
+		case	DIRECT:
+		case	IMMED_8:
+		case	REL_8:
+		case	PCR_8:
+		case	IPCR_8:
+			d->value = s[-1];
 			break;
-		case	OFFSET_0:
-		case	IOFFSET_0:
-			// OK to show zero offsets whether source or not
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, ",%s", M6809_iregName(postbyte));
+		case	IMMED_16:
+		case	EXTENDED:
+		case	IEXTENDED:
+		case	REL_16:
+		case	PCR_16:
+		case	IPCR_16:
+			d->value = (s[-2] << 8) | s[-1];
+			break;
+		case	IMMED_32:
+			d->value = ((unsigned)s[-4] << 24) | (s[-3] << 16) | (s[-2] << 8) | s[-1];
 			break;
 		case	OFFSET_5:
-			// OK to show offsets that aren't PCR whether source or not
-			postbyte = mod->storage[offset+length-1];
-			v = postbyte & 0b00011111;
-			if (v & 0b00010000) {
-				sprintf(p, "-$%X,%s", (~v+1) & 0b00011111, M6809_iregName(postbyte));
-			} else {
-				sprintf(p, "$%X,%s", v, M6809_iregName(postbyte));
-			}
+			d->value = s[-1] & 0b00011111;
 			break;
 		case	OFFSET_8:
 		case	IOFFSET_8:
-			// OK to show offsets that aren't PCR whether source or not
-			postbyte = mod->storage[offset+length-2];
-			v = mod->storage[offset+length-1];
-			if (v & 0b10000000) {
-				sprintf(p, "-$%X,%s", (~v+1) & 0b011111111, M6809_iregName(postbyte));
-			} else {
-				sprintf(p, "$%X,%s", v, M6809_iregName(postbyte));
-			}
+			d->postbyte = s[-2];
+			d->value = s[-1];
 			break;
 		case	OFFSET_16:
 		case	IOFFSET_16:
-			// OK to show offsets that aren't PCR whether source or not
-			postbyte = mod->storage[offset+length-3];
-			v = M6809_get16(mod, offset+length-2);
-			if (v & 0b1000000000000000) {
-				sprintf(p, "-$%X,%s", (~v+1) & 0b01111111111111111, M6809_iregName(postbyte));
-			} else {
-				sprintf(p, "$%X,%s", v, M6809_iregName(postbyte));
-			}
-			break;
-		case	OFFSET_A:
-		case	IOFFSET_A:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, "A,%s", M6809_iregName(postbyte));
-			break;
-		case	OFFSET_B:
-		case	IOFFSET_B:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, "B,%s", M6809_iregName(postbyte));
-			break;
-		case	OFFSET_D:
-		case	IOFFSET_D:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, "D,%s", M6809_iregName(postbyte));
-			break;
-		case	POSTINC_1:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, ",%s+", M6809_iregName(postbyte));
+			d->postbyte = s[-3];
+			d->value = (s[-2] << 8) | s[-1];
 			break;
-		case	POSTINC_2:
-		case	IPOSTINC_2:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, ",%s++", M6809_iregName(postbyte));
-			break;
-		case	PREDEC_1:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, ",-%s", M6809_iregName(postbyte));
-			break;
-		case	PREDEC_2:
-		case	IPREDEC_2:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, ",--%s", M6809_iregName(postbyte));
-			break;
-		case	PCR_8:
-		case	IPCR_8:
-			if (source) {
-				eff = M6809_pcrel(mod, offset);
-				if((label=M6809_label(map, eff))) {
-					sprintf(p, "%s,PCR", label);
-					break;
-				}
-				// Destination was not previously declared a label
-				mm_setLabel(map, eff, 1);
-				postLabel = M6809_labelUnbounded(map, eff);
-				postbyte = mod->storage[offset+length-1];
-				if (postbyte & 0b10000000) {
-					sprintf(p, "*-$%02X,PCR", (~postbyte+1) & 0b011111111);
-				} else {
-					sprintf(p, "*+$%02X,PCR", postbyte);
-				}
-			} else {
-				sprintf(p, "__,PCR");
-			}
-			break;
-		case	PCR_16:
-		case	IPCR_16:
-			if (source) {
-				eff = M6809_pcrel(mod, offset);
-				if((label=M6809_label(map, eff))) {
-					sprintf(p, "%s,PCR", label);
-					break;
-				}
-				// Destination was not previously declared a label
-				mm_setLabel(map, eff, 1);
-				postLabel = M6809_labelUnbounded(map, eff);
-				postbyte = M6809_get16(mod, offset+length-2);
-				if (postbyte & 0b1000000000000000) {
-					sprintf(p, "*-$%04X,PCR", (~postbyte+1) & 0b01111111111111111);
-				} else {
-					sprintf(p, "*+$%04X,PCR", postbyte);
-				}
-			} else {
-				sprintf(p, "__,PCR");
-			}
-			break;
-		case	IDXINVALID:
 		default:
-			postbyte = mod->storage[offset+length-1];
-			sprintf(p, "%s", M6809_modeName(mod, offset));
-			p = buffer + strlen(buffer);
-			for (i=0; i<length; i++) {
-				sprintf(p, " %02X", mod->storage[offset+i]);
-				p += strlen(p);
-			}
 			break;
 	}
-	p = M6809_indir2(p+strlen(p), mode);
+}
+
+char* M6809_mnemonic(MemoryFile* mod, Decoded* d) {
+	unsigned char *s = mod->storage + d->offset;
+	if (!(page00[s[0]].flags & HAS_6809)) return "???";
+	if ((s[0] == SWI2_1) && (s[1] == SWI2_2)) {
+		// OS9 system call has pseudo-opcode
+		return "OS9";
+	}
+	if (source || !d->inst->altMnemonic) return d->inst->mnemonic;
+	return d->inst->altMnemonic;
+}
+
+char* M6809_formatOperands(char* buffer, Decoded* d, MemoryFile* mod, MemoryMap* map) {
+	OperandFormatter formatter = formatters[d->mode & 0x3F];
+	char *postLabel = NULL;
+	char *p = buffer;
+	int indirect = (d->mode >= IOFFSET_0);
+
+	if (!regTablesBuilt) M6809_buildRegTables();
+	if (!formatter) formatter = fmt_invalid;
+	if (indirect) *p++ = '[';
+	p = formatter(p, d, mod, map, &postLabel);
+	if (indirect) *p++ = ']';
+	*p = '\0';
 	if (source && postLabel) {
 		appendComment(postLabel);
 	}
-    return buffer;
+	return buffer;
 }
 
+char* M6809_operands(char* buffer, MemoryFile* mod, MemoryMap* map, int offset) {
+	Decoded d;
+	M6809_decode(mod, offset, &d);
+	return M6809_formatOperands(buffer, &d, mod, map);
+}
@@ -19,6 +19,20 @@ typedef struct Instruction {
 	unsigned short	flags;
 } Instruction;
 
+// An instruction decoded once for formatting
+typedef struct Decoded {
+	int offset;				// Offset of the first instruction byte
+	Instruction *inst;		// Table entry for the opcode (after any prebyte)
+	int mode;				// Addressing mode, as M6809_mode
+	short bytes;			// Instruction length, as M6809_bytes
+	unsigned char flags;	// As M6809_flags
+	unsigned char postbyte;	// Register, stacking, or index postbyte
+	int value;				// Immediate, direct, offset, or address operand
+	int eff;				// PC relative effective address, as M6809_pcrel
+	int dest;				// Control transfer destination, as M6809_transfer
+	int newLabel;			// Non-zero if this instruction introduces the label at eff
+} Decoded;
+
 // Addressing modes
 // Note that for INDEXED, PREBYTE10, and PREBYTE11 the byte count is incorrect
 #define	DIRECT		0x00
@@ -151,6 +165,25 @@ char* M6809_opcode(MemoryFile* mod, int offset);
 // Return the addressing mode name of the instruction
 char* M6809_modeName(MemoryFile* mod, int offset);
 
+// Build the register list tables used for formatting (done on first use
+// if not called, but must be called before formatting on several threads)
+void M6809_buildRegTables();
+
+// Decode the instruction at the specified offset for formatting
+void M6809_decode(MemoryFile* mod, int offset, Decoded* d);
+
+// Return the bytes a decoded instruction reads or writes at its operand
+// address: 1, 2 or 4, 2 for any indirect pointer, and 0 if it doesn't
+// address memory (immediate, register, or inherent operands, JMP, JSR,
+// LEA). The address itself is only known for extended and PCR modes.
+int M6809_width(Decoded* d);
+
+// Return the opcode of a decoded instruction
+char* M6809_mnemonic(MemoryFile* mod, Decoded* d);
+
+// Write the operands of a decoded instruction into buffer
+char* M6809_formatOperands(char* buffer, Decoded* d, MemoryFile* mod, MemoryMap* map);
+
 // Return operands of the instruction
 char* M6809_operands(char* buffer, MemoryFile* mod, MemoryMap* map, int offset);
 
@@ -0,0 +1,99 @@
+/*
+ * stringtab.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// Each byte is classified once through a 256 entry table, and the run
+// lengths come from the byte after, so the pass is backwards.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "memoryfile.h"
+#include "stringtab.h"
+
+#define ST_FCS		1	// Allowed in an FCS string (as couldBeString)
+#define ST_END		2	// Ends an FCS string
+#define ST_PLAIN	4	// Printable, in FCC text
+
+static unsigned char classes[256];
+static int *fcsRun = NULL;		// st_fcs for each offset
+static int *textRun = NULL;		// ST_PLAIN bytes from each offset
+static int tableLength = 0;
+
+static void classify() {
+	int b;
+	for (b = 0; b < 256; b++) {
+		int cc = b & 0x7F;
+		if (cc >= 0x20 || cc == '\n' || cc == '\r' || b == '\t' || b == 0x1B) {
+			classes[b] |= ST_FCS;
+			if (b & 0x80) classes[b] |= ST_END;
+		}
+		if ((b >= 0x20 && b < 0x7F) || b == '\t') classes[b] |= ST_PLAIN;
+	}
+}
+
+void st_build(MemoryFile *mod) {
+	unsigned char *image = mod->storage;
+	int i, c, length = mod->length;
+
+	if (!classes['A']) classify();
+	st_reset();
+	fcsRun = (int *)malloc(sizeof(int) * (length + 1));
+	textRun = (int *)malloc(sizeof(int) * (length + 1));
+	if (fcsRun == NULL || textRun == NULL) {
+		fprintf(stderr, "ERROR: st_build: Insufficient memory.\n");
+		exit(1);
+	}
+	fcsRun[length] = textRun[length] = 0;
+	for (i = length - 1; i >= 0; i--) {
+		c = classes[image[i]];
+		if (!(c & ST_FCS)) fcsRun[i] = 0;
+		else if ((c & ST_END) || i + 1 == length) fcsRun[i] = 1;
+		else fcsRun[i] = fcsRun[i+1] ? fcsRun[i+1] + 1 : 0;
+		textRun[i] = (c & ST_PLAIN) ? textRun[i+1] + 1 : 0;
+	}
+	tableLength = length;
+}
+
+void st_reset() {
+	free(fcsRun);
+	free(textRun);
+	fcsRun = textRun = NULL;
+	tableLength = 0;
+}
+
+int st_built() {
+	return fcsRun != NULL;
+}
+
+int st_fcs(int offset) {
+	return fcsRun[offset];
+}
+
+int st_text(MemoryFile *mod, int offset, int *prefix, int *zero) {
+	unsigned char *image = mod->storage;
+	int n = textRun[offset], end = offset + n, letters, i;
+
+	*prefix = *zero = 0;
+	if (n >= ST_MIN_TEXT && end < tableLength) {
+		if (image[end] == 0) {
+			*zero = 1;
+			return n;
+		}
+		if (image[end] == '\r') return n + 1;
+	}
+	n = image[offset];
+	if (n >= ST_MIN_COUNTED && offset + 1 + n <= tableLength && textRun[offset+1] >= n) {
+		for (i = offset + 1, letters = 0; i <= offset + n; i++)
+			if (isalpha(image[i]) || image[i] == ' ') ++letters;
+		if (2 * letters >= n) {
+			*prefix = 1;
+			return n;
+		}
+	}
+	return 0;
+}
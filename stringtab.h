@@ -0,0 +1,43 @@
+/*
+ * stringtab.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef STRINGTAB_H_
+#define STRINGTAB_H_
+
+#include "memoryfile.h"
+
+// Candidate strings at every offset of an image, found in one backward
+// pass when the image is loaded, so speculation looks strings up rather
+// than scanning for them. The table ignores the map: a candidate is only
+// a string if the map has nothing else in its bytes.
+
+#define ST_MIN_TEXT 4		// Characters in a terminated FCC string
+#define ST_MIN_COUNTED 6	// Characters in a length-prefixed FCC string
+
+// Build the table for an image
+void st_build(MemoryFile *mod);
+
+// Forget the table
+void st_reset();
+
+// Non-zero once there is a table
+int st_built();
+
+// The bytes couldBeString would take at offset on an empty map: 7-bit
+// text up to a byte with the MSB set (FCS), or to the end of the image;
+// 0 if a character not allowed comes first
+int st_fcs(int offset);
+
+// The FCC string at offset, if any: printable text of at least
+// ST_MIN_TEXT characters ended by a zero byte or a CR (which is part of
+// the text), or of ST_MIN_COUNTED to 255 characters, mostly letters and
+// spaces, after a byte holding its length. Returns the characters, or 0,
+// and sets *prefix and *zero to 1 if a length byte comes before them or
+// a zero byte after.
+int st_text(MemoryFile *mod, int offset, int *prefix, int *zero);
+
+#endif /* STRINGTAB_H_ */
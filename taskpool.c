@@ -0,0 +1,64 @@
+/*
+ * taskpool.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "taskpool.h"
+
+typedef struct TaskPool {
+	TaskFunc func;
+	void *arg;
+	int count;
+	int next;		// Next task to hand out
+} TaskPool;
+
+static void *tp_worker(void *p) {
+	TaskPool *pool = (TaskPool *)p;
+	int task;
+	while ((task = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->count) {
+		pool->func(task, pool->arg);
+	}
+	return NULL;
+}
+
+int tp_defaultJobs() {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n < 1) n = 1;
+	if (n > 64) n = 64;
+	return (int)n;
+}
+
+void tp_run(int jobs, int count, TaskFunc func, void *arg) {
+	TaskPool pool = { func, arg, count, 0 };
+	pthread_t *threads;
+	int i, started = 0;
+
+	if (jobs > count) jobs = count;
+	if (jobs <= 1) {
+		// Not worth a thread
+		for (i = 0; i < count; i++) func(i, arg);
+		return;
+	}
+	threads = (pthread_t *)malloc(sizeof(pthread_t) * (jobs - 1));
+	if (threads == NULL) {
+		fprintf(stderr, "ERROR: tp_run: Insufficient memory for threads.\n");
+		exit(1);
+	}
+	for (i = 0; i < jobs - 1; i++) {
+		if (pthread_create(&threads[i], NULL, tp_worker, &pool) != 0) break;
+		++started;
+	}
+	// The caller works too
+	tp_worker(&pool);
+	for (i = 0; i < started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+}
@@ -0,0 +1,21 @@
+/*
+ * taskpool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef TASKPOOL_H_
+#define TASKPOOL_H_
+
+/* Work function; called once for each task number */
+typedef void (*TaskFunc)(int task, void *arg);
+
+/* Return the number of worker threads to use by default */
+int tp_defaultJobs();
+
+/* Run tasks 0..count-1 on up to jobs threads (including the caller);
+   returns when every task has finished */
+void tp_run(int jobs, int count, TaskFunc func, void *arg);
+
+#endif /* TASKPOOL_H_ */
@@ -0,0 +1,182 @@
+/*
+ * timeline.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// How a run unfolds, for Perfetto or chrome://tracing. Phases and
+// speculation rounds are few and all kept; tracer runs and speculation
+// candidates go into a fixed ring that keeps the newest, so recording
+// never allocates or writes during the run. Nothing is formatted until
+// tl_write.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "runstats.h"
+#include "timeline.h"
+
+typedef struct Event {
+	long long start, dur;	// ns since tl_init; dur -1 for an instant
+	int kind;				// EV_*
+	unsigned address;
+	int a, b;
+	long c;
+} Event;
+
+enum { EV_PHASE, EV_ROUND, EV_RUN, EV_CODE, EV_STRING };
+
+int tl_enabled = 0;
+
+static struct timespec origin;
+static Event *ring = NULL;			// Tracer runs and candidates
+static long ringSize = 0, ringNext = 0;	// Events are ringNext % ringSize
+static Event *major = NULL;			// Phases and rounds
+static int majorCount = 0, majorMax = 0, rounds = 0;
+static long long phaseAt[RS_PHASES];
+
+static const char *phaseNames[RS_PHASES] = {
+	"load", "infer", "trace", "speculation", "labels", "emit"
+};
+
+void tl_init(int size) {
+	clock_gettime(CLOCK_MONOTONIC, &origin);
+	if (ring == NULL) {
+		ring = (Event *)malloc(sizeof(Event) * size);
+		if (ring == NULL) {
+			fprintf(stderr, "ERROR: tl_init: Insufficient memory.\n");
+			exit(1);
+		}
+		ringSize = size;
+	}
+	ringNext = 0;
+	majorCount = 0;
+	rounds = 0;
+	memset(phaseAt, 0xFF, sizeof(phaseAt));
+	tl_enabled = 1;
+}
+
+long long tl_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec - origin.tv_sec) * 1000000000LL + ts.tv_nsec - origin.tv_nsec;
+}
+
+static Event* addMajor() {
+	if (majorCount == majorMax) {
+		majorMax = majorMax ? majorMax * 2 : 64;
+		major = (Event *)realloc(major, sizeof(Event) * majorMax);
+		if (major == NULL) {
+			fprintf(stderr, "ERROR: tl_phaseEnd: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+	return &major[majorCount++];
+}
+
+static Event* addRing() {
+	return &ring[ringNext++ % ringSize];
+}
+
+void tl_phaseBegin(int phase) {
+	if (tl_enabled && phaseAt[phase] < 0) phaseAt[phase] = tl_now();
+}
+
+int tl_phaseEnd(int phase) {
+	Event *e;
+	if (!tl_enabled || phaseAt[phase] < 0) return 0;
+	e = addMajor();
+	e->start = phaseAt[phase];
+	e->dur = tl_now() - e->start;
+	e->kind = EV_PHASE;
+	e->a = phase;
+	phaseAt[phase] = -1;
+	return 1;
+}
+
+void tl_run(long long start, unsigned address, int instructions, int bytes) {
+	Event *e = addRing();
+	e->start = start;
+	e->dur = tl_now() - start;
+	e->kind = EV_RUN;
+	e->address = address;
+	e->a = instructions;
+	e->b = bytes;
+}
+
+void tl_round(long long start, int code, int strings, long probes) {
+	Event *e = addMajor();
+	e->start = start;
+	e->dur = tl_now() - start;
+	e->kind = EV_ROUND;
+	e->address = ++rounds;
+	e->a = code;
+	e->b = strings;
+	e->c = probes;
+}
+
+void tl_candidate(unsigned address, int bytes, int string) {
+	Event *e = addRing();
+	e->start = tl_now();
+	e->dur = -1;
+	e->kind = string ? EV_STRING : EV_CODE;
+	e->address = address;
+	e->a = bytes;
+}
+
+static void writeEvent(FILE *fp, Event *e) {
+	fprintf(fp, ",\n");
+	switch (e->kind) {
+		case EV_PHASE:
+			fprintf(fp, "{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":1", phaseNames[e->a]);
+			break;
+		case EV_ROUND:
+			fprintf(fp, "{\"name\":\"round %u\",\"cat\":\"speculation\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+				"\"args\":{\"code\":%d,\"strings\":%d,\"probes\":%ld}", e->address, e->a, e->b, e->c);
+			break;
+		case EV_RUN:
+			fprintf(fp, "{\"name\":\"run $%04X\",\"cat\":\"trace\",\"ph\":\"X\",\"pid\":1,\"tid\":2,"
+				"\"args\":{\"instructions\":%d,\"bytes\":%d}", e->address, e->a, e->b);
+			break;
+		default:
+			fprintf(fp, "{\"name\":\"%s $%04X\",\"cat\":\"speculation\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":2,"
+				"\"args\":{\"bytes\":%d}", e->kind == EV_CODE ? "code" : "string", e->address, e->a);
+			break;
+	}
+	fprintf(fp, ",\"ts\":%lld.%03lld", e->start / 1000, e->start % 1000);
+	if (e->dur >= 0) fprintf(fp, ",\"dur\":%lld.%03lld", e->dur / 1000, e->dur % 1000);
+	fprintf(fp, "}");
+}
+
+void tl_write(char *fileName, char *moduleName) {
+	long first, i;
+	FILE *fp;
+	int m;
+
+	if (!tl_enabled) return;
+	if ((fp = fopen(fileName, "w")) == NULL) {
+		fprintf(stderr, "ERROR: tl_write: Can't write timeline '%s'\n", fileName);
+		exit(1);
+	}
+	first = ringNext > ringSize ? ringNext - ringSize : 0;
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"module\":\"");
+	for (; *moduleName; moduleName++) {
+		if (*moduleName == '"' || *moduleName == '\\') fputc('\\', fp);
+		fputc(*moduleName, fp);
+	}
+	fprintf(fp, "\",\"dropped\":%ld},\n\"traceEvents\":[\n", first);
+	fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"diffdasm\"}},\n");
+	fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"phases\"}},\n");
+	fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"tracer\"}}");
+	for (m = 0; m < majorCount; m++) writeEvent(fp, &major[m]);
+	for (i = first; i < ringNext; i++) writeEvent(fp, &ring[i % ringSize]);
+	fprintf(fp, "\n]}\n");
+	if (fclose(fp)) {
+		fprintf(stderr, "ERROR: tl_write: Can't write timeline '%s'\n", fileName);
+		exit(1);
+	}
+	tl_init(ringSize);
+}
@@ -0,0 +1,41 @@
+/*
+ * timeline.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+// Non-zero while --timeline is recording; check it before calling the
+// recording functions so a run without it pays only the test
+extern int tl_enabled;
+
+// Start recording; keeps the newest size events of the tracer
+void tl_init(int size);
+
+// Nanoseconds since tl_init
+long long tl_now();
+
+// Phases (RS_*) begin and end; runstats calls these. tl_phaseEnd
+// returns whether the phase was running.
+void tl_phaseBegin(int phase);
+int tl_phaseEnd(int phase);
+
+// A linear run of mapCode from an entry point popped from the address
+// stack, with the instructions and bytes it traced (both zero if the
+// entry point was skipped)
+void tl_run(long long start, unsigned address, int instructions, int bytes);
+
+// A speculation round, with the candidates taken as code and strings out
+// of the labels and map bytes probed
+void tl_round(long long start, int code, int strings, long probes);
+
+// A candidate couldBeCode or couldBeString accepted
+void tl_candidate(unsigned address, int bytes, int string);
+
+// Write everything recorded as Chrome trace-event JSON, then start over
+void tl_write(char *fileName, char *moduleName);
+
+#endif /* TIMELINE_H_ */
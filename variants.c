@@ -0,0 +1,302 @@
+/*
+ * variants.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+// N-way comparison. The baseline is traced, disassembled and hashed once;
+// each variant is then traced and diffed in its own process (the tracer
+// keeps its state in globals, and exits on a bad module), inheriting the
+// baseline text, index and line hashes copy-on-write. Results come back
+// over a pipe: the hunk count and a flag per baseline routine.
+//
+// A variant is traced on its own, not seeded from the baseline map or
+// labels: its bytes differ, and seeding would make its report differ from
+// a two-module --compare of the same pair. The baseline map is used for
+// the routine boundaries, and its labels are in the baseline text.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "memoryfile.h"
+#include "memorymap.h"
+#include "outbuf.h"
+#include "lineindex.h"
+#include "compare.h"
+#include "stats6809.h"
+#include "emitter.h"
+#include "diffdasm.h"
+#include "variants.h"
+#include "ddmap.h"
+
+#define STRMAX 4096
+
+extern MemoryFile input;
+extern MemoryMap map;
+
+typedef struct Variant {
+	char *name;
+	char report[STRMAX];	// Delta report file
+	int hunks;
+	unsigned char *differs;	// Flag per baseline routine
+	pid_t pid;
+	int fd;				// Result pipe from child
+} Variant;
+
+// A path built by snprintf, which must have fit
+static void checkPath(int n, char *path) {
+	if (n < 0 || n >= STRMAX) {
+		fprintf(stderr, "ERROR: var_compare: Path too long '%s...'\n", path);
+		exit(1);
+	}
+}
+
+static CompareSide baseline;
+static OutBuf baseText;
+static LineIndex baseIndex;
+static int *routines;		// Routine start offsets in the baseline, ascending
+static int routineCount;
+
+// Routine starts are call targets, and code that follows something other
+// than code (so the first routine in each code block)
+static void findRoutines(MemoryFile *mod, MemoryMap *mm) {
+	unsigned char *isStart = (unsigned char *)calloc(mm->maxElements + 1, 1);
+	int offset, dest;
+	unsigned char opc;
+
+	if (isStart == NULL) {
+		fprintf(stderr, "ERROR: findRoutines: Insufficient memory.\n");
+		exit(1);
+	}
+	isStart[0] = 1;
+	for (offset = 0; offset < mm->maxElements; offset++) {
+		if (mm_type(mm, offset) != MM_CODE1) continue;
+		if (offset > 0 && mm_type(mm, offset-1) != MM_CODE) isStart[offset] = 1;
+		opc = mod->storage[offset];
+		if (opc == 0x8D || opc == 0x17 || opc == 0x9D || opc == 0xAD || opc == 0xBD) {
+			// BSR, LBSR, JSR
+			dest = M6809_transfer(mod, offset);
+			if (dest >= 0 && dest < mm->maxElements && mm_type(mm, dest) == MM_CODE1) isStart[dest] = 1;
+		}
+	}
+	routines = (int *)malloc(sizeof(int) * (mm->maxElements + 1));
+	if (routines == NULL) {
+		fprintf(stderr, "ERROR: findRoutines: Insufficient memory.\n");
+		exit(1);
+	}
+	routineCount = 0;
+	for (offset = 0; offset < mm->maxElements; offset++) {
+		if (isStart[offset]) routines[routineCount++] = offset;
+	}
+	free(isStart);
+}
+
+// Index of the routine containing offset
+static int routineAt(int offset) {
+	int lo = 0, hi = routineCount - 1, mid;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (routines[mid] <= offset) lo = mid;
+		else hi = mid - 1;
+	}
+	return lo;
+}
+
+// Flag the routines touched by baseline lines first..last (1 based)
+static void markLines(unsigned char *differs, int first, int last) {
+	LineList *a, *b;
+	int r, end;
+
+	if (last < first) {
+		// Insertion after line first-1
+		a = li_findLine(&baseIndex, last);
+		differs[routineAt(a ? a->endOffset + 1 : 0)] = 1;
+		return;
+	}
+	a = li_findLine(&baseIndex, first);
+	b = li_findLine(&baseIndex, last);
+	if (a == NULL || b == NULL) return;
+	end = routineAt(b->endOffset);
+	for (r = routineAt(a->startOffset); r <= end; r++) differs[r] = 1;
+}
+
+static void compareVariant(Variant *v) {
+	CompareSide side;
+	OutBuf text;
+	LineIndex index;
+	Change *changes;
+	FILE *fp;
+	int i, n;
+
+	analyze(v->name);
+	ob_init(&text, input.length * 24);
+	disassemble(&input, &map, 1, &text);
+	index = lineIndex;
+	side.name = v->name;
+	side.text = &text;
+	side.index = &index;
+	side.lines = NULL;
+
+	n = cmp_diff(&baseline, &side, &changes);
+	if (!(fp = fopen(v->report, "w"))) {
+		fprintf(stderr, "ERROR: compareVariant: Can't create report '%s'\n", v->report);
+		exit(1);
+	}
+	v->hunks = cmp_write(fp, &baseline, &side, changes, n, 3);
+	fclose(fp);
+	for (i = 0; i < n; i++) {
+		markLines(v->differs, changes[i].a0 + 1, changes[i].a1);
+	}
+
+	free(changes);
+	cmp_release(&side);
+	ob_destroy(&text);
+	li_destroy(&index);
+	mf_destroy(&input);
+	mm_destroy(&map);
+}
+
+static void writeAll(int fd, void *data, size_t length) {
+	ssize_t n;
+	while (length) {
+		if ((n = write(fd, data, length)) <= 0) _exit(1);
+		data = (char *)data + n;
+		length -= n;
+	}
+}
+
+static int readAll(int fd, void *data, size_t length) {
+	ssize_t n;
+	while (length) {
+		if ((n = read(fd, data, length)) <= 0) return 0;
+		data = (char *)data + n;
+		length -= n;
+	}
+	return 1;
+}
+
+static void startVariant(Variant *v) {
+	int fds[2];
+
+	fflush(stdout);
+	fflush(stderr);
+	if (pipe(fds)) {
+		fprintf(stderr, "ERROR: startVariant: Can't create pipe.\n");
+		exit(1);
+	}
+	v->pid = fork();
+	if (v->pid < 0) {
+		fprintf(stderr, "ERROR: startVariant: Can't fork.\n");
+		exit(1);
+	}
+	if (v->pid == 0) {
+		// The report and summary are the only output; a bad module's usage
+		// text would land in the middle of the summary
+		close(fds[0]);
+		if (!freopen("/dev/null", "w", stdout)) _exit(1);
+		compareVariant(v);
+		writeAll(fds[1], &v->hunks, sizeof(v->hunks));
+		writeAll(fds[1], v->differs, routineCount);
+		close(fds[1]);
+		fflush(stderr);
+		_exit(0);
+	}
+	close(fds[1]);
+	v->fd = fds[0];
+}
+
+static void finishVariant(Variant *v) {
+	int status;
+
+	if (!readAll(v->fd, &v->hunks, sizeof(v->hunks)) ||
+		!readAll(v->fd, v->differs, routineCount)) {
+		fprintf(stderr, "ERROR: finishVariant: Comparison of '%s' failed.\n", v->name);
+		v->hunks = -1;
+	}
+	close(v->fd);
+	waitpid(v->pid, &status, 0);
+}
+
+int var_compare(char *baseName, char **variants, int count, char *reportDir, int jobs) {
+	Variant *v;
+	char name[STRMAX], *p;
+	int i, r, running, next, any = 0, width;
+
+	// Baseline, once
+	analyze(baseName);
+	ob_init(&baseText, input.length * 24);
+	disassemble(&input, &map, jobs, &baseText);
+	baseIndex = lineIndex;
+	findRoutines(&input, &map);
+	baseline.name = baseName;
+	baseline.text = &baseText;
+	baseline.index = &baseIndex;
+	baseline.lines = NULL;
+	cmp_prepare(&baseline);
+	mf_destroy(&input);
+	mm_destroy(&map);
+
+	v = (Variant *)calloc(count, sizeof(Variant));
+	if (v == NULL) {
+		fprintf(stderr, "ERROR: var_compare: Insufficient memory.\n");
+		exit(1);
+	}
+	for (i = 0; i < count; i++) {
+		v[i].name = variants[i];
+		// Flattened path plus its hash, so a/v.bin and b/v.bin stay apart
+		checkPath(snprintf(name, sizeof(name), "%s", variants[i]), name);
+		for (p = name; *p; p++) if (*p == '/') *p = '_';
+		checkPath(snprintf(v[i].report, sizeof(v[i].report), "%s/%s-%016llx.diff", reportDir, name,
+			dm_hash((unsigned char *)variants[i], strlen(variants[i]))), v[i].report);
+		v[i].differs = (unsigned char *)calloc(routineCount, 1);
+		if (v[i].differs == NULL) {
+			fprintf(stderr, "ERROR: var_compare: Insufficient memory.\n");
+			exit(1);
+		}
+	}
+
+	// Variants, up to jobs at a time; always in a child, so a variant that
+	// fails is reported and the rest still run
+	if (jobs < 1) jobs = 1;
+	for (next = 0, running = 0, i = 0; i < count; ) {
+		while (running < jobs && next < count) {
+			startVariant(&v[next++]);
+			++running;
+		}
+		finishVariant(&v[i++]);
+		--running;
+	}
+
+	// Summary
+	printf("Baseline: %s (%d routines)\n", baseName, routineCount);
+	for (i = 0; i < count; i++) {
+		if (v[i].hunks < 0) printf("%3d: %s: failed\n", i + 1, v[i].name);
+		else if (v[i].hunks == 0) printf("%3d: %s: identical\n", i + 1, v[i].name);
+		else printf("%3d: %s: %d hunks (%s)\n", i + 1, v[i].name, v[i].hunks, v[i].report);
+		if (v[i].hunks) any = 1;
+	}
+	for (width = 1, i = count; i >= 10; i /= 10) ++width;
+	printf("\nRoutine");
+	for (i = 0; i < count; i++) printf(" %*d", width, i + 1);
+	printf("\n");
+	for (r = 0; r < routineCount; r++) {
+		for (i = 0; i < count && !v[i].differs[r]; i++);
+		if (i == count) continue;
+		printf("L%04X  ", (routines[r] + baseIndex.base) & 0xFFFF);
+		for (i = 0; i < count; i++) printf(" %*s", width, v[i].differs[r] ? "X" : ".");
+		printf("\n");
+	}
+
+	for (i = 0; i < count; i++) free(v[i].differs);
+	free(v);
+	free(routines);
+	cmp_release(&baseline);
+	ob_destroy(&baseText);
+	li_destroy(&baseIndex);
+	return any;
+}
@@ -0,0 +1,17 @@
+/*
+ * variants.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: cburke
+ */
+
+#ifndef VARIANTS_H_
+#define VARIANTS_H_
+
+// Trace the baseline once, then compare each variant against it (up to
+// jobs at a time). Writes a delta report per variant into reportDir and
+// prints a matrix of the baseline routines that differ in each variant.
+// Returns 1 if any variant differs, else 0.
+int var_compare(char *baseName, char **variants, int count, char *reportDir, int jobs);
+
+#endif /* VARIANTS_H_ */